@@ -0,0 +1,245 @@
+#include "ActionExecutor.h"
+#include "Agent.h"
+#include "AgentFunctions.h"
+#include "Inbox.h"
+#include "MpscQueue.h"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <map>
+#include <tuple>
+#include <unordered_map>
+
+namespace TESSERACT::Agent::Actions {
+    namespace {
+        using Clock = std::chrono::steady_clock;
+
+        constexpr float kScanBucket = 256.0f;  // Agents within one bucket share an area scan
+
+        struct State {
+            MpscQueue<Command, kCapacity> queue;
+            std::deque<Command> pending;  // Game thread only
+            std::uint64_t frame = 0;
+            std::atomic<std::size_t> waiting{0};  // pending.size() for other threads
+        };
+
+        State& GetState() {
+            static State state;
+            return state;
+        }
+
+        // Lookups made during one pass, shared by every command in it
+        struct Resolver {
+            std::unordered_map<std::string, RE::SpellItem*> spells;
+            std::unordered_map<RE::FormID, RE::TESForm*> forms;
+            std::map<std::tuple<RE::TESObjectCELL*, std::int32_t, std::int32_t, std::int32_t, float>,
+                     std::vector<RE::TESObjectREFR*>> scans;
+
+            RE::SpellItem* Spell(const std::string& editorId) {
+                auto [it, inserted] = spells.try_emplace(editorId, nullptr);
+                if (inserted) {
+                    it->second = RE::TESForm::LookupByEditorID<RE::SpellItem>(editorId);
+                }
+                return it->second;
+            }
+
+            template <class T>
+            T* Form(RE::FormID formId) {
+                if (!formId) {
+                    return nullptr;
+                }
+                auto [it, inserted] = forms.try_emplace(formId, nullptr);
+                if (inserted) {
+                    it->second = RE::TESForm::LookupByID(formId);
+                }
+                return it->second ? it->second->As<T>() : nullptr;
+            }
+
+            // One scan per cell, position bucket and radius, wide enough for anyone in the
+            // bucket (its diagonal is under two buckets), then cut down to this actor's radius
+            std::vector<RE::TESObjectREFR*> Scan(RE::Actor* actor, float radius) {
+                auto position = actor->GetPosition();
+                auto bucket = [](float value) { return static_cast<std::int32_t>(std::floor(value / kScanBucket)); };
+                auto [it, inserted] = scans.try_emplace({actor->GetParentCell(), bucket(position.x), bucket(position.y),
+                                                         bucket(position.z), radius});
+                if (inserted) {
+                    it->second = Utils::FastScanningFunction(actor, radius + 2.0f * kScanBucket);
+                }
+
+                std::vector<RE::TESObjectREFR*> nearby;
+                for (auto* ref : it->second) {
+                    if (ref->GetPosition().GetDistance(position) <= radius) {
+                        nearby.push_back(ref);
+                    }
+                }
+                return nearby;
+            }
+        };
+
+        struct Applied {
+            Outcome outcome;
+            std::string memory;  // What the NPC remembers about it
+        };
+
+        const char* Name(const RE::TESForm* form) {
+            auto* name = form ? form->GetName() : nullptr;
+            return name && name[0] ? name : "somewhere";
+        }
+
+        // What the command was meant to do, for outcomes that never got that far
+        std::string Intent(const Command& command, Resolver& resolver) {
+            switch (command.type) {
+                case Type::Cast: {
+                    auto* spell = resolver.Spell(command.name);
+                    return std::format("cast {}", spell ? Name(spell) : command.name.c_str());
+                }
+                case Type::Travel:
+                    return std::format("go to {}", Name(resolver.Form<RE::TESForm>(command.target)));
+                case Type::Acquire:
+                    return std::format("fetch {}", command.name);
+            }
+            return "act";
+        }
+
+        Applied Apply(const Command& command, SubAgent& agent, Resolver& resolver) {
+            auto* actor = agent.GetNPC();
+            if (!actor || actor->IsDead()) {
+                return {Outcome::Invalid, {}};
+            }
+
+            switch (command.type) {
+                case Type::Cast: {
+                    auto* spell = resolver.Spell(command.name);
+                    auto* target = command.target ? resolver.Form<RE::TESObjectREFR>(command.target) : actor;
+                    if (!spell || !target) {
+                        return {Outcome::Invalid, {}};
+                    }
+                    if (!AgentFunctions::ExecuteSpell(actor, spell, target)) {
+                        return {Outcome::Failed, std::format("You tried to cast {}, but could not.", Name(spell))};
+                    }
+                    return {Outcome::Done, target == actor ? std::format("You cast {}.", Name(spell)) :
+                                                             std::format("You cast {} on {}.", Name(spell), Name(target))};
+                }
+                case Type::Travel: {
+                    auto* quest = resolver.Form<RE::TESQuest>(command.quest);
+                    auto* target = resolver.Form<RE::TESObjectREFR>(command.target);
+                    if (!quest || !target) {
+                        return {Outcome::Invalid, {}};
+                    }
+                    if (!AgentFunctions::ExecuteSpellTravel(actor, quest, target, command.alias,
+                                                            resolver.Spell(AgentFunctions::kTravelSpell))) {
+                        return {Outcome::Failed, std::format("You meant to go to {}, but could not set off.", Name(target))};
+                    }
+                    return {Outcome::Done, std::format("You set off toward {}.", Name(target))};
+                }
+                case Type::Acquire: {
+                    auto* quest = resolver.Form<RE::TESQuest>(command.quest);
+                    if (!quest) {
+                        return {Outcome::Invalid, {}};
+                    }
+                    auto nearby = resolver.Scan(actor, command.radius);
+                    if (!AgentFunctions::ExecuteSpellAcquire(actor, quest, command.alias, command.radius,
+                                                             RE::BSFixedString(command.name.c_str()),
+                                                             resolver.Spell(AgentFunctions::kAcquireSpell), &nearby)) {
+                        return {Outcome::Failed, std::format("You looked for {} nearby, but found none.", command.name)};
+                    }
+                    return {Outcome::Done, std::format("You went to fetch {}.", command.name)};
+                }
+            }
+            return {Outcome::Invalid, {}};
+        }
+
+        void Report(const std::shared_ptr<SubAgent>& agent, std::string memory) {
+            if (!memory.empty()) {
+                Inbox::Post({Inbox::Kind::Action, agent, std::move(memory)});
+            }
+        }
+    }
+
+    bool Submit(Command command) {
+        return GetState().queue.TryPush(std::move(command));
+    }
+
+    void Execute() {
+        auto& state = GetState();
+        state.frame++;
+        state.queue.Drain([&](Command command) {
+            command.queuedFrame = state.frame;
+            state.pending.push_back(std::move(command));
+        }, kCapacity);
+        if (state.pending.empty()) {
+            state.waiting.store(0, std::memory_order_relaxed);
+            return;
+        }
+
+        auto start = Clock::now();
+        auto budget = std::chrono::microseconds((std::max)(Memory::actionBudgetMicros, 0));
+        Resolver resolver;
+        std::size_t applied = 0;
+        std::size_t rejected = 0;
+        while (!state.pending.empty()) {
+            if (applied > 0 && Clock::now() - start >= budget) {
+                break;
+            }
+
+            auto command = std::move(state.pending.front());
+            state.pending.pop_front();
+
+            // Handles go stale when the NPC left the holding quest or a save was loaded
+            auto agent = Manager::Get(command.agent);
+            if (!agent) {
+                rejected++;
+                continue;
+            }
+            if (state.frame - command.queuedFrame > kMaxWaitFrames) {
+                rejected++;
+                Report(agent, std::format("You meant to {}, but too much time passed.", Intent(command, resolver)));
+                continue;
+            }
+
+            auto result = Apply(command, *agent, resolver);
+            if (result.outcome == Outcome::Invalid) {
+                rejected++;
+                result.memory = std::format("You meant to {}, but it was no longer possible.", Intent(command, resolver));
+            }
+            Report(agent, std::move(result.memory));
+            applied++;
+        }
+
+        state.waiting.store(state.pending.size(), std::memory_order_relaxed);
+
+        if (applied > 1 || rejected > 0) {
+            logger::info("Applied {} agent actions ({} rejected, {} waiting) in {} us", applied, rejected, state.pending.size(),
+                         std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count());
+        }
+    }
+
+    std::size_t Pending() {
+        return GetState().waiting.load(std::memory_order_relaxed);
+    }
+
+    bool __stdcall QueueSpellPapyrus(RE::StaticFunctionTag*, RE::Actor* actor, RE::BSFixedString spell, RE::TESObjectREFR* target) {
+        auto handle = actor ? Manager::Find(actor->GetFormID()) : AgentHandle{};
+        if (!handle) {
+            return false;
+        }
+        return Submit({Type::Cast, handle, target ? target->GetFormID() : 0, 0, 0, 0.0f, spell.c_str()});
+    }
+
+    bool __stdcall QueueTravelPapyrus(RE::StaticFunctionTag*, RE::Actor* actor, RE::TESQuest* quest, RE::TESObjectREFR* target, std::uint32_t aliasID) {
+        auto handle = actor ? Manager::Find(actor->GetFormID()) : AgentHandle{};
+        if (!handle || !quest || !target) {
+            return false;
+        }
+        return Submit({Type::Travel, handle, target->GetFormID(), quest->GetFormID(), aliasID, 0.0f, {}});
+    }
+
+    bool __stdcall QueueAcquirePapyrus(RE::StaticFunctionTag*, RE::Actor* actor, RE::TESQuest* quest, std::uint32_t aliasID, float radius, RE::BSFixedString itemName) {
+        auto handle = actor ? Manager::Find(actor->GetFormID()) : AgentHandle{};
+        if (!handle || !quest) {
+            return false;
+        }
+        return Submit({Type::Acquire, handle, 0, quest->GetFormID(), aliasID, radius, itemName.c_str()});
+    }
+}
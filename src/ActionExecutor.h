@@ -0,0 +1,76 @@
+#pragma once
+#include "RE/Skyrim.h"
+#include "AgentManager.h"
+#include <cstdint>
+#include <string>
+
+/**
+ * Action Executor Overview
+ *
+ * Agents decide on worker threads, but spells, aliases and packages can only
+ * be touched on the game thread. Commands from every agent are queued here
+ * and applied together in one pass per frame, so a burst of decisions is
+ * spread over frames instead of hitching one.
+ *
+ * 1. Submitting:
+ *    - Submit() from any thread (lock-free queue, see MpscQueue.h); the
+ *      command names its agent by handle, not by pointer
+ *
+ * 2. Applying (game thread, once per frame from the main update hook):
+ *    - Commands whose agent was retired, or whose forms no longer resolve,
+ *      are rejected; ones waiting longer than kMaxWaitFrames expire
+ *    - Within actionBudgetMicros, oldest first (the first always runs);
+ *      the rest wait for the next frame
+ *    - Spells, quests and targets are resolved once per pass and shared by
+ *      every command that needs them; area scans are shared by agents
+ *      standing close together (same cell and position bucket)
+ *
+ * 3. Results:
+ *    - Each outcome goes back to its agent through the inbox (Inbox.h) and
+ *      becomes something the NPC remembers doing, or failing to do; an
+ *      expired or invalid command is remembered as never carried out
+ *    - These are the NPC's own memories ("action" role), not world events
+ *      other agents share
+ */
+
+namespace TESSERACT::Agent::Actions {
+    enum class Type : std::uint8_t {
+        Cast,     // name = spell editor ID, target optional (self)
+        Travel,   // quest + alias, target = destination
+        Acquire   // quest + alias, name = item name, radius
+    };
+
+    struct Command {
+        Type type = Type::Cast;
+        AgentHandle agent;
+        RE::FormID target = 0;
+        RE::FormID quest = 0;
+        std::uint32_t alias = 0;
+        float radius = 0.0f;
+        std::string name;
+        std::uint64_t queuedFrame = 0;  // Set when the executor picks it up
+    };
+
+    enum class Outcome : std::uint8_t {
+        Done,
+        Failed,    // Resolved but the game refused (no caster, nothing matching)
+        Invalid,   // Agent retired or a form no longer exists
+        Expired
+    };
+
+    constexpr std::size_t kCapacity = 1024;
+    constexpr std::uint64_t kMaxWaitFrames = 600;  // About ten seconds
+
+    // Any thread; false if the queue is full
+    bool Submit(Command command);
+
+    // Game thread, once per frame (see Hooks.cpp)
+    void Execute();
+
+    std::size_t Pending();  // Picked up but not applied yet, as of the last pass
+
+    // Papyrus: queue instead of acting right away (the NPC needs an agent)
+    bool __stdcall QueueSpellPapyrus(RE::StaticFunctionTag*, RE::Actor* actor, RE::BSFixedString spell, RE::TESObjectREFR* target);
+    bool __stdcall QueueTravelPapyrus(RE::StaticFunctionTag*, RE::Actor* actor, RE::TESQuest* quest, RE::TESObjectREFR* target, std::uint32_t aliasID);
+    bool __stdcall QueueAcquirePapyrus(RE::StaticFunctionTag*, RE::Actor* actor, RE::TESQuest* quest, std::uint32_t aliasID, float radius, RE::BSFixedString itemName);
+}
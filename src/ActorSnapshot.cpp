@@ -0,0 +1,184 @@
+#include "ActorSnapshot.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+namespace TESSERACT::Agent::Snapshots {
+    namespace {
+        struct Buffer {
+            std::atomic<std::uint32_t> sequence{0};  // Odd while Capture() writes it
+            std::array<ActorSnapshot, kMaxActors> actors;
+        };
+
+        struct State {
+            std::array<Buffer, 2> buffers;
+            std::atomic<std::uint32_t> front{0};
+            std::uint32_t frame = 0;  // Game thread only
+
+            std::mutex slotMutex;
+            std::array<RE::FormID, kMaxActors> forms{};
+            std::array<std::uint32_t, kMaxActors> references{};
+            std::uint32_t used = 0;  // Slots below this have been handed out
+        };
+
+        State& GetState() {
+            static State state;
+            return state;
+        }
+
+        template <std::size_t N>
+        void CopyName(char (&out)[N], const char* text) {
+            std::size_t length = text ? std::min(std::strlen(text), N - 1) : 0;
+            if (length) std::memcpy(out, text, length);
+            out[length] = '\0';
+        }
+    }
+
+    std::uint32_t Track(RE::FormID formId) {
+        auto& state = GetState();
+        std::lock_guard lock(state.slotMutex);
+
+        std::uint32_t freeSlot = kNoSlot;
+        for (std::uint32_t i = 0; i < state.used; i++) {
+            if (state.references[i] > 0 && state.forms[i] == formId) {
+                state.references[i]++;
+                return i;
+            }
+            if (state.references[i] == 0 && freeSlot == kNoSlot) {
+                freeSlot = i;
+            }
+        }
+        if (freeSlot == kNoSlot) {
+            if (state.used == kMaxActors) {
+                logger::error("All {} actor snapshot slots are in use, {:08X} will have no snapshot", kMaxActors, formId);
+                return kNoSlot;
+            }
+            freeSlot = state.used++;
+        }
+
+        state.forms[freeSlot] = formId;
+        state.references[freeSlot] = 1;
+        return freeSlot;
+    }
+
+    void Untrack(std::uint32_t slot) {
+        auto& state = GetState();
+        std::lock_guard lock(state.slotMutex);
+        if (slot < state.used && state.references[slot] > 0 && --state.references[slot] == 0) {
+            state.forms[slot] = 0;
+        }
+    }
+
+    void Fill(const RE::Actor* actor, ActorSnapshot& out) {
+        if (!actor) {
+            out = {};
+            return;
+        }
+
+        out.formId = actor->GetFormID();
+        CopyName(out.name, actor->GetName());
+        auto* race = actor->GetRace();
+        CopyName(out.race, race ? race->GetName() : "person");
+        auto* location = actor->GetCurrentLocation();
+        CopyName(out.location, location ? location->GetName() : "Unknown");
+
+        // The actor value getters are not const in CommonLib, they only read
+        auto* values = const_cast<RE::Actor*>(actor)->AsActorValueOwner();
+        float maxHealth = values ? values->GetPermanentActorValue(RE::ActorValue::kHealth) : 0.0f;
+        out.healthPercent = maxHealth > 0.0f ?
+            std::clamp(values->GetActorValue(RE::ActorValue::kHealth) / maxHealth * 100.0f, 0.0f, 100.0f) : 0.0f;
+
+        auto position = actor->GetPosition();
+        out.position[0] = position.x;
+        out.position[1] = position.y;
+        out.position[2] = position.z;
+
+        out.loaded = actor->Is3DLoaded();
+        auto* player = RE::PlayerCharacter::GetSingleton();
+        out.distance = out.loaded && player && player->GetWorldspace() == actor->GetWorldspace() &&
+                       player->GetParentCell() && actor->GetParentCell() ?
+            player->GetPosition().GetDistance(position) : -1.0f;
+        out.dead = actor->IsDead();
+        out.inCombat = actor->IsInCombat();
+        out.alarmed = actor->IsAlarmed();
+        out.sneaking = actor->IsSneaking();
+    }
+
+    void Capture() {
+        auto& state = GetState();
+
+        std::array<RE::FormID, kMaxActors> forms;
+        std::uint32_t used;
+        {
+            std::lock_guard lock(state.slotMutex);
+            used = state.used;
+            std::copy_n(state.forms.begin(), used, forms.begin());
+        }
+
+        const auto frontIndex = state.front.load(std::memory_order_relaxed);
+        const auto& front = state.buffers[frontIndex];
+        auto& back = state.buffers[frontIndex ^ 1];
+        state.frame++;
+
+        auto sequence = back.sequence.load(std::memory_order_relaxed);
+        back.sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        for (std::uint32_t i = 0; i < used; i++) {
+            auto& snapshot = back.actors[i];
+            if (!forms[i]) {
+                snapshot = {};
+                continue;
+            }
+
+            if (auto* actor = RE::TESForm::LookupByID<RE::Actor>(forms[i])) {
+                Fill(actor, snapshot);
+
+                // A slot gets a fresh raycast every kSightInterval frames, the rest keep the last one
+                if (snapshot.distance < 0.0f || snapshot.distance > kSightDistance) {
+                    snapshot.inSight = false;
+                } else if ((state.frame + i) % kSightInterval == 0) {
+                    bool targetOnly = false;
+                    auto* player = RE::PlayerCharacter::GetSingleton();
+                    snapshot.inSight = player && player->HasLineOfSight(actor, targetOnly);
+                } else {
+                    snapshot.inSight = front.actors[i].formId == forms[i] && front.actors[i].inSight;
+                }
+            } else {
+                // Not in memory right now: keep the last known state
+                snapshot = front.actors[i].formId == forms[i] ? front.actors[i] : ActorSnapshot{};
+                snapshot.formId = forms[i];
+                snapshot.loaded = false;
+            }
+            snapshot.frame = state.frame;
+        }
+
+        back.sequence.store(sequence + 2, std::memory_order_release);
+        state.front.store(frontIndex ^ 1, std::memory_order_release);
+    }
+
+    bool Read(std::uint32_t slot, RE::FormID formId, ActorSnapshot& out) {
+        if (slot >= kMaxActors) {
+            return false;
+        }
+
+        auto& state = GetState();
+        for (int attempt = 0;; attempt++) {
+            const auto& buffer = state.buffers[state.front.load(std::memory_order_acquire)];
+            auto before = buffer.sequence.load(std::memory_order_acquire);
+            if ((before & 1) == 0) {
+                out = buffer.actors[slot];
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (buffer.sequence.load(std::memory_order_relaxed) == before) {
+                    break;
+                }
+            }
+            // Capture() is rewriting the buffer we started on; it finishes within microseconds
+            if (attempt > 8) std::this_thread::yield();
+        }
+        return out.frame != 0 && out.formId == formId;
+    }
+}
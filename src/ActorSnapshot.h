@@ -0,0 +1,63 @@
+#pragma once
+#include "RE/Skyrim.h"
+#include <cstdint>
+#include <string_view>
+
+/**
+ * Actor Snapshots Overview
+ *
+ * Prompts are built on worker threads, where touching a live RE::Actor races
+ * with the engine. The game thread copies what the prompts need into a small
+ * POD per agent once per frame (see Hooks.cpp), and workers only read copies.
+ *
+ * 1. Slots:
+ *    - Each agent tracks its actor and gets a fixed slot; slots are reference
+ *      counted so two agents on one NPC share it
+ *
+ * 2. Double buffering:
+ *    - Capture() fills the back buffer and flips it to the front; each buffer
+ *      has a sequence number (odd while being written), so a reader that was
+ *      preempted across two flips notices and copies again instead of
+ *      returning a torn snapshot
+ */
+
+namespace TESSERACT::Agent::Snapshots {
+    struct ActorSnapshot {
+        RE::FormID formId = 0;
+        std::uint32_t frame = 0;  // Capture that wrote it, 0 = never captured
+        char name[64] = {};
+        char race[32] = {};
+        char location[64] = {};
+        float healthPercent = 0.0f;
+        float position[3] = {};
+        float distance = -1.0f;  // To the player, -1 when not in the same cell set or unloaded
+        bool loaded = false;  // 3D loaded, position is meaningful
+        bool dead = false;
+        bool inCombat = false;
+        bool alarmed = false;
+        bool sneaking = false;
+        bool inSight = false;  // Player has line of sight; refreshed every kSightInterval captures
+
+        std::string_view Name() const { return name; }
+        std::string_view Race() const { return race; }
+        std::string_view Location() const { return location; }
+    };
+
+    constexpr std::uint32_t kMaxActors = 256;
+    constexpr std::uint32_t kNoSlot = UINT32_MAX;
+    constexpr std::uint32_t kSightInterval = 8;  // Line of sight is a raycast, staggered across slots
+    constexpr float kSightDistance = 4096.0f;    // Nobody checks sight beyond this
+
+    // Any thread; kNoSlot when all slots are taken
+    std::uint32_t Track(RE::FormID formId);
+    void Untrack(std::uint32_t slot);
+
+    // Game thread, once per frame
+    void Capture();
+
+    // Game thread: fill one snapshot straight from the actor
+    void Fill(const RE::Actor* actor, ActorSnapshot& out);
+
+    // Any thread, lock-free; false until the slot has been captured for formId
+    bool Read(std::uint32_t slot, RE::FormID formId, ActorSnapshot& out);
+}
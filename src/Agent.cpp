@@ -1,10 +1,20 @@
 #include "Agent.h"
+#include "Cognition.h"
+#include "ConversationArchive.h"
+#include "Embedding.h"
+#include "LoreIndex.h"
+#include "MemoryScoring.h"
+#include "PersonaCache.h"
+#include "Persistence.h"
+#include "PromptTemplates.h"
+#include "Tokenizer.h"
 #include "UI.h"
+#include <array>
 
 namespace TESSERACT::Agent::Communication {
     // AKA this portion interfaces with the OpenAI API directly
     // OpenAI Request
-    std::string SendOpenAIRequest(const std::vector<Message>& context, const std::string& userInput) {
+    std::string SendOpenAIRequest(const std::vector<Message>& context, const std::string& userInput, const std::string& model) {
         // First check OpenAI connection
         if (!UI::Config::OpenAI::initialized.load()) {
             return "I'm not connected to OpenAI yet. Please check your settings.";
@@ -13,8 +23,9 @@ namespace TESSERACT::Agent::Communication {
         try {
             // Create the request structure
             nlohmann::json chat_request = {
-                {"model", UI::Config::OpenAI::model},
-                {"messages", nlohmann::json::array()}
+                {"model", model.empty() ? UI::Config::OpenAI::model : model},
+                {"messages", nlohmann::json::array()},
+                {"max_tokens", Tokenizer::BudgetFor(Tokenizer::RequestClass::Dialogue).output}
             };
 
             // Convert our Message objects to the format OpenAI expects
@@ -47,50 +58,63 @@ namespace TESSERACT::Agent::Communication {
         }
     }
 
-    // Generate System prompt
+    // Generate System prompt (the stable part: world rules and persona; agents cache it, see PersonaCache.h)
     std::string GenerateSystemPrompt(const RE::Actor* npc) {
         if (!npc) return "";
 
-        auto name = npc->GetName();
-        auto race = npc->GetRace()->GetName();
-        auto loc = npc->GetCurrentLocation() ? 
-                    npc->GetCurrentLocation()->GetName() : "Unknown Location";
-
-        return std::format(
-            "You are {}, a {} in {}. Maintain character and speak naturally. "
-            "You have your own goals, personality, and daily routine. "
-            "Keep responses concise and relevant to your character. "
-            "Current time: {}, Weather: {}.",
-            name, race, loc,
-            "TODO: Add time", "TODO: Add weather"
-        );
-    };
-
-    // Generate Context
+        Snapshots::ActorSnapshot actor;
+        Snapshots::Fill(npc, actor);
+
+        thread_local Prompts::SlotValues slots;
+        Prompts::FillSlots(actor, slots,
+            Prompts::Get(Prompts::Section::World).Slots() | Prompts::Get(Prompts::Section::Persona).Slots());
+        return Prompts::Render(Prompts::Section::World, slots) + "\n\n" +
+               Prompts::Render(Prompts::Section::Persona, slots);
+    }
+
+    // Generate Context (the volatile part: what is going on right now)
     std::string GetNPCContext(const RE::Actor* npc) {
         if (!npc) return "";
 
-        bool isSneaking = npc->IsSneaking();
-        bool isInCombat = npc->IsInCombat();
-        bool isAlarmed = npc->IsAlarmed();
-// npc->GetActorBase()->GetActorValue(RE::ActorValue::kHealth);
-        // float health = npc->GetActorValueModifier(RE::ACTOR_VALUE_MODIFIER a_modifier, RE::ActorValue::kHealth);
-        
-        return std::format(
-            "Current state: {}"
-            // "Health: {:.0f}%\n"
-            "Location: {}\n"
-            "Time: {}\n",
-            isInCombat ? "In Combat!" : 
-            isAlarmed ? "Alarmed" : 
-            isSneaking ? "Sneaking" : "Normal",
-            // health,
-            npc->GetCurrentLocation() ? 
-                npc->GetCurrentLocation()->GetName() : "Unknown",
-            "TODO: Add time"
-        );
+        Snapshots::ActorSnapshot actor;
+        Snapshots::Fill(npc, actor);
+
+        thread_local Prompts::SlotValues slots;
+        Prompts::FillSlots(actor, slots, Prompts::Get(Prompts::Section::State).Slots());
+        return Prompts::Render(Prompts::Section::State, slots);
     }
 
+    // Embedding request (batched, one round trip for every input)
+    std::vector<std::vector<float>> RequestEmbeddings(const std::vector<std::string>& inputs) {
+        std::vector<std::vector<float>> embeddings;
+        if (inputs.empty() || !UI::Config::OpenAI::initialized.load()) {
+            return embeddings;
+        }
+
+        try {
+            nlohmann::json embedding_request = {
+                {"model", Memory::embeddingModel},
+                {"input", inputs},
+                {"dimensions", Memory::embeddingDimensions}
+            };
+
+            auto response = openai::embedding().create(embedding_request);
+
+            embeddings.resize(inputs.size());
+            for (const auto& item : response["data"]) {
+                size_t index = item["index"].get<size_t>();
+                if (index < embeddings.size()) {
+                    embeddings[index] = item["embedding"].get<std::vector<float>>();
+                }
+            }
+        }
+        catch (const std::exception& e) {
+            logger::error("Embedding request failed: {}", e.what());
+            embeddings.clear();
+        }
+
+        return embeddings;
+    }
 
 };
 
@@ -98,7 +122,53 @@ namespace TESSERACT::Agent::Memory {
     // This portion creates and stores the memory objects
     
     bool calculateImportance = false;
-    int maxMemories = 50;
+    int maxMemories = 2000;  // Retrieval keeps the prompt small, so we can remember a lot more
+
+    bool useLocalEmbeddings = true;
+    std::string embeddingModel = "text-embedding-3-small";
+    int embeddingDimensions = 256;
+    int retrievalTopK = 8;
+    int lexicalBudgetMicros = 500;
+    float recencyWeight = 1.0f;
+    float importanceWeight = 1.0f;
+    float relevanceWeight = 1.0f;
+    float recencyHalfLifeHours = 24.0f;
+
+    bool consolidateMemories = true;
+    int consolidationThreshold = 200;
+    int consolidationSpan = 50;
+    int summaryFanIn = 8;
+    int maxConcurrentConsolidations = 1;
+    std::string consolidationModel = "";
+
+    bool extractFacts = true;
+    int maxFacts = 256;
+    int factsInContext = 8;
+
+    bool mergeRepeats = true;
+
+    int loreInContext = 3;
+    int loreBudgetMicros = 2000;
+
+    int tickBudgetMicros = 1000;
+
+    bool useCognitionGraph = false;
+
+    int actionBudgetMicros = 500;
+
+    bool sceneConversations = false;
+    int maxScenes = 2;
+
+    int lodNearDistance = 1024;
+    int lodFarDistance = 4096;
+    std::string lodFarModel = "";
+
+    int contextTokenBudget = 4096;
+    int replyTokenReserve = 300;
+    std::string tokenizerFile = "o200k_base.tiktoken";
+
+    int hotMemories = 64;
+    int warmBudgetMB = 32;
 
     // Function to create memory from raw strings
     MemoryEntry CreateFromString(const std::string& content, const std::string& role) {
@@ -173,82 +243,271 @@ namespace TESSERACT::Agent::Memory {
         }
     }
 
+    std::string SummarizeMemories(const std::vector<std::string>& lines, int level, const std::string& model) {
+        std::string transcript;
+        for (const auto& line : lines) {
+            transcript += line;
+            transcript += '\n';
+        }
+
+        std::string instructions = level <= 1 ?
+            "You are the long-term memory of a character in Skyrim. Summarize the "
+            "conversation below into one short paragraph written to the character "
+            "('You ...'). Keep names, places, promises, debts, relationships and "
+            "anything they would be expected to remember later. Drop small talk." :
+            "You are the long-term memory of a character in Skyrim. The summaries "
+            "below cover consecutive periods, oldest first. Merge them into one "
+            "shorter summary written to the character ('You ...') that keeps the "
+            "facts and relationships that still matter.";
+
+        try {
+            nlohmann::json chat_request = {
+                {"model", !model.empty() ? model : consolidationModel.empty() ? UI::Config::OpenAI::model : consolidationModel},
+                {"messages", {
+                    {
+                        {"role", "system"},
+                        {"content", instructions}
+                    },
+                    {
+                        {"role", "user"},
+                        {"content", transcript}
+                    }
+                }},
+                {"max_tokens", Tokenizer::BudgetFor(Tokenizer::RequestClass::Consolidation).output},
+                {"temperature", 0.3}
+            };
+
+            // This call is synchronous, but we're running in a background task
+            auto chat = openai::chat().create(chat_request);
+            return chat["choices"][0]["message"]["content"].get<std::string>();
+        }
+        catch (const std::exception& e) {
+            logger::error("Memory consolidation failed: {}", e.what());
+            return "";
+        }
+    }
+
+    std::vector<FactStore::Triple> ExtractFacts(const std::vector<std::string>& lines, const std::string& model,
+                                                std::uint32_t promptBudget) {
+        // Newest lines first until the budget is used up (a backlog can build while offline)
+        auto budget = Tokenizer::BudgetFor(Tokenizer::RequestClass::Extraction);
+        if (promptBudget > 0) {
+            budget.prompt = (std::min)(budget.prompt, promptBudget);
+        }
+        std::uint32_t used = 0;
+        size_t first = lines.size();
+        while (first > 0) {
+            used += Tokenizer::Count(lines[first - 1]) + 1;
+            if (used > budget.prompt && first < lines.size()) break;
+            first--;
+        }
+
+        std::string transcript;
+        for (size_t i = first; i < lines.size(); i++) {
+            transcript += lines[i];
+            transcript += '\n';
+        }
+
+        std::string instructions =
+            "You maintain the factual memory of a character in Skyrim. From the dialogue "
+            "below, extract lasting facts as JSON: {\"facts\": [{\"subject\": ..., "
+            "\"predicate\": ..., \"object\": ..., \"replace\": true|false}]}. "
+            "Use \"player\" for the player and \"you\" for the character. Keep terms short "
+            "(\"owes\", \"brother of\", \"lives in\"). Set replace when the fact updates an "
+            "earlier value of the same subject and predicate (a debt changes, someone moves). "
+            "Only facts worth remembering later; return {\"facts\": []} if there are none.";
+
+        std::vector<FactStore::Triple> triples;
+        try {
+            nlohmann::json chat_request = {
+                {"model", !model.empty() ? model : consolidationModel.empty() ? UI::Config::OpenAI::model : consolidationModel},
+                {"messages", {
+                    {
+                        {"role", "system"},
+                        {"content", instructions}
+                    },
+                    {
+                        {"role", "user"},
+                        {"content", transcript}
+                    }
+                }},
+                {"max_tokens", budget.output},
+                {"temperature", 0.0}
+            };
+
+            // This call is synchronous, but we're running in a background task
+            auto chat = openai::chat().create(chat_request);
+            std::string response = chat["choices"][0]["message"]["content"].get<std::string>();
+
+            // Models like to wrap JSON in prose or code fences
+            auto begin = response.find('{');
+            auto end = response.rfind('}');
+            if (begin == std::string::npos || end == std::string::npos || end < begin) {
+                return triples;
+            }
+
+            auto parsed = nlohmann::json::parse(response.substr(begin, end - begin + 1), nullptr, false);
+            if (parsed.is_discarded() || !parsed.contains("facts") || !parsed["facts"].is_array()) {
+                return triples;
+            }
+            for (const auto& fact : parsed["facts"]) {
+                if (!fact.is_object() || !fact.contains("subject") || !fact.contains("predicate") ||
+                    !fact.contains("object") || !fact["subject"].is_string() ||
+                    !fact["predicate"].is_string() || !fact["object"].is_string()) {
+                    continue;
+                }
+                triples.push_back({
+                    fact["subject"].get<std::string>(),
+                    fact["predicate"].get<std::string>(),
+                    fact["object"].get<std::string>(),
+                    fact.value("replace", false)
+                });
+            }
+        }
+        catch (const std::exception& e) {
+            logger::error("Fact extraction failed: {}", e.what());
+        }
+        return triples;
+    }
+
 }
 
 
 
 namespace TESSERACT::Agent {
+    namespace {
+        // Token count of what the memory contributes to a prompt, cached at insert
+        std::uint32_t CountTokens(const Memory::MemoryEntry& memory) {
+            auto text = memory.Text();
+            return Tokenizer::Count(text);
+        }
+
+        std::uint32_t TokensOf(const Memory::MemoryEntry& memory) {
+            return memory.tokens ? memory.tokens : CountTokens(memory);
+        }
+
+        // Appended to merged near-duplicates (see Fingerprint.h)
+        std::string RepeatNote(const Memory::MemoryEntry& memory) {
+            return memory.repetitions > 1 ? std::format(" (said {} times)", memory.repetitions) : std::string();
+        }
+
+        // Consolidations in flight across all agents (see Memory::maxConcurrentConsolidations)
+        std::atomic<int> activeConsolidations{0};
+    }
+
     // Constructor definition
     SubAgent::SubAgent(RE::Actor* npc, const std::string& role) 
-        : npc(npc), agentRole(role), isProcessingUpdate(false) {
-        // Any additional initialization
+        : npc(npc), agentRole(role), vectorIndex(static_cast<size_t>(Memory::embeddingDimensions)), isProcessingUpdate(false) {
+        // Only events from now on reach us
+        eventCursor = WorldEvents::LatestSequence();
+
+        // The game thread copies our actor every frame for the worker threads
+        snapshotSlot = Snapshots::Track(MemoryOwner());
+
+        // Pick up where we left off if this NPC has saved memories
+        Persistence::Attach(*this);
+    }
+
+    SubAgent::~SubAgent() {
+        Persistence::Detach(*this);
+        Snapshots::Untrack(snapshotSlot);
+
+        {
+            std::lock_guard lock(memoryMutex);
+            for (const auto& memory : memories) {
+                if (memory.packed) {
+                    Memory::Tiers::Release(memory.packed);
+                } else {
+                    Memory::Tiers::NoteHot(-static_cast<std::int64_t>(memory.content.size()));
+                }
+            }
+        }
     }
 
     // ProcessInput definition
     std::string SubAgent::ProcessInput(const std::string& input) {
+        std::lock_guard guard(updateMutex);
+
         // Store what was said to us as a memory
         AddMemory("user", input);
         
+        // Only managed agents (see AgentManager.h) can keep themselves alive while we think
+        auto self = weak_from_this().lock();
+        if (!self) {
+            logger::error("Agent for {:08X} is not managed, cannot answer", MemoryOwner());
+            return "";
+        }
+
         // Start the async request - think of this like placing your order
         // and getting a number, instead of waiting at the counter
-        responseFuture = std::async(std::launch::async,
-            [this, input]() {
-                // This part runs in a separate thread
-                auto context = PrepareContext();
-                try {
-                    // Make the API call
-                    std::string response = Communication::SendOpenAIRequest(context, input);
-                    return response;
-                }
-                catch (const std::exception& e) {
-                    logger::error("Failed to process input: {}", e.what());
-                    return std::string("I'm having trouble thinking clearly right now.");
-                }
-            }
-        );
+        isProcessingUpdate.store(true);
+        Tasks::Spawn(Respond(std::move(self), input, Lod::ModelFor(lod.tier.load(), UI::Config::OpenAI::model)));
 
         // Return immediately while the request processes in the background
         return "";  // Empty string indicates processing started
     }
 
 
-    void SubAgent::Update() {
-        // First, let's handle any pending response from the OpenAI API
-        if (responseFuture.valid()) {
-            // Check if response is ready without blocking
-            auto status = responseFuture.wait_for(std::chrono::milliseconds(0));
-            
-            if (status == std::future_status::ready) {
-                try {
-                    // Get the completed response - think of this like a thought 
-                    // finally crystallizing in the agent's mind
-                    std::string response = responseFuture.get();
-                    
-                    // Store this response as a memory
-                    AddMemory("assistant", response);
-
-                    // Update the latest line
-                    latestResponse = response;  // <--- crucial line
-                    
-                    // Mark that we're done processing this thought
-                    isProcessingUpdate.store(false);
-                }
-                catch (const std::exception& e) {
-                    logger::error("Error processing response in Update: {}", e.what());
-                    isProcessingUpdate.store(false);
+    Tasks::Task<void> SubAgent::Respond(std::shared_ptr<SubAgent> self, std::string input, std::string model) {
+        // Embed anything new (including this input) and use the input as the query
+        // Remote embeddings are a round trip, so they wait on the I/O pool instead of a worker
+        auto context = co_await Tasks::Blocking([&]() {
+            auto queryEmbedding = IndexPendingMemories(input);
+            return PrepareContext(input, queryEmbedding);
+        }, Memory::useLocalEmbeddings ? Tasks::Executor::Worker : Tasks::Executor::Io);
+
+        std::string reply;
+        try {
+            // Several perspectives and an arbitration instead of one call (see Cognition.h)
+            if (Memory::useCognitionGraph) {
+                Snapshots::ActorSnapshot actor;
+                if (!ReadSnapshot(actor)) {
+                    actor.formId = MemoryOwner();
                 }
+                Prompts::SlotValues slots;
+                Prompts::FillSlots(actor, slots);
+                auto result = co_await Cognition::Run(std::move(context), std::move(slots), model);
+                logger::info("Cognition graph ran {} stages ({} timed out, {} failed{})", result.stagesRun,
+                             result.timeouts, result.failures, result.silent ? ", chose not to answer" : "");
+                reply = std::move(result.reply);
+            } else {
+                // Make the API call
+                auto request = Tasks::BlockingIo([context, input, model]() { return Communication::SendOpenAIRequest(context, input, model); });
+                reply = co_await request;
             }
-            // If status is not ready, we just continue waiting - the response
-            // will be checked again next update
+        }
+        catch (const std::exception& e) {
+            logger::error("Failed to process input: {}", e.what());
+            reply = "I'm having trouble thinking clearly right now.";
+        }
+
+        // The game thread picks it up with everyone else's results
+        Inbox::Post({Inbox::Kind::Response, self, std::move(reply)});
+    }
+
+
+    void SubAgent::Update() {
+        // The game thread never waits on the UI; we just get the next tick
+        std::unique_lock guard(updateMutex, std::try_to_lock);
+        if (!guard.owns_lock()) {
+            return;
+        }
+
+        // Remember what happened around us
+        PullWorldEvents();
+
+        // Fold old memories into summaries in the background
+        if (!consolidating.load() && Memory::consolidateMemories && Lod::PolicyFor(lod.tier.load()).background) {
+            ConsolidateMemories();
+        }
+
+        // Mine finished exchanges for facts, one request at a time (see MineFacts)
+        if (!miningFacts.load() && !isProcessingUpdate.load() && Lod::PolicyFor(lod.tier.load()).background) {
+            ExtractPendingFacts();
         }
 
         // Later, you might add other background processes here, such as:
         /* Future Features - Commented out for now
-        
-        // Periodically consolidate memories
-        if (shouldConsolidateMemories()) {
-            consolidateMemories();
-        }
 
         // Check for any completed importance calculations
         processImportanceCalculations();
@@ -263,18 +522,57 @@ namespace TESSERACT::Agent {
 
 
     // Private method definitions
-    void SubAgent::AddMemory(const std::string& role, const std::string& content) {
+    bool SubAgent::AddMemory(const std::string& role, const std::string& content, bool wait) {
         // Create new memory using our Memory system
         auto memory = Memory::CreateFromString(content, role);
-        
+
+        memory.tokens = CountTokens(memory);
+        auto fingerprint = Memory::SimHash(memory.role, memory.content);
+
+        // The game thread must not wait on a worker holding the lock (see Deliver)
+        std::unique_lock lock(memoryMutex, std::defer_lock);
+        if (wait) {
+            lock.lock();
+        } else if (!lock.try_lock()) {
+            return false;
+        }
+        memory.id = nextMemoryId++;
+
+        // The full transcript goes to disk; memories themselves stay bounded
+        Archive::Append(MemoryOwner(), Archive::Stream::Dialogue, memory.role, memory.content, memory.timestamp);
+
+        // Saying the same thing again replaces the old copy and counts the repetition,
+        // the new one goes last so the history order stays right. Only copies older than
+        // the verbatim history (see PrepareContext) are merged: erasing a turn the last
+        // prompt showed would reorder the conversation and break the cached prefix
+        bool repeated = false;
+        auto nearId = Memory::mergeRepeats ? fingerprints.FindNear(fingerprint) : 0;
+        if (nearId != 0 && nearId < historyAnchorId) {
+            auto it = std::lower_bound(memories.begin(), memories.end(), nearId,
+                [](const Memory::MemoryEntry& entry, std::uint32_t value) { return entry.id < value; });
+            if (it != memories.end() && it->id == nearId) {
+                memory.repetitions = static_cast<std::uint16_t>((std::min)(it->repetitions + 1, 0xFFFF));
+                memory.importance = (std::max)(memory.importance, it->importance);
+                EraseMemory(it);
+                repeated = true;
+            }
+        }
+
         // Add the new memory to our collection
         memories.push_back(memory);
-        
-        // Basic memory management - just remove oldest if we exceed capacity
-        if (memories.size() > Memory::maxMemories) {
-            // Remove oldest memory (first in vector)
-            memories.erase(memories.begin());
+        vectorIndex.Append();
+        memoriesDirty = true;
+
+        fingerprints.Add(memory.id, fingerprint);
+        lexicalIndex.Add(memory.id, memory.content);
+        Memory::Tiers::NoteHot(static_cast<std::int64_t>(memory.content.size()));
+        if (Memory::extractFacts && !repeated) {
+            pendingFactLines.push_back(std::format("{}: {}",
+                memory.role == "user" ? "Player" : memory.role == "action" ? "Action" : "You", memory.content));
         }
+        
+        EnforceCapacity();
+        DemoteOldMemories();
 
         /* Future Implementation - Commented out for now
         // Sophisticated memory management
@@ -288,32 +586,829 @@ namespace TESSERACT::Agent {
             memories.erase(leastImportant);
         }
         */
+        return true;
+    }
+
+
+    void SubAgent::AddSharedMemory(WorldEvents::EventRef event) {
+        // Only a handle and our own importance; the text stays in the event
+        Memory::MemoryEntry memory("event", "");
+        memory.importance = event->importance;
+        memory.timestamp = event->timestamp;
+        memory.event = std::move(event);
+        memory.tokens = CountTokens(memory);
+
+        memory.id = nextMemoryId++;
+        lexicalIndex.Add(memory.id, memory.Text());
+        memories.push_back(std::move(memory));
+        vectorIndex.Append();
+        memoriesDirty = true;
+
+        EnforceCapacity();
+    }
+
+
+    void SubAgent::EnforceCapacity() {
+        // Basic memory management - just remove the oldest raw turn if we exceed capacity
+        // (summaries cover far more history, so they are the last thing we drop)
+        if (memories.size() > Memory::maxMemories) {
+            auto oldest = std::find_if(memories.begin(), memories.end(),
+                [](const Memory::MemoryEntry& entry) { return entry.level == 0; });
+            if (oldest == memories.end()) {
+                oldest = memories.begin();
+            }
+            EraseMemory(oldest);
+        }
+    }
+
+
+    void SubAgent::EraseMemory(std::vector<Memory::MemoryEntry>::iterator it) {
+        ForgetMemory(*it);
+        vectorIndex.Erase(static_cast<size_t>(it - memories.begin()));
+        memories.erase(it);
+    }
+
+
+    void SubAgent::PullWorldEvents() {
+        WorldEvents::Collect(eventCursor, npc, heldEvents);
+        if (heldEvents.empty()) {
+            return;
+        }
+
+        // A worker holding the lock (retrieval, consolidation) just makes us keep them for the next tick
+        std::unique_lock lock(memoryMutex, std::try_to_lock);
+        if (!lock.owns_lock()) {
+            return;
+        }
+        for (auto& event : heldEvents) {
+            AddSharedMemory(std::move(event));
+        }
+        heldEvents.clear();
+    }
+
+
+    void SubAgent::ForgetMemory(const Memory::MemoryEntry& memory) {
+        lexicalIndex.Remove(memory.id);
+        fingerprints.Remove(memory.id);
+
+        if (memory.packed) {
+            Memory::Tiers::Release(memory.packed);
+        } else {
+            Memory::Tiers::NoteHot(-static_cast<std::int64_t>(memory.content.size()));
+        }
+    }
+
+
+    void SubAgent::DemoteOldMemories() {
+        // Raw turns past the hot window get packed; summaries and shared events stay put.
+        // Walk back from the window edge until we reach turns packed on an earlier call.
+        size_t hot = static_cast<size_t>((std::max)(Memory::hotMemories, 0));
+        if (memories.size() <= hot) {
+            return;
+        }
+
+        for (size_t i = memories.size() - hot; i-- > 0;) {
+            auto& memory = memories[i];
+            if (memory.packed) break;
+            if (memory.level > 0 || memory.event || memory.content.empty()) continue;
+
+            memory.packed = Memory::Tiers::Pack(memory.content);
+            Memory::Tiers::NoteHot(-static_cast<std::int64_t>(memory.content.size()));
+            std::string().swap(memory.content);
+        }
+    }
+
+
+    // Memories are laid out oldest level first: [level N ... level 1 ... raw turns].
+    // Rolling up always takes the oldest span of one level, so a span is contiguous
+    // and its summary can take the span's last id without breaking the id order.
+    void SubAgent::ConsolidateMemories() {
+        constexpr std::uint8_t kMaxLevel = 8;
+
+        if (!UI::Config::OpenAI::initialized.load() ||
+            activeConsolidations.load() >= Memory::maxConcurrentConsolidations) {
+            return;
+        }
+
+        std::vector<std::uint32_t> sourceIds;
+        std::vector<std::string> lines;
+        std::uint8_t targetLevel = 0;
+        std::time_t timestamp = 0;
+        {
+            // Called from Update() on the game thread: a busy lock means try again next tick
+            std::unique_lock lock(memoryMutex, std::try_to_lock);
+            if (!lock.owns_lock()) {
+                return;
+            }
+
+            std::array<size_t, kMaxLevel + 1> counts{};
+            for (const auto& memory : memories) {
+                counts[(std::min)(memory.level, kMaxLevel)]++;
+            }
+
+            // Roll up summaries first, lowest level first
+            std::uint8_t sourceLevel = 0;
+            size_t take = 0;
+            for (std::uint8_t level = 1; level < kMaxLevel; level++) {
+                if (counts[level] > static_cast<size_t>(Memory::summaryFanIn)) {
+                    sourceLevel = level;
+                    take = static_cast<size_t>(Memory::summaryFanIn);
+                    break;
+                }
+            }
+
+            // Otherwise fold the oldest raw turns, never touching the recent window
+            if (take == 0) {
+                if (counts[0] <= static_cast<size_t>(Memory::consolidationThreshold)) {
+                    return;
+                }
+                take = static_cast<size_t>(Memory::consolidationSpan);
+            }
+
+            // The span also stops at the summarizer's prompt budget, capped by our tier
+            const auto budget = Lod::PromptBudget(lod.tier.load(), Tokenizer::BudgetFor(Tokenizer::RequestClass::Consolidation).prompt);
+            std::uint32_t spanTokens = 0;
+
+            size_t recentStart = memories.size() - (std::min)(memories.size(), UI::Config::Chat::maxMessages);
+            for (size_t i = 0; i < recentStart && sourceIds.size() < take; i++) {
+                const auto& memory = memories[i];
+                if (memory.level != sourceLevel) continue;
+                spanTokens += TokensOf(memory) + 4;
+                if (spanTokens > budget && !sourceIds.empty()) break;
+
+                sourceIds.push_back(memory.id);
+                timestamp = memory.timestamp;
+                if (sourceLevel == 0) {
+                    const char* speaker = memory.role == "user" ? "Player" : memory.role == "event" ? "Event" :
+                        memory.role == "action" ? "Action" : "You";
+                    lines.push_back(std::format("{}: {}{}", speaker, memory.Text(), RepeatNote(memory)));
+                } else {
+                    lines.push_back(memory.Text());
+                }
+            }
+            targetLevel = sourceLevel + 1;
+        }
+
+        if (sourceIds.size() < 2) {
+            return;
+        }
+
+        // Only managed agents (see AgentManager.h) can keep themselves alive across the task
+        auto self = weak_from_this().lock();
+        if (!self) {
+            return;
+        }
+
+        ConsolidationResult result;
+        result.sourceIds = std::move(sourceIds);
+        result.level = targetLevel;
+        result.timestamp = timestamp;
+
+        activeConsolidations++;
+        consolidating.store(true);
+        Tasks::Spawn(Consolidate(std::move(self), std::move(result), std::move(lines),
+                                 Lod::ModelFor(lod.tier.load(), Memory::consolidationModel)));
+    }
+
+
+    Tasks::Task<void> SubAgent::Consolidate(std::shared_ptr<SubAgent> self, ConsolidationResult result,
+                                            std::vector<std::string> lines, std::string model) {
+        struct Done {
+            std::atomic<bool>& flag;
+            ~Done() {
+                flag.store(false);
+                activeConsolidations--;
+            }
+        } done{consolidating};
+
+        // Retiring us never waits on this: the task holds its own reference
+        try {
+            auto request = Tasks::BlockingIo([lines = std::move(lines), level = result.level, model]() {
+                return Memory::SummarizeMemories(lines, level, model);
+            });
+            result.summary = co_await request;
+        } catch (const std::exception& e) {
+            logger::warn("Consolidation request failed: {}", e.what());
+        }
+
+        co_await Tasks::ResumeOn{Tasks::Executor::Game};
+        ApplyConsolidation(std::move(result));
+    }
+
+
+    void SubAgent::ApplyConsolidation(ConsolidationResult result) {
+        if (result.summary.empty() || result.sourceIds.empty()) {
+            return;
+        }
+
+        std::lock_guard lock(memoryMutex);
+
+        // Drop the sources that are still around (some may have been evicted meanwhile)
+        std::uint8_t sourceLevel = result.level - 1;
+        thread_local std::vector<size_t> removedRows;
+        removedRows.clear();
+        for (size_t i = 0; i < memories.size(); i++) {
+            const auto& memory = memories[i];
+            if (memory.level == sourceLevel &&
+                std::binary_search(result.sourceIds.begin(), result.sourceIds.end(), memory.id)) {
+                ForgetMemory(memory);
+                removedRows.push_back(i);
+            }
+        }
+        auto removed = std::remove_if(memories.begin(), memories.end(),
+            [&](const Memory::MemoryEntry& memory) {
+                return memory.level == sourceLevel &&
+                    std::binary_search(result.sourceIds.begin(), result.sourceIds.end(), memory.id);
+            });
+        memories.erase(removed, memories.end());
+        vectorIndex.Erase(removedRows);
+
+        // The summary takes the span's last id, which keeps memories sorted by id
+        Memory::MemoryEntry summary("summary", result.summary);
+        summary.id = result.sourceIds.back();
+        summary.level = result.level;
+        summary.timestamp = result.timestamp;
+        summary.tokens = CountTokens(summary);
+
+        auto position = std::lower_bound(memories.begin(), memories.end(), summary.id,
+            [](const Memory::MemoryEntry& memory, std::uint32_t value) { return memory.id < value; });
+        lexicalIndex.Add(summary.id, summary.content);
+        Memory::Tiers::NoteHot(static_cast<std::int64_t>(summary.content.size()));
+        Archive::Append(MemoryOwner(), Archive::Stream::Summary, summary.role, summary.content, summary.timestamp);
+        vectorIndex.Insert(static_cast<size_t>(position - memories.begin()));
+        memories.insert(position, std::move(summary));
+        memoriesDirty = true;
+
+        logger::info("Consolidated {} memories into a level {} summary", result.sourceIds.size(), result.level);
+    }
+
+
+    void SubAgent::ExtractPendingFacts() {
+        if (pendingFactLines.empty() || !Memory::extractFacts || !UI::Config::OpenAI::initialized.load()) {
+            return;
+        }
+
+        // Only managed agents (see AgentManager.h) can keep themselves alive across the task
+        auto self = weak_from_this().lock();
+        if (!self) {
+            return;
+        }
+
+        miningFacts.store(true);
+        auto tier = lod.tier.load();
+        Tasks::Spawn(MineFacts(std::move(self), std::exchange(pendingFactLines, {}), Lod::ModelFor(tier, Memory::consolidationModel),
+                               Lod::PromptBudget(tier, Tokenizer::BudgetFor(Tokenizer::RequestClass::Extraction).prompt)));
+    }
+
+
+    Tasks::Task<void> SubAgent::MineFacts(std::shared_ptr<SubAgent> self, std::vector<std::string> lines, std::string model,
+                                          std::uint32_t promptBudget) {
+        struct Done {
+            std::atomic<bool>& flag;
+            ~Done() { flag.store(false); }
+        } done{miningFacts};
+
+        // The request waits on the I/O pool, not a thread of ours
+        std::vector<Memory::FactStore::Triple> triples;
+        try {
+            auto request = Tasks::BlockingIo([lines = std::move(lines), model, promptBudget]() {
+                return Memory::ExtractFacts(lines, model, promptBudget);
+            });
+            triples = co_await request;
+        } catch (const std::exception& e) {
+            logger::warn("Fact extraction request failed: {}", e.what());
+        }
+
+        // Learn them on the game thread, like everything else Update() applies
+        co_await Tasks::ResumeOn{Tasks::Executor::Game};
+        ApplyFacts(std::move(triples));
     }
 
 
-    std::vector<Communication::Message> SubAgent::PrepareContext() {
+    void SubAgent::ApplyFacts(std::vector<Memory::FactStore::Triple> triples) {
+        if (triples.empty()) {
+            return;
+        }
+
+        std::lock_guard lock(memoryMutex);
+        auto now = std::time(nullptr);
+        size_t learned = 0;
+        for (const auto& triple : triples) {
+            learned += facts.Assert(triple.subject, triple.predicate, triple.object, now, triple.replace);
+        }
+        facts.EvictOldest(static_cast<size_t>((std::max)(Memory::maxFacts, 0)));
+        if (learned > 0) {
+            memoriesDirty = true;
+            logger::info("Learned {} new facts ({} known)", learned, facts.Size());
+        }
+    }
+
+
+    std::vector<Communication::Message> SubAgent::RecentMessages(size_t count) const {
+        std::lock_guard lock(memoryMutex);
+
+        std::vector<Communication::Message> result;
+        for (auto it = memories.rbegin(); it != memories.rend() && result.size() < count; ++it) {
+            if (it->role == "user" || it->role == "assistant") {
+                result.push_back({it->role, it->Text(), it->timestamp});
+            }
+        }
+        std::reverse(result.begin(), result.end());
+        return result;
+    }
+
+    bool SubAgent::Deliver(Inbox::Kind kind, std::string& text) {
+        // The game thread never waits on the UI or a worker, like Update()
+        std::unique_lock guard(updateMutex, std::try_to_lock);
+        if (!guard.owns_lock()) {
+            return false;
+        }
+
+        switch (kind) {
+            case Inbox::Kind::Response:
+                // Store this response as a memory; a busy memory lock defers the whole result
+                if (!AddMemory("assistant", text, false)) {
+                    return false;
+                }
+                isProcessingUpdate.store(false);
+                Inbox::PostChatLine(MemoryOwner(), std::move(text));
+                break;
+
+            case Inbox::Kind::Action:
+                // Something we did ourselves, not something we saw: our own memory, told in the second person
+                if (!AddMemory("action", text, false)) {
+                    return false;
+                }
+                break;
+        }
+        return true;
+    }
+
+
+    // Blob layout (little endian):
+    //   u16 version, u32 nextMemoryId, u32 count,
+    //   count x { u32 id, u8 level, f32 importance, i64 timestamp, u16 role length, role, u32 content length, content,
+    //             u16 annotation length, annotation (versions 2-4, ignored), u16 repetitions (version 4+) },
+    //   u32 fact count, count x { u16-length subject, predicate, object, i64 timestamp } (version 3+)
+    // Shared events are stored by value and re-interned on load.
+    // Embeddings are not stored; restored memories are re-embedded on the next request.
+    namespace {
+        constexpr std::uint16_t kAgentStateVersion = 5;
+    }
+
+    bool SubAgent::SerializeIfDirty(std::vector<std::uint8_t>& out) {
+        std::lock_guard lock(memoryMutex);
+        if (!memoriesDirty) {
+            return false;
+        }
+
+        size_t bytes = 14 + facts.Size() * 40;
+        for (const auto& memory : memories) {
+            bytes += 25 + memory.role.size() + memory.TextSize();
+        }
+        out.clear();
+        out.reserve(bytes);
+
+        Persistence::BinaryWriter writer(out);
+        writer.Write(kAgentStateVersion);
+        writer.Write(nextMemoryId);
+        writer.Write(static_cast<std::uint32_t>(memories.size()));
+        for (const auto& memory : memories) {
+            writer.Write(memory.id);
+            writer.Write(memory.level);
+            writer.Write(memory.importance);
+            writer.Write(static_cast<std::int64_t>(memory.timestamp));
+            writer.WriteString<std::uint16_t>(memory.role);
+            writer.WriteString(memory.Text());
+            writer.Write(memory.repetitions);
+        }
+
+        writer.Write(static_cast<std::uint32_t>(facts.Size()));
+        facts.ForEach([&](const Memory::FactStore::Fact& fact) {
+            writer.WriteString<std::uint16_t>(facts.Term(fact.subject));
+            writer.WriteString<std::uint16_t>(facts.Term(fact.predicate));
+            writer.WriteString<std::uint16_t>(facts.Term(fact.object));
+            writer.Write(static_cast<std::int64_t>(fact.timestamp));
+        });
+
+        memoriesDirty = false;
+        return true;
+    }
+
+    bool SubAgent::Deserialize(std::span<const std::uint8_t> data) {
+        Persistence::BinaryReader reader(data);
+
+        std::uint16_t version;
+        std::uint32_t storedNextId;
+        std::uint32_t count;
+        if (!reader.Read(version) || version > kAgentStateVersion ||
+            !reader.Read(storedNextId) || !reader.Read(count)) {
+            return false;
+        }
+
+        std::vector<Memory::MemoryEntry> restored;
+        restored.reserve((std::min)(count, static_cast<std::uint32_t>(data.size() / 23)));
+        for (std::uint32_t i = 0; i < count; i++) {
+            Memory::MemoryEntry memory("", "");
+            std::int64_t timestamp;
+            std::string annotation;  // Never filled in, dropped in version 5
+            if (!reader.Read(memory.id) || !reader.Read(memory.level) || !reader.Read(memory.importance) ||
+                !reader.Read(timestamp) || !reader.ReadString<std::uint16_t>(memory.role) ||
+                !reader.ReadString(memory.content) ||
+                (version >= 2 && version <= 4 && !reader.ReadString<std::uint16_t>(annotation)) ||
+                (version >= 4 && !reader.Read(memory.repetitions))) {
+                return false;
+            }
+            if (!restored.empty() && memory.id <= restored.back().id) {
+                return false;  // Ids must be strictly increasing
+            }
+            memory.timestamp = static_cast<std::time_t>(timestamp);
+            if (memory.role == "event") {
+                memory.event = WorldEvents::Intern(memory.content, memory.timestamp, memory.importance);
+                memory.content.clear();
+            }
+            memory.tokens = CountTokens(memory);
+            restored.push_back(std::move(memory));
+        }
+
+        Memory::FactStore restoredFacts;
+        std::uint32_t factCount = 0;
+        if (version >= 3 && !reader.Read(factCount)) {
+            return false;
+        }
+        for (std::uint32_t i = 0; i < factCount; i++) {
+            std::string subject, predicate, object;
+            std::int64_t timestamp;
+            if (!reader.ReadString<std::uint16_t>(subject) || !reader.ReadString<std::uint16_t>(predicate) ||
+                !reader.ReadString<std::uint16_t>(object) || !reader.Read(timestamp)) {
+                return false;
+            }
+            restoredFacts.Assert(subject, predicate, object, static_cast<std::time_t>(timestamp));
+        }
+
+        std::lock_guard lock(memoryMutex);
+        for (const auto& memory : memories) {
+            ForgetMemory(memory);
+        }
+        memories = std::move(restored);
+        vectorIndex.Clear();
+        vectorIndex.Resize(memories.size());
+        facts = std::move(restoredFacts);
+        nextMemoryId = (std::max)(storedNextId, memories.empty() ? 1u : memories.back().id + 1);
+        for (const auto& memory : memories) {
+            lexicalIndex.Add(memory.id, memory.Text());
+            if (memory.level == 0 && !memory.event) {
+                fingerprints.Add(memory.id, Memory::SimHash(memory.role, memory.content));
+            }
+            Memory::Tiers::NoteHot(static_cast<std::int64_t>(memory.content.size()));
+        }
+        DemoteOldMemories();
+        memoriesDirty = false;
+
+        logger::info("Restored {} memories and {} facts", memories.size(), facts.Size());
+        return true;
+    }
+
+
+    std::uint32_t SubAgent::MemoryOwner() const {
+        return npc ? npc->GetFormID() : 0;
+    }
+
+
+    // Embeds every memory that isn't in the vector index yet, and the query with
+    // them (reusing a pending memory with the same text). Runs on the worker
+    // thread; embedding happens outside the lock.
+    std::vector<float> SubAgent::IndexPendingMemories(const std::string& query) {
+        std::vector<std::uint32_t> pendingIds;
+        std::vector<std::string> pendingContent;
+        auto space = Embedding::Space();
+        {
+            std::lock_guard lock(memoryMutex);
+
+            // Another provider, model or size was picked since: old vectors compare with nothing
+            if (embeddingSpace != space) {
+                if (embeddingSpace != 0) {
+                    logger::info("Embedding settings changed, re-embedding {} memories", memories.size());
+                }
+                embeddingSpace = space;
+                vectorIndex = Memory::VectorIndex(static_cast<size_t>(Memory::embeddingDimensions));
+                vectorIndex.Resize(memories.size());
+                for (auto& memory : memories) {
+                    memory.indexed = false;
+                }
+            }
+
+            for (const auto& memory : memories) {
+                if (!memory.indexed) {
+                    pendingIds.push_back(memory.id);
+                    pendingContent.push_back(memory.Text());
+                }
+            }
+        }
+
+        // Something else (a world event, an action) may have been added after the
+        // input, so the query is looked up by text rather than taken as the newest
+        auto queryIndex = static_cast<size_t>(std::find(pendingContent.begin(), pendingContent.end(), query) - pendingContent.begin());
+        if (queryIndex == pendingContent.size() && !query.empty()) {
+            pendingContent.push_back(query);
+        }
+        if (pendingContent.empty()) {
+            return {};
+        }
+
+        auto embeddings = Embedding::EmbedBatch(pendingContent);
+        if (embeddings.size() != pendingContent.size()) {
+            return {};
+        }
+
+        std::lock_guard lock(memoryMutex);
+        if (embeddingSpace != space || Embedding::Space() != space) {
+            return {};  // Changed while we were embedding; the next request starts over
+        }
+        for (size_t i = 0; i < pendingIds.size(); i++) {
+            // The memory might have been evicted while we were waiting
+            auto it = std::lower_bound(memories.begin(), memories.end(), pendingIds[i],
+                [](const Memory::MemoryEntry& memory, std::uint32_t id) { return memory.id < id; });
+            if (it == memories.end() || it->id != pendingIds[i]) continue;
+
+            it->indexed = vectorIndex.Set(static_cast<size_t>(it - memories.begin()), embeddings[i]);
+        }
+
+        if (queryIndex >= embeddings.size() || embeddings[queryIndex].size() != vectorIndex.Dimensions()) {
+            return {};
+        }
+        return std::move(embeddings[queryIndex]);
+    }
+
+
+    // Hybrid recall: every older memory gets a relevance from its embedding (exact
+    // cosine over the int8 codes), raised to its BM25 rank where the keyword search
+    // found it. Only memories older than beforeId are considered. Caller holds memoryMutex.
+    std::vector<std::uint32_t> SubAgent::RetrieveRelevant(const std::string& input, std::span<const float> queryEmbedding,
+                                                          std::uint32_t beforeId) const {
+        constexpr float kFusionOffset = 60.0f;
+        const auto topK = static_cast<size_t>(Memory::retrievalTopK);
+
+        auto end = std::lower_bound(memories.begin(), memories.end(), beforeId,
+            [](const Memory::MemoryEntry& memory, std::uint32_t value) { return memory.id < value; });
+        size_t candidates = static_cast<size_t>(end - memories.begin());
+
+        thread_local Scoring::Columns columns;
+        thread_local std::vector<float> scores;
+        thread_local std::vector<std::uint32_t> top;
+        columns.Resize(candidates);
+        scores.resize(candidates);
+
+        // One batch over the rows of every candidate; memories not embedded yet score 0
+        if (!queryEmbedding.empty()) {
+            vectorIndex.Relevance(queryEmbedding, std::span(columns.relevance.data(), candidates));
+        }
+
+        auto lexical = lexicalIndex.Search(input, topK * 2,
+            std::chrono::microseconds(Memory::lexicalBudgetMicros),
+            [beforeId](Memory::LexicalIndex::DocId doc) { return doc < beforeId; });
+        if (lexical.truncated) {
+            logger::debug("Lexical memory search ran out of its {}us budget", Memory::lexicalBudgetMicros);
+        }
+        // Rank 1 of the keyword search counts as fully relevant, the rest fall off like RRF
+        for (size_t rank = 0; rank < lexical.hits.size(); rank++) {
+            auto position = std::lower_bound(memories.begin(), end, lexical.hits[rank].doc,
+                [](const Memory::MemoryEntry& memory, std::uint32_t value) { return memory.id < value; });
+            if (position == end || position->id != lexical.hits[rank].doc) continue;
+
+            auto& relevance = columns.relevance[static_cast<size_t>(position - memories.begin())];
+            relevance = (std::max)(relevance, (kFusionOffset + 1) / (kFusionOffset + rank + 1));
+        }
+
+        // Rank every older memory: recency and importance count even without a search hit
+        auto now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+        for (size_t i = 0; i < candidates; i++) {
+            const auto& memory = memories[i];
+            columns.ageHours[i] = static_cast<float>((std::max)(now - memory.timestamp, std::time_t{0})) / 3600.0f;
+            columns.importance[i] = memory.importance;
+        }
+
+        Scoring::Weights weights;
+        weights.recency = Memory::recencyWeight;
+        weights.importance = Memory::importanceWeight;
+        weights.relevance = Memory::relevanceWeight;
+        weights.halfLifeHours = Memory::recencyHalfLifeHours;
+        Scoring::Score(columns, weights, scores.data());
+        Scoring::TopK(scores.data(), candidates, topK, top);
+
+        // Returned in the order they happened
+        std::vector<std::uint32_t> relevantIds;
+        for (auto index : top) {
+            relevantIds.push_back(memories[index].id);
+        }
+        std::sort(relevantIds.begin(), relevantIds.end());
+        return relevantIds;
+    }
+
+
+    namespace {
+        constexpr std::string_view kWitnessedPrefix = "You witnessed:";
+        constexpr std::string_view kLongTermHeader = "What you remember from longer ago:\n";
+        constexpr std::string_view kFactsHeader = "Facts you know (\"you\" is yourself):\n";
+        constexpr std::string_view kRecalledHeader = "Earlier memories that may be relevant:\n";
+        constexpr std::string_view kLoreHeader = "What you know of the world that may be relevant:\n";
+
+        std::string EventText(const Memory::MemoryEntry& memory) {
+            return std::format("{} {}", kWitnessedPrefix, memory.Text());
+        }
+    }
+
+    std::vector<Communication::Message> SubAgent::PrepareContext(const std::string& input, std::span<const float> queryEmbedding) {
         std::vector<Communication::Message> context;
         
-        // Combine personality and current state into one system message
-        std::string systemPrompt = 
-            Communication::GenerateSystemPrompt(npc) + "\n\n" +
-            Communication::GetNPCContext(npc);
-        
-        // Add the combined system message
-        context.push_back({
-            "system",
-            systemPrompt,
-            std::time(nullptr)
-        });
+        // Most stable first, so provider and server prefix caches keep hitting:
+        // world rules (every NPC), persona (this NPC), long-term memory, history,
+        // and only then what changes every turn (recall, facts, current state)
+        // We run on a worker, so the actor is only seen through its snapshot (see ActorSnapshot.h);
+        // only the state changes every turn, the rest is cached (see PersonaCache.h)
+        Snapshots::ActorSnapshot actor;
+        if (!Snapshots::Read(snapshotSlot, MemoryOwner(), actor)) {
+            logger::warn("No snapshot of {:08X} yet, prompt has no actor details", MemoryOwner());
+            actor.formId = MemoryOwner();
+        }
+
+        thread_local Prompts::SlotValues slots;
+        Prompts::FillSlots(actor, slots, Prompts::Get(Prompts::Section::State).Slots());
+        std::string state = Prompts::Render(Prompts::Section::State, slots);
+
+        std::lock_guard lock(memoryMutex);
+
+        if (Persona::Refresh(actor, personaBlock)) {
+            logger::info("Persona block rebuilt (hash {:016x})", personaBlock.hash);
+        }
+        context.push_back({"system", personaBlock.world, std::time(nullptr)});
+        context.push_back({"system", personaBlock.persona, std::time(nullptr)});
+
+        // Everything below has to fit the dialogue budget; the reply has its own reserve
+        // Agents far from the player get a smaller prompt (see Lod.h); a chat is
+        // always Focus, so this only bites when the tier lags behind a new pin
+        auto budget = Tokenizer::BudgetFor(Tokenizer::RequestClass::Dialogue);
+        budget.prompt = Lod::PromptBudget(lod.tier.load(), budget.prompt);
+        std::uint32_t used = Tokenizer::kReplyPriming + personaBlock.tokens + Tokenizer::CountMessage(state);
+        auto fits = [&](std::uint32_t tokens) { return used + tokens <= budget.prompt; };
+        auto lineTokens = [](std::string_view prefix, std::uint32_t textTokens) {
+            return Tokenizer::Count(prefix) + textTokens + 1;  // + newline
+        };
+        auto turnTokens = [](const Memory::MemoryEntry& memory) {
+            return TokensOf(memory) + Tokenizer::kMessageOverhead +
+                (memory.event ? Tokenizer::Count(kWitnessedPrefix) : 0) +
+                (memory.role == "user" && memory.repetitions > 1 ? Tokenizer::Count(RepeatNote(memory)) : 0);
+        };
+
+        // The most recent turns go in verbatim, newest first, within half of what is
+        // left (the newest one always goes in, it is what we are answering)
+        const std::uint32_t historyCap = budget.prompt > used ? (budget.prompt - used) / 2 : 0;
+        std::uint32_t historyTokens = 0;
+        size_t recentStart = memories.size();
+        while (recentStart > 0 && memories.size() - recentStart < UI::Config::Chat::maxMessages) {
+            auto cost = turnTokens(memories[recentStart - 1]);
+            if (recentStart < memories.size() && historyTokens + cost > historyCap) break;
+            historyTokens += cost;
+            recentStart--;
+        }
+
+        // Slide the window in half-window steps rather than one turn per request, so
+        // the history (and everything before it) stays a byte-identical prefix for a
+        // few turns at a time
+        auto anchor = std::lower_bound(memories.begin(), memories.end(), historyAnchorId,
+            [](const Memory::MemoryEntry& memory, std::uint32_t value) { return memory.id < value; });
+        size_t anchorIndex = static_cast<size_t>(anchor - memories.begin());
+        if (anchor != memories.end() && anchor->id == historyAnchorId && anchorIndex >= recentStart) {
+            recentStart = anchorIndex;
+        } else if (anchor != memories.end() && anchorIndex < recentStart && historyAnchorId != 0) {
+            recentStart += (memories.size() - recentStart) / 2;
+        }
+        if (recentStart < memories.size()) {
+            historyAnchorId = memories[recentStart].id;
+        }
+
+        historyTokens = 0;
+        for (size_t i = recentStart; i < memories.size(); i++) {
+            historyTokens += turnTokens(memories[i]);
+        }
+        used += historyTokens;
+
+        // Known facts that bear on the input: precise recall for a few tokens
+        std::string known;
+        if (Memory::factsInContext > 0) {
+            std::uint32_t blockTokens = Tokenizer::CountMessage(kFactsHeader);
+            for (auto id : facts.Relevant(input, static_cast<size_t>(Memory::factsInContext))) {
+                auto line = std::format("- {}\n", facts.Format(id));
+                auto tokens = Tokenizer::Count(line);
+                if (!fits(blockTokens + tokens)) break;
+                known += line;
+                blockTokens += tokens;
+            }
+            if (!known.empty()) used += blockTokens;
+        }
+
+        // A few lore passages that bear on the input, instead of a static lore dump
+        std::string lore;
+        if (Memory::loreInContext > 0 && Lore::IsReady()) {
+            std::uint32_t blockTokens = Tokenizer::CountMessage(kLoreHeader);
+            for (const auto& passage : Lore::Retrieve(input, static_cast<size_t>(Memory::loreInContext),
+                                                      std::chrono::microseconds(Memory::loreBudgetMicros))) {
+                auto line = std::format("- {}\n", passage.text);
+                auto tokens = Tokenizer::Count(line);
+                if (!fits(blockTokens + tokens)) continue;  // A shorter one may still fit
+                lore += line;
+                blockTokens += tokens;
+            }
+            if (!lore.empty()) used += blockTokens;
+        }
+
+        // Long-term continuity: the newest summary of every level, broadest first
+        std::vector<std::uint32_t> summaryIds;
+        std::string longTerm;
+        {
+            std::vector<const Memory::MemoryEntry*> summaries;
+            std::uint8_t lastLevel = 0;
+            for (size_t i = recentStart; i > 0; i--) {
+                const auto& memory = memories[i - 1];
+                if (memory.level > 0 && (lastLevel == 0 || memory.level > lastLevel)) {
+                    summaries.push_back(&memory);
+                    lastLevel = memory.level;
+                }
+            }
+
+            std::uint32_t blockTokens = Tokenizer::CountMessage(kLongTermHeader);
+            for (auto it = summaries.rbegin(); it != summaries.rend(); ++it) {
+                auto tokens = lineTokens("-", TokensOf(**it));
+                if (!fits(blockTokens + tokens)) break;
+                longTerm += std::format("- {}\n", (*it)->Text());
+                summaryIds.push_back((*it)->id);
+                blockTokens += tokens;
+            }
+            if (!longTerm.empty()) used += blockTokens;
+        }
+
+        // Older memories only go in if they are relevant to what was just said
+        std::string recalled;
+        if (recentStart > 0 && Memory::retrievalTopK > 0) {
+            auto relevantIds = RetrieveRelevant(input, queryEmbedding, memories[recentStart].id);
+
+            std::uint32_t blockTokens = Tokenizer::CountMessage(kRecalledHeader);
+            auto searchStart = memories.begin();
+            for (auto id : relevantIds) {
+                if (std::find(summaryIds.begin(), summaryIds.end(), id) != summaryIds.end()) continue;
+
+                auto it = std::lower_bound(searchStart, memories.begin() + recentStart, id,
+                    [](const Memory::MemoryEntry& memory, std::uint32_t value) { return memory.id < value; });
+                if (it == memories.begin() + recentStart || it->id != id) continue;
+                searchStart = it;
+
+                const char* speaker = it->event ? "- You witnessed:" :
+                    it->level > 0 ? "- Earlier:" : it->role == "user" ? "- The player said:" :
+                    it->role == "action" ? "-" : "- You said:";
+                auto note = RepeatNote(*it);
+                auto tokens = lineTokens(speaker, TokensOf(*it)) + (note.empty() ? 0 : Tokenizer::Count(note));
+                if (!fits(blockTokens + tokens)) continue;  // A shorter one may still fit
+
+                if (it->event) {
+                    recalled += std::format("- {}\n", EventText(*it));
+                } else {
+                    recalled += std::format("{} {}{}\n", speaker, it->Text(), note);
+                }
+                blockTokens += tokens;
+            }
+            if (!recalled.empty()) used += blockTokens;
+        }
+
+        if (!longTerm.empty()) {
+            context.push_back({"system", std::string(kLongTermHeader) + longTerm, std::time(nullptr)});
+        }
         
         // Add conversation history
-        for (const auto& memory : memories) {
+        for (size_t i = recentStart; i < memories.size(); i++) {
+            const auto& memory = memories[i];
             context.push_back({
-                memory.role,
-                memory.content,
+                memory.level > 0 || memory.event || memory.role == "action" ? "system" : memory.role,
+                memory.event ? EventText(memory) :
+                    memory.role == "user" ? memory.Text() + RepeatNote(memory) : memory.Text(),
                 memory.timestamp
             });
         }
+
+        // Per-turn context goes after the shared prefix
+        if (!known.empty()) {
+            context.push_back({"system", std::string(kFactsHeader) + known, std::time(nullptr)});
+        }
+        if (!lore.empty()) {
+            context.push_back({"system", std::string(kLoreHeader) + lore, std::time(nullptr)});
+        }
+        if (!recalled.empty()) {
+            context.push_back({"system", std::string(kRecalledHeader) + recalled, std::time(nullptr)});
+        }
+        context.push_back({"system", state, std::time(nullptr)});
+
+        lastPromptTokens.store(used);
+        logger::info("Prompt estimate: {} of {} tokens ({} recent turns, {} reserved for the reply{})",
+            used, budget.prompt, memories.size() - recentStart, budget.output, Tokenizer::IsExact() ? "" : ", approximate");
         
         return context;
     }
@@ -16,6 +16,23 @@
 #include <atomic>
 #include <memory>
 #include <format>
+#include <mutex>
+#include <span>
+
+// Memory retrieval
+#include "FactStore.h"
+#include "Fingerprint.h"
+#include "LexicalIndex.h"
+#include "MemoryIndex.h"
+#include "MemoryTiers.h"
+#include "WorldEvents.h"
+
+// Prompt assembly
+#include "ActorSnapshot.h"
+#include "PersonaCache.h"
+#include "Lod.h"
+#include "Inbox.h"
+#include "Tasks.h"
 
 // For logging
 namespace logger = SKSE::log;
@@ -30,9 +47,13 @@ namespace TESSERACT::Agent {
         };
 
         // Functions for handling OpenAI API calls
-        std::string SendOpenAIRequest(const std::vector<Message>& context, const std::string& userInput);
+        std::string SendOpenAIRequest(const std::vector<Message>& context, const std::string& userInput,
+                                      const std::string& model = "");  // Empty uses the chat model
         std::string GenerateSystemPrompt(const RE::Actor* npc);
         std::string GetNPCContext(const RE::Actor* npc);
+
+        // Embeddings for memory retrieval (one vector per input, empty on failure)
+        std::vector<std::vector<float>> RequestEmbeddings(const std::vector<std::string>& inputs);
     }
 
     // Memory system that any agent type can use
@@ -41,12 +62,93 @@ namespace TESSERACT::Agent {
         extern bool calculateImportance;  // Notice the 'extern' keyword
         extern int maxMemories;
 
-        // Memory object
+        // Retrieval settings
+        extern bool useLocalEmbeddings;  // In-process embedding engine instead of the remote endpoint
+        extern std::string embeddingModel;
+        extern int embeddingDimensions;
+        extern int retrievalTopK;      // Relevant older memories added on top of the recent turns
+        extern int lexicalBudgetMicros;  // Time budget for the BM25 search per request
+
+        // Ranking of recalled memories (see MemoryScoring.h)
+        extern float recencyWeight;
+        extern float importanceWeight;
+        extern float relevanceWeight;
+        extern float recencyHalfLifeHours;
+
+        // Consolidation settings
+        extern bool consolidateMemories;
+        extern int consolidationThreshold;      // Raw memories kept before the oldest span is summarized
+        extern int consolidationSpan;           // Raw memories folded into one level-1 summary
+        extern int summaryFanIn;                // Summaries of one level rolled into one of the next
+        extern int maxConcurrentConsolidations; // Across all agents, keeps this work low priority
+        extern std::string consolidationModel;  // Empty uses the chat model
+
+        // Fact extraction (see FactStore.h)
+        extern bool extractFacts;
+        extern int maxFacts;        // Per agent, oldest facts are dropped first
+        extern int factsInContext;  // Facts added to each request
+
+        // Near-duplicate suppression (see Fingerprint.h)
+        extern bool mergeRepeats;
+
+        // World lore grounding (see LoreIndex.h)
+        extern int loreInContext;      // Passages added to each request
+        extern int loreBudgetMicros;   // Time budget for the lore search per request
+
+        // Background ticking (see Scheduler.h)
+        extern int tickBudgetMicros;   // Game thread time per frame for updating agents
+        extern int actionBudgetMicros; // Game thread time per frame for applying actions (see ActionExecutor.h)
+
+        // NPC to NPC conversations (see SceneConversation.h)
+        extern bool sceneConversations;
+        extern int maxScenes;          // Playing at once
+
+        // Multi-perspective replies (see Cognition.h)
+        extern bool useCognitionGraph;
+
+        // Level of detail (see Lod.h)
+        extern int lodNearDistance;    // Game units
+        extern int lodFarDistance;
+        extern std::string lodFarModel;  // For far and dormant agents, empty uses the usual model
+
+        // Token budgets (see Tokenizer.h)
+        extern int contextTokenBudget;  // Prompt plus reply, per dialogue request
+        extern int replyTokenReserve;   // Part of the budget kept free for the reply
+        extern std::string tokenizerFile;
+
+        // Storage tiers (see MemoryTiers.h)
+        extern int hotMemories;   // Newest raw memories per agent kept uncompressed
+        extern int warmBudgetMB;  // Compressed blocks kept in RAM before spilling to disk
+
+        // Memory object (read text through Text(), shared events and packed memories keep it elsewhere)
         struct MemoryEntry {
-            std::string role;
+            std::string role;          // "user", "assistant", "event" (shared) or "action" (our own, see ActionExecutor.h)
             std::string content;
             float importance;
             std::time_t timestamp;
+            std::uint32_t id = 0;      // Per-agent, increases with every new memory
+            bool indexed = false;      // Embedded and added to the vector index
+            std::uint8_t level = 0;    // 0 = raw turn, 1+ = consolidated summary level
+            std::uint32_t tokens = 0;  // Prompt tokens of the text, counted at insert (0 = not counted)
+            std::uint16_t repetitions = 1;  // Near-duplicates merged into this one (see Fingerprint.h)
+
+            // Shared world event (content stays empty, the text lives in the event)
+            WorldEvents::EventRef event;
+
+            // Text moved to the warm/cold tiers (content is empty while packed)
+            Tiers::Handle packed;
+
+            std::string Text() const {
+                if (event) return event->content;
+                if (packed) return Tiers::Unpack(packed);
+                return content;
+            }
+            // Length of Text() without unpacking it
+            std::size_t TextSize() const {
+                if (event) return event->content.size();
+                if (packed) return packed.length;
+                return content.size();
+            }
             
             // Constructor for easy creation
             MemoryEntry(std::string r, std::string c, float imp = 1.0f) 
@@ -63,6 +165,13 @@ namespace TESSERACT::Agent {
         // Memory management functions
         void ProcessMemory(MemoryEntry& memory);
         float CalculateImportance(const std::string& content);
+
+        // Consolidation: fold a span of memories (oldest first) into one summary
+        std::string SummarizeMemories(const std::vector<std::string>& lines, int level, const std::string& model = "");
+
+        // Fact extraction: structured triples from a few lines of dialogue (promptBudget 0 = the extraction budget)
+        std::vector<FactStore::Triple> ExtractFacts(const std::vector<std::string>& lines, const std::string& model = "",
+                                                    std::uint32_t promptBudget = 0);
     }
 
     // The base SubAgent class
@@ -71,35 +180,97 @@ namespace TESSERACT::Agent {
     // - protected members for core mental state
     // - private methods for internal thought processes. 
     // The virtual functions allow us to create specialized types of agents later.
-    class SubAgent {
+    class SubAgent : public std::enable_shared_from_this<SubAgent> {
     public:
         // SubAgent(RE::Actor* npc, const std::string& role) 
         //     : npc(npc), agentRole(role) {}
         
         SubAgent(RE::Actor* npc, const std::string& role);
+        virtual ~SubAgent();
 
         // Core functionality
         virtual std::string ProcessInput(const std::string& input);
-        virtual void Update();  // Called regularly to update agent state
+        virtual void Update();  // Called every frame or so by the scheduler (see Scheduler.h)
 
         // Helper functions
         RE::Actor* GetNPC() const { return npc; } 
+        std::vector<Communication::Message> RecentMessages(size_t count) const;  // Raw turns, oldest first
+        std::uint32_t LastPromptTokens() const { return lastPromptTokens.load(); }  // Estimate for the last request
 
-        // Final message for UI
-        std::string latestResponse;
+        // Persistence (see Persistence.h)
+        bool SerializeIfDirty(std::vector<std::uint8_t>& out);  // False if nothing changed since the last call
+        bool Deserialize(std::span<const std::uint8_t> data);
+
+        // Game thread: a result a worker posted for us (see Inbox.h); false (text
+        // untouched) if the UI or a worker holds us right now, the inbox retries next frame
+        bool Deliver(Inbox::Kind kind, std::string& text);
+
+        // Latest copy of our actor from the game thread (see ActorSnapshot.h)
+        bool ReadSnapshot(Snapshots::ActorSnapshot& out) const { return Snapshots::Read(snapshotSlot, MemoryOwner(), out); }
+
+        // Level of detail, kept by the scheduler (see Lod.h)
+        Lod::AgentLod lod;
 
     protected:
-        RE::Actor* npc;
+        RE::Actor* npc;                             // Game thread only, workers read the snapshot
+        std::uint32_t snapshotSlot = Snapshots::kNoSlot;
         std::string agentRole;  // e.g., "id", "ego", "superego", "basal-ganglia"
-        std::vector<Memory::MemoryEntry> memories;
+        std::vector<Memory::MemoryEntry> memories;  // Ordered by id (oldest first)
+        std::uint32_t nextMemoryId = 1;
+        std::uint64_t eventCursor = 0;              // Last world event sequence seen
+        std::vector<WorldEvents::EventRef> heldEvents;  // Collected while memoryMutex was busy, stored next Update()
+        std::uint32_t historyAnchorId = 0;          // Oldest turn in the last prompt (see PrepareContext)
+        Persona::Block personaBlock;                // Rendered world and persona prompt, guarded by memoryMutex
+        bool memoriesDirty = false;                 // Changed since last serialized
+        mutable std::mutex memoryMutex;             // Guards memories (read by the worker thread)
+
+        // Retrieval indexes over memory embeddings and memory text
+        Memory::VectorIndex vectorIndex;            // Row i is memories[i], guarded by memoryMutex
+        std::uint64_t embeddingSpace = 0;           // Embedding::Space() the rows were made in
+        Memory::LexicalIndex lexicalIndex;          // Guarded by memoryMutex
+        Memory::FactStore facts;                    // Guarded by memoryMutex
+        Memory::FingerprintIndex fingerprints;      // Raw turns, guarded by memoryMutex
         
         // Async state (moved from ChatWindow)
         std::atomic<bool> isProcessingUpdate{false};
-        std::future<std::string> responseFuture;
+        std::atomic<std::uint32_t> lastPromptTokens{0};
+        std::mutex updateMutex;                     // Update() and Deliver() against ProcessInput() from the UI
+
+        // Background memory consolidation
+        struct ConsolidationResult {
+            std::vector<std::uint32_t> sourceIds;  // Ascending
+            std::uint8_t level = 0;                // Level of the new summary
+            std::time_t timestamp = 0;             // Timestamp of the newest source
+            std::string summary;                   // Empty on failure
+        };
+        std::atomic<bool> consolidating{false};      // A Consolidate task is in flight
+
+        // Background fact extraction
+        std::vector<std::string> pendingFactLines;  // Dialogue not yet mined for facts
+        std::atomic<bool> miningFacts{false};        // A MineFacts task is in flight
 
     private:
         // Internal helper functions
-        void AddMemory(const std::string& role, const std::string& content);
-        std::vector<Communication::Message> PrepareContext();
+        bool AddMemory(const std::string& role, const std::string& content, bool wait = true);  // False if !wait and memoryMutex is busy
+        void AddSharedMemory(WorldEvents::EventRef event);  // Caller holds memoryMutex
+        void PullWorldEvents();
+        void EnforceCapacity();  // Caller holds memoryMutex
+        void ForgetMemory(const Memory::MemoryEntry& memory);  // Indexes and storage; caller holds memoryMutex
+        void EraseMemory(std::vector<Memory::MemoryEntry>::iterator it);  // Forgets it and drops its row; caller holds memoryMutex
+        void DemoteOldMemories();  // Packs text outside the hot window; caller holds memoryMutex
+        void ConsolidateMemories();
+        Tasks::Task<void> Consolidate(std::shared_ptr<SubAgent> self, ConsolidationResult result,
+                                      std::vector<std::string> lines, std::string model);
+        void ApplyConsolidation(ConsolidationResult result);
+        void ExtractPendingFacts();
+        Tasks::Task<void> Respond(std::shared_ptr<SubAgent> self, std::string input, std::string model);
+        Tasks::Task<void> MineFacts(std::shared_ptr<SubAgent> self, std::vector<std::string> lines, std::string model,
+                                    std::uint32_t promptBudget);
+        void ApplyFacts(std::vector<Memory::FactStore::Triple> triples);
+        std::vector<float> IndexPendingMemories(const std::string& query);  // Returns the query's embedding
+        std::uint32_t MemoryOwner() const;
+        std::vector<std::uint32_t> RetrieveRelevant(const std::string& input, std::span<const float> queryEmbedding,
+                                                    std::uint32_t beforeId) const;
+        std::vector<Communication::Message> PrepareContext(const std::string& input, std::span<const float> queryEmbedding);
     };
 }
\ No newline at end of file
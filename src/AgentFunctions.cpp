@@ -2,10 +2,10 @@
 
 namespace TESSERACT::AgentFunctions {
     // Force the NPC to cast a spell
-    void ExecuteSpell(RE::Actor* actor, RE::SpellItem* spellItem, RE::TESObjectREFR* target) {
+    bool ExecuteSpell(RE::Actor* actor, RE::SpellItem* spellItem, RE::TESObjectREFR* target) {
         if (!actor || !spellItem) {
             logger::error("ExecuteSpell: Invalid actor or spell");
-            return;
+            return false;
         }
 
         auto* magicCaster = actor->GetMagicCaster(RE::MagicSystem::CastingSource::kInstant);
@@ -15,24 +15,31 @@ namespace TESSERACT::AgentFunctions {
                 spellItem->GetFormEditorID(), 
                 actor->GetFormID(), 
                 target ? target->GetFormID() : actor->GetFormID());
-        } else {
-            logger::error("MagicCaster not found for actor {}", actor->GetFormID());
+            return true;
         }
+        logger::error("MagicCaster not found for actor {}", actor->GetFormID());
+        return false;
     }
 
     // Force the Acquire Package on to the NPC
-    void ExecuteSpellAcquire(RE::Actor* actor, RE::TESQuest* questDestination, 
-                            uint32_t aliasID, float radius, const RE::BSFixedString& itemName) {
+    bool ExecuteSpellAcquire(RE::Actor* actor, RE::TESQuest* questDestination, 
+                            uint32_t aliasID, float radius, const RE::BSFixedString& itemName,
+                            RE::SpellItem* endSpell, const std::vector<RE::TESObjectREFR*>* scanned) {
         if (!actor || !questDestination) {
             logger::error("ExecuteSpellAcquire: Invalid actor or quest");
-            return;
+            return false;
         }
 
         logger::info("ExecuteSpellAcquire: Starting acquisition for {}", itemName.c_str());
         
         // Scan for objects in radius
         // std::vector<RE::TESObjectREFR*> scannedObjects = Utils::ScanningFunction(actor, radius);
-        std::vector<RE::TESObjectREFR*> scannedObjects = Utils::FastScanningFunction(actor, radius);
+        // (callers that already scanned around this actor pass their result)
+        std::vector<RE::TESObjectREFR*> ownScan;
+        if (!scanned) {
+            ownScan = Utils::FastScanningFunction(actor, radius);
+        }
+        const auto& scannedObjects = scanned ? *scanned : ownScan;
 
         // Find matching objects
         std::vector<RE::TESObjectREFR*> matchingObjects;
@@ -44,7 +51,7 @@ namespace TESSERACT::AgentFunctions {
 
         if (matchingObjects.empty()) {
             logger::info("ExecuteSpellAcquire: No matching items found");
-            return;
+            return false;
         }
 
         // Find closest object
@@ -62,27 +69,29 @@ namespace TESSERACT::AgentFunctions {
 
         // Force reference to alias and cast spell
         if (target && Utils::ForceRefToAlias(questDestination, aliasID, target)) {
-            RE::SpellItem* spellItem = RE::TESForm::LookupByEditorID<RE::SpellItem>("MP_TestAcquireEndSpell");
+            RE::SpellItem* spellItem = endSpell ? endSpell : RE::TESForm::LookupByEditorID<RE::SpellItem>(kAcquireSpell);
             if (spellItem) {
-                ExecuteSpell(actor, spellItem, target);
+                return ExecuteSpell(actor, spellItem, target);
             }
         }
+        return false;
     }
 
     // Force the Travel Package on to the NPC
-    void ExecuteSpellTravel(RE::Actor* actor, RE::TESQuest* questDestination, 
-                           RE::TESObjectREFR* target, unsigned int aliasID) {
+    bool ExecuteSpellTravel(RE::Actor* actor, RE::TESQuest* questDestination, 
+                           RE::TESObjectREFR* target, unsigned int aliasID, RE::SpellItem* endSpell) {
         if (!actor || !questDestination || !target) {
             logger::error("ExecuteSpellTravel: Invalid parameters");
-            return;
+            return false;
         }
 
         if (Utils::ForceRefToAlias(questDestination, aliasID, target)) {
-            RE::SpellItem* spellItem = RE::TESForm::LookupByEditorID<RE::SpellItem>("MP_TestTravelEndSpell");
+            RE::SpellItem* spellItem = endSpell ? endSpell : RE::TESForm::LookupByEditorID<RE::SpellItem>(kTravelSpell);
             if (spellItem) {
-                ExecuteSpell(actor, spellItem, target);
+                return ExecuteSpell(actor, spellItem, target);
             }
         }
+        return false;
     }
 
     // Initialize the package arrays
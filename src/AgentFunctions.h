@@ -3,12 +3,20 @@
 #include "SKSE/SKSE.h"
 #include "Utils.h"
 #include <limits>
+#include <vector>
 
 namespace TESSERACT::AgentFunctions {
-    // Core spell execution functions
-    void ExecuteSpell(RE::Actor* actor, RE::SpellItem* spellItem, RE::TESObjectREFR* target);
-    void ExecuteSpellAcquire(RE::Actor* actor, RE::TESQuest* questDestination, uint32_t aliasID, float radius, const RE::BSFixedString& itemName);
-    void ExecuteSpellTravel(RE::Actor* actor, RE::TESQuest* questDestination, RE::TESObjectREFR* target, unsigned int aliasID);
+    // Spells that start the acquire and travel packages
+    inline constexpr const char* kAcquireSpell = "MP_TestAcquireEndSpell";
+    inline constexpr const char* kTravelSpell = "MP_TestTravelEndSpell";
+
+    // Core spell execution functions (false if nothing was cast)
+    // The package spell is looked up when not passed (the action executor passes its cached one)
+    bool ExecuteSpell(RE::Actor* actor, RE::SpellItem* spellItem, RE::TESObjectREFR* target);
+    bool ExecuteSpellAcquire(RE::Actor* actor, RE::TESQuest* questDestination, uint32_t aliasID, float radius, const RE::BSFixedString& itemName,
+                             RE::SpellItem* endSpell = nullptr, const std::vector<RE::TESObjectREFR*>* scanned = nullptr);
+    bool ExecuteSpellTravel(RE::Actor* actor, RE::TESQuest* questDestination, RE::TESObjectREFR* target, unsigned int aliasID,
+                            RE::SpellItem* endSpell = nullptr);
 
     // Package Storage Dictionary
     // TODO Change all 128s to 127s since Placeholder0 is a container
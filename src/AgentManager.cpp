@@ -0,0 +1,281 @@
+#include "AgentManager.h"
+#include "Agent.h"
+#include <algorithm>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_set>
+#include <utility>
+
+namespace TESSERACT::Agent::Manager {
+    namespace {
+        // Role every managed agent is created with (same as the chat window used)
+        constexpr const char* kDefaultRole = "test";
+
+        struct Slot {
+            std::shared_ptr<SubAgent> agent;
+            RE::FormID formId = 0;
+            std::uint32_t generation = 0;
+            std::uint32_t pins = 0;
+        };
+
+        struct State {
+            std::shared_mutex mutex;
+            std::vector<Slot> slots;
+            std::vector<std::uint32_t> freeSlots;
+            std::vector<std::pair<RE::FormID, std::uint32_t>> byFormId;  // Sorted by FormID
+        };
+
+        State& GetState() {
+            static State state;
+            return state;
+        }
+
+        auto LowerBound(State& state, RE::FormID formId) {
+            return std::ranges::lower_bound(state.byFormId, formId, {}, &std::pair<RE::FormID, std::uint32_t>::first);
+        }
+
+        // Callers hold the lock exclusively; the agent is handed back so it is
+        // destroyed after the lock is released (the destructor does cleanup work)
+        std::shared_ptr<SubAgent> RetireLocked(State& state, RE::FormID formId) {
+            auto it = LowerBound(state, formId);
+            if (it == state.byFormId.end() || it->first != formId) {
+                return nullptr;
+            }
+
+            auto& slot = state.slots[it->second];
+            auto agent = std::move(slot.agent);
+            slot.formId = 0;
+            slot.pins = 0;
+            slot.generation++;
+            state.freeSlots.push_back(it->second);
+            state.byFormId.erase(it);
+            return agent;
+        }
+
+        AgentHandle HandleOf(const State& state, std::uint32_t index) {
+            return {index, state.slots[index].generation};
+        }
+
+        Slot* Resolve(State& state, AgentHandle handle) {
+            if (!handle || handle.slot >= state.slots.size()) {
+                return nullptr;
+            }
+            auto& slot = state.slots[handle.slot];
+            return slot.agent && slot.generation == handle.generation ? &slot : nullptr;
+        }
+    }
+
+    AgentHandle Acquire(RE::Actor* npc) {
+        if (!npc) {
+            return {};
+        }
+
+        auto& state = GetState();
+        auto formId = npc->GetFormID();
+        {
+            std::shared_lock lock(state.mutex);
+            auto it = LowerBound(state, formId);
+            if (it != state.byFormId.end() && it->first == formId) {
+                return HandleOf(state, it->second);
+            }
+        }
+
+        // Built outside the lock: the constructor restores saved memories
+        auto agent = std::make_shared<SubAgent>(npc, kDefaultRole);
+
+        std::unique_lock lock(state.mutex);
+        auto it = LowerBound(state, formId);
+        if (it != state.byFormId.end() && it->first == formId) {
+            // Someone else created it meanwhile; ours is dropped after unlocking
+            auto handle = HandleOf(state, it->second);
+            lock.unlock();
+            return handle;
+        }
+
+        std::uint32_t index;
+        if (!state.freeSlots.empty()) {
+            index = state.freeSlots.back();
+            state.freeSlots.pop_back();
+        } else {
+            index = static_cast<std::uint32_t>(state.slots.size());
+            state.slots.emplace_back();
+        }
+
+        auto& slot = state.slots[index];
+        slot.agent = std::move(agent);
+        slot.formId = formId;
+        slot.pins = 0;
+        state.byFormId.insert(it, {formId, index});
+
+        logger::info("Agent created for {} ({:08X}), {} managed", npc->GetName(), formId, state.byFormId.size());
+        return HandleOf(state, index);
+    }
+
+    AgentHandle Find(RE::FormID formId) {
+        auto& state = GetState();
+        std::shared_lock lock(state.mutex);
+        auto it = LowerBound(state, formId);
+        if (it == state.byFormId.end() || it->first != formId) {
+            return {};
+        }
+        return HandleOf(state, it->second);
+    }
+
+    std::shared_ptr<SubAgent> Get(AgentHandle handle) {
+        auto& state = GetState();
+        std::shared_lock lock(state.mutex);
+        auto* slot = Resolve(state, handle);
+        return slot ? slot->agent : nullptr;
+    }
+
+    void Pin(AgentHandle handle) {
+        auto& state = GetState();
+        std::unique_lock lock(state.mutex);
+        if (auto* slot = Resolve(state, handle)) {
+            slot->pins++;
+        }
+    }
+
+    void Unpin(AgentHandle handle) {
+        auto& state = GetState();
+        std::unique_lock lock(state.mutex);
+        if (auto* slot = Resolve(state, handle); slot && slot->pins > 0) {
+            slot->pins--;
+        }
+    }
+
+    void SyncHolding(const std::vector<RE::Actor*>& actors) {
+        std::unordered_set<RE::FormID> held;
+        held.reserve(actors.size());
+        for (auto* actor : actors) {
+            if (actor) {
+                held.insert(actor->GetFormID());
+            }
+        }
+
+        // Retire first so freed slots are reused by the newcomers
+        std::vector<std::shared_ptr<SubAgent>> retired;
+        {
+            auto& state = GetState();
+            std::unique_lock lock(state.mutex);
+
+            std::vector<RE::FormID> leaving;
+            for (const auto& [formId, index] : state.byFormId) {
+                if (!held.contains(formId) && state.slots[index].pins == 0) {
+                    leaving.push_back(formId);
+                }
+            }
+            for (auto formId : leaving) {
+                retired.push_back(RetireLocked(state, formId));
+            }
+        }
+        retired.clear();
+
+        for (auto* actor : actors) {
+            if (actor) {
+                Acquire(actor);
+            }
+        }
+    }
+
+    void Retire(RE::FormID formId) {
+        std::shared_ptr<SubAgent> agent;
+        {
+            auto& state = GetState();
+            std::unique_lock lock(state.mutex);
+            agent = RetireLocked(state, formId);
+        }
+    }
+
+    void Clear() {
+        std::vector<std::shared_ptr<SubAgent>> retired;
+        {
+            auto& state = GetState();
+            std::unique_lock lock(state.mutex);
+            for (const auto& [formId, index] : state.byFormId) {
+                auto& slot = state.slots[index];
+                retired.push_back(std::move(slot.agent));
+                slot.formId = 0;
+                slot.pins = 0;
+                slot.generation++;  // Slots stay so handles from before the load never resolve again
+                state.freeSlots.push_back(index);
+            }
+            state.byFormId.clear();
+        }
+
+        if (!retired.empty()) {
+            logger::info("Released {} agents", retired.size());
+        }
+    }
+
+    Entry Next(RE::FormID after) {
+        auto& state = GetState();
+        std::shared_lock lock(state.mutex);
+        if (state.byFormId.empty()) {
+            return {};
+        }
+
+        auto it = std::ranges::upper_bound(state.byFormId, after, {}, &std::pair<RE::FormID, std::uint32_t>::first);
+        if (it == state.byFormId.end()) {
+            it = state.byFormId.begin();
+        }
+        const auto& slot = state.slots[it->second];
+        return {it->first, HandleOf(state, it->second), slot.agent, slot.pins > 0};
+    }
+
+    std::size_t Count() {
+        auto& state = GetState();
+        std::shared_lock lock(state.mutex);
+        return state.byFormId.size();
+    }
+
+    void ForEach(const std::function<void(AgentHandle, SubAgent&)>& fn) {
+        // Copy out so callbacks may acquire or retire agents themselves
+        std::vector<std::pair<AgentHandle, std::shared_ptr<SubAgent>>> agents;
+        {
+            auto& state = GetState();
+            std::shared_lock lock(state.mutex);
+            agents.reserve(state.byFormId.size());
+            for (const auto& [formId, index] : state.byFormId) {
+                agents.emplace_back(HandleOf(state, index), state.slots[index].agent);
+            }
+        }
+
+        for (auto& [handle, agent] : agents) {
+            fn(handle, *agent);
+        }
+    }
+
+    // 12 bits of slot, 19 of generation, +1 so that 0 stays "none"
+    std::int32_t Pack(AgentHandle handle) {
+        if (!handle || handle.slot >= 0xFFF) {
+            return 0;
+        }
+        auto packed = ((handle.generation & 0x7FFFF) << 12) | handle.slot;
+        return static_cast<std::int32_t>(packed + 1);
+    }
+
+    AgentHandle Unpack(std::int32_t packed) {
+        if (packed <= 0) {
+            return {};
+        }
+        auto value = static_cast<std::uint32_t>(packed - 1);
+        auto handle = AgentHandle{value & 0xFFF, value >> 12};
+
+        // Generations wider than the packed field still round-trip
+        auto& state = GetState();
+        std::shared_lock lock(state.mutex);
+        if (handle.slot < state.slots.size() && (state.slots[handle.slot].generation & 0x7FFFF) == handle.generation) {
+            handle.generation = state.slots[handle.slot].generation;
+        }
+        return handle;
+    }
+
+    std::int32_t __stdcall GetAgentPapyrus(RE::StaticFunctionTag*, RE::Actor* actor) {
+        return actor ? Pack(Acquire(actor)) : 0;
+    }
+
+    bool __stdcall IsAgentValidPapyrus(RE::StaticFunctionTag*, std::int32_t handle) {
+        return Get(Unpack(handle)) != nullptr;
+    }
+}
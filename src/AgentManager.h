@@ -0,0 +1,81 @@
+#pragma once
+#include "RE/Skyrim.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+/**
+ * Agent Manager Overview
+ *
+ * Owns one long-lived agent per managed NPC, so conversations (and everything
+ * an agent remembers in RAM) survive closing the chat window.
+ *
+ * 1. Table:
+ *    - Agents live in a flat slot array; a FormID -> slot table kept sorted
+ *      finds them with a binary search (at most a few hundred entries)
+ *    - Freed slots are reused with a new generation
+ *
+ * 2. Handles:
+ *    - AgentHandle is (slot, generation), safe to keep anywhere: a handle to
+ *      a retired agent simply resolves to nothing
+ *    - Get() returns a shared_ptr, so an agent retired while a worker, the UI
+ *      or a Papyrus call still uses it is destroyed after that use ends
+ *    - Papyrus gets handles packed into an Int
+ *
+ * 3. Lifetime:
+ *    - Created lazily when an NPC enters the holding quest (SyncHolding) or a
+ *      chat opens; retired when they leave the holding quest and no chat has
+ *      them pinned; all retired on load, their memories are in the co-save
+ */
+
+namespace TESSERACT::Agent {
+    class SubAgent;
+
+    struct AgentHandle {
+        std::uint32_t slot = UINT32_MAX;
+        std::uint32_t generation = 0;
+
+        explicit operator bool() const { return slot != UINT32_MAX; }
+        bool operator==(const AgentHandle&) const = default;
+    };
+}
+
+namespace TESSERACT::Agent::Manager {
+    // Finds or creates the NPC's agent
+    AgentHandle Acquire(RE::Actor* npc);
+    AgentHandle Find(RE::FormID formId);
+    std::shared_ptr<SubAgent> Get(AgentHandle handle);
+
+    // Pinned agents survive leaving the holding quest (open chats)
+    void Pin(AgentHandle handle);
+    void Unpin(AgentHandle handle);
+
+    // Holding quest contents changed: agents for everyone in it, retire the rest
+    void SyncHolding(const std::vector<RE::Actor*>& actors);
+
+    void Retire(RE::FormID formId);
+    void Clear();  // Before a load or new game
+
+    // Round-robin walk (see Scheduler.h): first agent with a FormID after
+    // `after`, wrapping around; no agent when the table is empty
+    struct Entry {
+        RE::FormID formId = 0;
+        AgentHandle handle;
+        std::shared_ptr<SubAgent> agent;
+        bool pinned = false;  // In an open chat
+    };
+    Entry Next(RE::FormID after);
+
+    std::size_t Count();
+    void ForEach(const std::function<void(AgentHandle, SubAgent&)>& fn);
+
+    // Papyrus Int form of a handle (0 = none)
+    std::int32_t Pack(AgentHandle handle);
+    AgentHandle Unpack(std::int32_t packed);
+
+    // Papyrus
+    std::int32_t __stdcall GetAgentPapyrus(RE::StaticFunctionTag*, RE::Actor* actor);
+    bool __stdcall IsAgentValidPapyrus(RE::StaticFunctionTag*, std::int32_t handle);
+}
@@ -0,0 +1,407 @@
+#include "Cognition.h"
+#include "Agent.h"
+#include "Tokenizer.h"
+#include "UI.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <coroutine>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+
+namespace TESSERACT::Agent::Cognition {
+    namespace {
+        const std::filesystem::path kGraphPath = "Data\\SKSE\\Plugins\\TESSERACT\\cognition.json";
+
+        constexpr const char* kDefaultGraph = R"({
+            "stages": [
+                {
+                    "name": "basal-ganglia",
+                    "instructions": "Before {name} answers, decide whether they would answer the last thing said to them at all. Reply with one word: RESPOND, or IGNORE if {name} would refuse to talk right now (fleeing, busy fighting, deeply offended).",
+                    "maxTokens": 4,
+                    "timeoutMs": 3000,
+                    "skipWord": "IGNORE"
+                },
+                {
+                    "name": "id",
+                    "instructions": "Speak as the raw impulses of {name}: in one or two sentences, what do they want to say or do right now, ignoring manners and consequences? Do not write the reply itself.",
+                    "maxTokens": 80,
+                    "promptTokens": 2048
+                },
+                {
+                    "name": "superego",
+                    "instructions": "Speak as the conscience of {name}: in one or two sentences, what do their morals, station and the people around them expect of them here? Do not write the reply itself.",
+                    "maxTokens": 80,
+                    "promptTokens": 2048
+                },
+                {
+                    "name": "ego",
+                    "inputs": ["basal-ganglia", "id", "superego"],
+                    "instructions": "You are {name}. Weigh your impulses against your conscience, as noted below, then answer the player in character with spoken dialogue only.",
+                    "maxTokens": 300,
+                    "timeoutMs": 15000
+                }
+            ],
+            "output": "ego",
+            "silence": "*{name} does not answer.*"
+        })";
+
+        struct State {
+            Graph graph;
+            Prompts::Template silence;
+        };
+
+        State& GetState() {
+            static State state;
+            return state;
+        }
+
+        bool ParseGraph(const nlohmann::json& json, Graph& graph, Prompts::Template& silence, std::string& error) {
+            if (!json.is_object() || !json.contains("stages") || !json["stages"].is_array()) {
+                error = "no \"stages\" array";
+                return false;
+            }
+
+            std::vector<std::string> names;
+            for (const auto& entry : json["stages"]) {
+                if (!entry.is_object()) {
+                    error = std::format("stage {} is not an object", names.size() + 1);
+                    return false;
+                }
+                Stage stage;
+                stage.name = entry.value("name", "");
+                if (stage.name.empty() || std::ranges::find(names, stage.name) != names.end()) {
+                    error = std::format("stage {} needs a unique name", names.size() + 1);
+                    return false;
+                }
+
+                for (const auto& input : entry.value("inputs", nlohmann::json::array())) {
+                    auto name = input.is_string() ? input.get<std::string>() : std::string();
+                    auto found = std::ranges::find(names, name);
+                    if (found == names.end()) {
+                        error = std::format("{} reads \"{}\", which is not declared before it", stage.name, name);
+                        return false;
+                    }
+                    stage.inputs.push_back(static_cast<std::size_t>(found - names.begin()));
+                }
+
+                stage.instructions = Prompts::Template::Parse(entry.value("instructions", ""));
+                stage.maxTokens = entry.value("maxTokens", stage.maxTokens);
+                stage.promptTokens = entry.value("promptTokens", stage.promptTokens);
+                stage.timeout = std::chrono::milliseconds(entry.value("timeoutMs", static_cast<int>(stage.timeout.count())));
+                stage.model = entry.value("model", "");
+                stage.skipWord = entry.value("skipWord", "");
+
+                names.push_back(stage.name);
+                graph.stages.push_back(std::move(stage));
+            }
+
+            auto output = std::ranges::find(names, json.value("output", names.empty() ? "" : names.back()));
+            if (output == names.end()) {
+                error = "\"output\" is not a stage";
+                return false;
+            }
+            graph.output = static_cast<std::size_t>(output - names.begin());
+            graph.silence = json.value("silence", "...");
+            silence = Prompts::Template::Parse(graph.silence);
+            return true;
+        }
+
+        // A field of the wrong type ("maxTokens": "lots") throws from json::value; that is a bad file, not a crash
+        bool Parse(const nlohmann::json& json, Graph& graph, Prompts::Template& silence, std::string& error) {
+            try {
+                return ParseGraph(json, graph, silence, error);
+            } catch (const nlohmann::json::exception& e) {
+                error = e.what();
+                return false;
+            }
+        }
+
+        bool StartsWithWord(std::string_view text, std::string_view word) {
+            while (!text.empty() && !std::isalpha(static_cast<unsigned char>(text.front()))) {
+                text.remove_prefix(1);
+            }
+            if (text.size() < word.size()) {
+                return false;
+            }
+            return std::equal(word.begin(), word.end(), text.begin(), [](char a, char b) {
+                return std::tolower(static_cast<unsigned char>(a)) == std::tolower(static_cast<unsigned char>(b));
+            });
+        }
+
+        // Oldest history goes first; system messages and the input (the last user
+        // message, PrepareContext puts the volatile system blocks after it) stay
+        void TrimToBudget(std::vector<Communication::Message>& messages, std::uint32_t budget) {
+            std::uint32_t used = Tokenizer::kReplyPriming;
+            for (const auto& message : messages) {
+                used += Tokenizer::CountMessage(message.content);
+            }
+            auto input = std::find_if(messages.rbegin(), messages.rend(),
+                [](const Communication::Message& message) { return message.role == "user"; });
+            auto inputIndex = input == messages.rend() ? messages.size() : static_cast<std::size_t>(messages.rend() - input - 1);
+
+            std::size_t index = 0;
+            for (auto it = messages.begin(); used > budget && it != messages.end();) {
+                if (it->role == "system" || index == inputIndex) {
+                    ++it;
+                    ++index;
+                    continue;
+                }
+                used -= Tokenizer::CountMessage(it->content);
+                it = messages.erase(it);
+                if (index < inputIndex) {
+                    inputIndex--;
+                }
+            }
+        }
+
+        nlohmann::json MakeRequest(const std::vector<Communication::Message>& messages, const std::string& model,
+                                   std::uint32_t maxTokens) {
+            nlohmann::json request = {
+                {"model", model},
+                {"messages", nlohmann::json::array()},
+                {"max_tokens", maxTokens}
+            };
+            for (const auto& message : messages) {
+                request["messages"].push_back({{"role", message.role}, {"content", message.content}});
+            }
+            return request;
+        }
+
+        struct StageOutput {
+            bool finished = false;
+            bool failed = false;  // The request threw; text is empty
+            std::string text;
+        };
+
+        // Stages outlive a run that stopped waiting for them, so they share this by pointer
+        struct RunState {
+            std::mutex mutex;
+            std::vector<StageOutput> outputs;
+            std::coroutine_handle<> waiter;  // Run, while suspended in Wait
+            std::uint64_t waits = 0;         // Tells a stale deadline timer from the current wait
+            bool news = false;               // A stage finished since Run last looked
+            std::atomic<bool> over{false};   // Run returned; stages still queued are never sent
+
+            // Any thread: resumes Run on a pool worker if it is waiting (workers never block, see Tasks.h)
+            void Wake(std::unique_lock<std::mutex>& lock) {
+                news = true;
+                if (auto handle = std::exchange(waiter, {})) {
+                    lock.unlock();
+                    Tasks::Post(Tasks::Executor::Worker, [handle]() { handle.resume(); });
+                }
+            }
+
+            void Finish(std::size_t index, std::string text, bool failed) {
+                std::unique_lock lock(mutex);
+                outputs[index] = {true, failed, std::move(text)};
+                Wake(lock);
+            }
+        };
+
+        // co_await Wait{run, deadline}: until a stage finishes or the deadline passes, without holding a thread
+        struct Wait {
+            const std::shared_ptr<RunState>& run;  // Run's own, which outlives the wait
+            std::chrono::steady_clock::time_point deadline;
+
+            bool await_ready() const noexcept { return false; }
+            bool await_suspend(std::coroutine_handle<> handle) {
+                std::lock_guard lock(run->mutex);
+                if (run->news) {
+                    return false;
+                }
+                run->waiter = handle;
+                auto wait = ++run->waits;
+                if (deadline != std::chrono::steady_clock::time_point::max()) {
+                    Tasks::PostAfter(deadline - std::chrono::steady_clock::now(), Tasks::Executor::Worker,
+                        [run = run, wait]() {
+                            std::unique_lock lock(run->mutex);
+                            if (run->waits == wait && run->waiter) {
+                                run->Wake(lock);
+                            }
+                        });
+                }
+                return true;
+            }
+            void await_resume() {
+                std::lock_guard lock(run->mutex);
+                run->news = false;
+            }
+        };
+
+        // The request itself times out with the stage, so an abandoned stage stops waiting on the I/O pool too
+        Tasks::Task<void> RunStage(std::shared_ptr<RunState> run, std::size_t index, nlohmann::json request, std::string name,
+                                   std::chrono::milliseconds timeout) {
+            std::string output;
+            bool failed = false;
+            try {
+                auto send = Tasks::BlockingIo([run, request = std::move(request)]() {
+                    // Nobody reads it anymore (gate exit, output timed out): don't send it
+                    return run->over.load() ? nlohmann::json() : openai::chat().create(request);
+                }, timeout);
+                auto chat = co_await send;
+                if (chat.is_null()) {
+                    co_return;
+                }
+                output = chat["choices"][0]["message"]["content"].get<std::string>();
+            } catch (const Tasks::TimeoutError&) {
+                co_return;  // Run times the stage out at the same deadline
+            } catch (const std::exception& e) {
+                logger::error("Cognition stage {} failed: {}", name, e.what());
+                failed = true;
+            }
+            run->Finish(index, std::move(output), failed);
+        }
+
+        enum class Status : std::uint8_t { Waiting, Running, Done, Failed, TimedOut };
+    }
+
+    void Initialize() {
+        auto& state = GetState();
+
+        std::string error;
+        Graph graph;
+        Prompts::Template silence;
+        if (!Parse(nlohmann::json::parse(kDefaultGraph), graph, silence, error)) {
+            logger::error("Built-in cognition graph is invalid: {}", error);
+        }
+        state.graph = std::move(graph);
+        state.silence = std::move(silence);
+
+        std::ifstream file(kGraphPath);
+        if (!file.is_open()) {
+            return;
+        }
+
+        auto json = nlohmann::json::parse(file, nullptr, false);
+        Graph custom;
+        if (json.is_discarded() || !Parse(json, custom, silence, error)) {
+            logger::error("Could not use {} ({}), keeping the built-in cognition graph",
+                          kGraphPath.string(), json.is_discarded() ? "invalid JSON" : error);
+            return;
+        }
+        state.graph = std::move(custom);
+        state.silence = std::move(silence);
+        logger::info("Using custom cognition graph with {} stages", state.graph.stages.size());
+    }
+
+    const Graph& Get() {
+        return GetState().graph;
+    }
+
+    Tasks::Task<Result> Run(std::vector<Communication::Message> context, Prompts::SlotValues slots, std::string model) {
+        const auto& state = GetState();
+        const auto& graph = state.graph;
+        const auto count = graph.stages.size();
+
+        Result result;
+        auto run = std::make_shared<RunState>();
+        run->outputs.resize(count);
+        struct Over {
+            RunState& run;
+            ~Over() { run.over.store(true); }
+        } over{*run};
+        std::vector<Status> status(count, Status::Waiting);
+        std::vector<std::chrono::steady_clock::time_point> deadlines(count);
+
+        auto inputText = [&](std::size_t index) {
+            std::lock_guard lock(run->mutex);
+            const auto& output = run->outputs[index];
+            return status[index] == Status::Done && !output.text.empty() ? output.text : std::string("(no answer)");
+        };
+
+        auto launch = [&](std::size_t index) {
+            const auto& stage = graph.stages[index];
+
+            auto messages = context;
+            if (stage.promptTokens > 0) {
+                TrimToBudget(messages, stage.promptTokens);
+            }
+            std::string instructions;
+            stage.instructions.Render(slots, instructions);
+            for (auto input : stage.inputs) {
+                instructions += std::format("\n\n{}: {}", graph.stages[input].name, inputText(input));
+            }
+            messages.push_back({"system", std::move(instructions), std::time(nullptr)});
+
+            status[index] = Status::Running;
+            deadlines[index] = std::chrono::steady_clock::now() + stage.timeout;
+            result.stagesRun++;
+
+            // On the I/O pool like every other request; one that times out is abandoned, not waited for
+            Tasks::Spawn(RunStage(run, index, MakeRequest(messages, stage.model.empty() ? model : stage.model, stage.maxTokens),
+                                  stage.name, stage.timeout));
+        };
+
+        while (true) {
+            // Start everything whose inputs are settled
+            for (std::size_t i = 0; i < count; i++) {
+                if (status[i] == Status::Waiting &&
+                    std::ranges::all_of(graph.stages[i].inputs, [&](std::size_t input) {
+                        return status[input] == Status::Done || status[input] == Status::Failed ||
+                            status[input] == Status::TimedOut;
+                    })) {
+                    launch(i);
+                }
+            }
+
+            if (status[graph.output] == Status::Done || status[graph.output] == Status::Failed) {
+                std::string reply;
+                {
+                    std::lock_guard lock(run->mutex);
+                    reply = run->outputs[graph.output].text;
+                }
+                if (reply.empty()) {
+                    // One plain reply rather than a placeholder from the graph
+                    logger::warn("Cognition output stage gave no answer, answering without the graph");
+                    auto request = Tasks::BlockingIo([context, model]() { return Communication::SendOpenAIRequest(context, "", model); });
+                    reply = co_await request;
+                }
+                result.reply = std::move(reply);
+                co_return result;
+            }
+            if (status[graph.output] == Status::TimedOut) {
+                result.reply = "I'm having trouble thinking clearly right now.";
+                co_return result;
+            }
+
+            auto nextDeadline = std::chrono::steady_clock::time_point::max();
+            for (std::size_t i = 0; i < count; i++) {
+                if (status[i] == Status::Running) {
+                    nextDeadline = (std::min)(nextDeadline, deadlines[i]);
+                }
+            }
+            co_await Wait{run, nextDeadline};
+
+            auto now = std::chrono::steady_clock::now();
+            for (std::size_t i = 0; i < count; i++) {
+                if (status[i] != Status::Running) {
+                    continue;
+                }
+
+                std::unique_lock lock(run->mutex);
+                const auto& output = run->outputs[i];
+                if (output.finished && output.failed) {
+                    status[i] = Status::Failed;
+                    result.failures++;
+                } else if (output.finished) {
+                    status[i] = Status::Done;
+                    const auto& skipWord = graph.stages[i].skipWord;
+                    if (!skipWord.empty() && StartsWithWord(output.text, skipWord)) {
+                        // Nothing else starts; stages still running finish on their own
+                        lock.unlock();
+                        logger::info("Cognition stage {} decided not to answer", graph.stages[i].name);
+                        state.silence.Render(slots, result.reply);
+                        result.silent = true;
+                        co_return result;
+                    }
+                } else if (now >= deadlines[i]) {
+                    status[i] = Status::TimedOut;
+                    result.timeouts++;
+                    logger::warn("Cognition stage {} timed out", graph.stages[i].name);
+                }
+            }
+        }
+    }
+}
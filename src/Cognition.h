@@ -0,0 +1,77 @@
+#pragma once
+#include "PromptTemplates.h"
+#include "Tasks.h"
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+/**
+ * Cognition Graph Overview
+ *
+ * Lets one NPC think from several perspectives (id, superego, ...) before it
+ * answers, at roughly the latency of one call plus the arbitration.
+ *
+ * 1. Graph:
+ *    - Stages declared in Data\SKSE\Plugins\TESSERACT\cognition.json, built-in
+ *      default otherwise; a stage only lists inputs declared before it, so
+ *      the graph is acyclic by construction
+ *    - Each stage sees the normal dialogue context, its own instructions
+ *      (a prompt template, see PromptTemplates.h) and the output of its inputs
+ *    - The "output" stage's answer is the reply
+ *
+ * 2. Execution:
+ *    - Every stage whose inputs are done starts at once as a request on the
+ *      I/O pool (see Tasks.h), so independent stages run side by side and
+ *      the run itself holds no thread while it waits
+ *    - Per stage: reply token cap, prompt token cap (oldest history dropped
+ *      first, the input never), timeout and model; a stage that fails or
+ *      times out gives its dependents "(no answer)"
+ *    - A stage's request times out with the stage, and stages still queued
+ *      when the run returns are never sent
+ *    - If the output stage fails or answers nothing, the NPC answers with a
+ *      plain chat request instead
+ *
+ * 3. Early exit:
+ *    - A gate stage whose answer starts with its skip word ends the run: no
+ *      further stages start and the NPC answers with the graph's silence line
+ */
+
+namespace TESSERACT::Agent::Communication {
+    struct Message;
+}
+
+namespace TESSERACT::Agent::Cognition {
+    struct Stage {
+        std::string name;
+        Prompts::Template instructions;
+        std::vector<std::size_t> inputs;  // Earlier stages
+        std::uint32_t maxTokens = 150;
+        std::uint32_t promptTokens = 0;   // 0 = the whole context
+        std::chrono::milliseconds timeout{8000};
+        std::string model;                // Empty uses the agent's model
+        std::string skipWord;             // Gate stages only
+    };
+
+    struct Graph {
+        std::vector<Stage> stages;
+        std::size_t output = 0;
+        std::string silence;  // Reply when a gate decides not to answer
+    };
+
+    // Startup: built-in graph, replaced by cognition.json if it is valid
+    void Initialize();
+    const Graph& Get();
+
+    struct Result {
+        std::string reply;
+        bool silent = false;         // A gate ended the run
+        std::uint32_t stagesRun = 0;
+        std::uint32_t timeouts = 0;
+        std::uint32_t failures = 0;  // Stages whose request threw
+    };
+
+    // Completes when the output stage answers, a gate exits or the output stage timed out
+    Tasks::Task<Result> Run(std::vector<Communication::Message> context, Prompts::SlotValues slots, std::string model);
+}
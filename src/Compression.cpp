@@ -0,0 +1,127 @@
+#include "Compression.h"
+#include <array>
+#include <cstring>
+
+namespace TESSERACT::Utils::Compression {
+    namespace {
+        constexpr std::size_t kMinMatch = 4;
+        constexpr std::size_t kMaxOffset = 65535;
+        constexpr int kHashBits = 13;
+
+        std::uint32_t Read32(const std::uint8_t* p) {
+            std::uint32_t value;
+            std::memcpy(&value, p, sizeof(value));
+            return value;
+        }
+
+        std::uint32_t Hash(std::uint32_t value) {
+            return (value * 2654435761u) >> (32 - kHashBits);
+        }
+
+        void WriteLength(std::vector<std::uint8_t>& out, std::size_t length) {
+            while (length >= 255) {
+                out.push_back(255);
+                length -= 255;
+            }
+            out.push_back(static_cast<std::uint8_t>(length));
+        }
+
+        void EmitSequence(std::vector<std::uint8_t>& out, const std::uint8_t* literals, std::size_t literalLength,
+                          std::size_t offset, std::size_t matchLength) {
+            std::size_t matchCode = matchLength ? matchLength - kMinMatch : 0;
+            std::uint8_t token = static_cast<std::uint8_t>(((literalLength < 15 ? literalLength : 15) << 4) |
+                                                           (matchCode < 15 ? matchCode : 15));
+            out.push_back(token);
+            if (literalLength >= 15) WriteLength(out, literalLength - 15);
+            out.insert(out.end(), literals, literals + literalLength);
+
+            if (matchLength == 0) return;
+            out.push_back(static_cast<std::uint8_t>(offset & 0xFF));
+            out.push_back(static_cast<std::uint8_t>(offset >> 8));
+            if (matchCode >= 15) WriteLength(out, matchCode - 15);
+        }
+
+        bool ReadLength(const std::uint8_t*& in, const std::uint8_t* end, std::size_t& length) {
+            std::uint8_t byte;
+            do {
+                if (in >= end) return false;
+                byte = *in++;
+                length += byte;
+            } while (byte == 255);
+            return true;
+        }
+    }
+
+    void Compress(std::span<const std::uint8_t> input, std::vector<std::uint8_t>& out) {
+        const std::uint8_t* base = input.data();
+        const std::size_t size = input.size();
+        out.reserve(out.size() + size / 2 + 16);
+
+        std::array<std::uint32_t, 1 << kHashBits> table{};  // Position + 1, 0 = empty
+        std::size_t anchor = 0;
+        std::size_t pos = 0;
+
+        while (size >= kMinMatch && pos + kMinMatch <= size) {
+            std::uint32_t value = Read32(base + pos);
+            std::uint32_t& slot = table[Hash(value)];
+            std::size_t candidate = slot;
+            slot = static_cast<std::uint32_t>(pos + 1);
+
+            if (candidate == 0 || pos - (candidate - 1) > kMaxOffset || Read32(base + candidate - 1) != value) {
+                pos++;
+                continue;
+            }
+
+            std::size_t match = candidate - 1;
+            std::size_t length = kMinMatch;
+            while (pos + length < size && base[match + length] == base[pos + length]) {
+                length++;
+            }
+
+            EmitSequence(out, base + anchor, pos - anchor, pos - match, length);
+            pos += length;
+            anchor = pos;
+        }
+
+        // Trailing literals
+        EmitSequence(out, base + anchor, size - anchor, 0, 0);
+    }
+
+    bool Decompress(std::span<const std::uint8_t> input, std::span<std::uint8_t> out) {
+        const std::uint8_t* in = input.data();
+        const std::uint8_t* end = in + input.size();
+        std::size_t written = 0;
+
+        while (in < end) {
+            std::uint8_t token = *in++;
+
+            std::size_t literalLength = token >> 4;
+            if (literalLength == 15 && !ReadLength(in, end, literalLength)) return false;
+            if (literalLength > static_cast<std::size_t>(end - in) || literalLength > out.size() - written) return false;
+            std::memcpy(out.data() + written, in, literalLength);
+            in += literalLength;
+            written += literalLength;
+
+            if (in == end) break;  // Last sequence
+
+            if (end - in < 2) return false;
+            std::size_t offset = in[0] | (static_cast<std::size_t>(in[1]) << 8);
+            in += 2;
+            std::size_t matchLength = token & 0x0F;
+            if (matchLength == 15 && !ReadLength(in, end, matchLength)) return false;
+            matchLength += kMinMatch;
+
+            if (offset == 0 || offset > written || matchLength > out.size() - written) return false;
+
+            // Byte by byte: matches may overlap their own output
+            std::uint8_t* dst = out.data() + written;
+            const std::uint8_t* src = dst - offset;
+            for (std::size_t i = 0; i < matchLength; i++) {
+                dst[i] = src[i];
+            }
+            written += matchLength;
+        }
+
+        return written == out.size();
+    }
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+/**
+ * Block Compression
+ *
+ * Small LZ77 byte compressor for memory text blocks. Dialogue compresses well
+ * (names, phrases and speaker prefixes repeat) and we only need something that
+ * is fast to decompress, so this is an LZ4-style format with no entropy coding:
+ *
+ *   sequence := token [literal length bytes] literals [offset u16 [match length bytes]]
+ *   token    := (literal length << 4) | (match length - 4), 15 = "more bytes follow"
+ *
+ * The last sequence has literals only. Matches are found with a single-probe
+ * hash table of 4-byte prefixes over a 64 KB window.
+ */
+
+namespace TESSERACT::Utils::Compression {
+    // Appends the compressed form of input to out
+    void Compress(std::span<const std::uint8_t> input, std::vector<std::uint8_t>& out);
+
+    // Decompresses into out, which must be sized to the original length; false on corrupt input
+    bool Decompress(std::span<const std::uint8_t> input, std::span<std::uint8_t> out);
+}
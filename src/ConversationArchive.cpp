@@ -0,0 +1,582 @@
+#include "ConversationArchive.h"
+#include "MappedFile.h"
+#include "Tasks.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace TESSERACT::Agent::Archive {
+    namespace {
+        constexpr std::uint32_t kRecordMagic = 0x43455254;  // "TREC"
+        constexpr std::size_t kOpenViews = 4;                // Mapped segments kept around for paging
+
+        const std::filesystem::path kArchiveDirectory = "Data\\SKSE\\Plugins\\TESSERACT\\archive";
+        const std::filesystem::path kForgottenFile = kArchiveDirectory / "forgotten.bin";
+        const std::filesystem::path kCompactedFile = kArchiveDirectory / "compacted.bin";  // (source, target) pairs
+
+        constexpr std::array<std::string_view, 4> kRoles = {"user", "assistant", "summary", "system"};
+
+        struct RecordHeader {
+            std::uint32_t magic;
+            std::uint32_t formId;
+            std::uint32_t timestamp;
+            std::uint32_t length;
+            std::uint8_t stream;
+            std::uint8_t role;
+            std::uint16_t reserved;
+        };
+        static_assert(sizeof(RecordHeader) == 20);
+
+        struct Entry {
+            std::uint32_t segment;
+            std::uint32_t offset;
+            std::uint32_t timestamp;
+            std::uint32_t length;  // Whole record, header included
+        };
+
+        struct Segment {
+            std::uint64_t bytes = 0;
+            std::uint64_t deadBytes = 0;
+            std::shared_ptr<Utils::MappedFile> view;
+            std::uint64_t lastUse = 0;
+        };
+
+        struct PendingRecord {
+            RE::FormID formId;
+            Stream stream;
+            std::string role;
+            std::string content;
+            std::time_t timestamp;
+        };
+
+        struct State {
+            std::mutex mutex;
+            bool initialized = false;
+
+            std::unordered_map<RE::FormID, std::array<std::vector<Entry>, 2>> index;
+            std::unordered_map<RE::FormID, std::uint32_t> forgotten;  // Records up to this timestamp are dead
+            std::map<std::uint32_t, Segment> segments;
+            std::uint32_t activeSegment = 0;
+            std::uint32_t nextSegment = 1;
+            std::ofstream active;
+            bool activeUnflushed = false;
+            std::uint64_t useClock = 0;
+
+            bool compacting = false;  // A CompactSegment task is queued or running
+
+            // Appends waiting for the writer task, in order (see Append)
+            std::mutex pendingMutex;
+            std::vector<PendingRecord> pending;
+            bool writing = false;
+        };
+
+        State& GetState() {
+            static State state;
+            return state;
+        }
+
+        std::filesystem::path SegmentPath(std::uint32_t segment) {
+            return kArchiveDirectory / std::format("{:06}.seg", segment);
+        }
+
+        std::uint8_t RoleCode(std::string_view role) {
+            auto it = std::find(kRoles.begin(), kRoles.end(), role);
+            return it == kRoles.end() ? 3 : static_cast<std::uint8_t>(it - kRoles.begin());
+        }
+
+        // Everything below expects the state mutex to be held
+
+        void SaveForgotten(const State& state) {
+            std::ofstream out(kForgottenFile, std::ios::binary | std::ios::trunc);
+            for (const auto& [formId, timestamp] : state.forgotten) {
+                out.write(reinterpret_cast<const char*>(&formId), sizeof(formId));
+                out.write(reinterpret_cast<const char*>(&timestamp), sizeof(timestamp));
+            }
+        }
+
+        void LoadForgotten(State& state) {
+            std::ifstream in(kForgottenFile, std::ios::binary);
+            RE::FormID formId;
+            std::uint32_t timestamp;
+            while (in.read(reinterpret_cast<char*>(&formId), sizeof(formId)) &&
+                   in.read(reinterpret_cast<char*>(&timestamp), sizeof(timestamp))) {
+                state.forgotten[formId] = timestamp;
+            }
+        }
+
+        void OpenActive(State& state, std::uint32_t segment) {
+            state.active.close();
+            state.active.open(SegmentPath(segment), std::ios::binary | std::ios::app);
+            state.activeSegment = segment;
+            state.nextSegment = (std::max)(state.nextSegment, segment + 1);
+            state.segments[segment];
+        }
+
+        std::shared_ptr<Utils::MappedFile> View(State& state, std::uint32_t segmentId, std::uint64_t needed) {
+            auto it = state.segments.find(segmentId);
+            if (it == state.segments.end()) {
+                return nullptr;
+            }
+
+            if (segmentId == state.activeSegment && state.activeUnflushed) {
+                state.active.flush();
+                state.activeUnflushed = false;
+            }
+
+            auto& segment = it->second;
+            segment.lastUse = ++state.useClock;
+            if (segment.view && segment.view->Size() >= needed) {
+                return segment.view;
+            }
+
+            // (Re)map; the active segment grows, so its mapping goes stale
+            auto view = std::make_shared<Utils::MappedFile>();
+            if (!view->Open(SegmentPath(segmentId))) {
+                return nullptr;
+            }
+            segment.view = view;
+
+            // Keep only a few mappings open
+            std::size_t open = 0;
+            for (const auto& [id, other] : state.segments) {
+                if (other.view) open++;
+            }
+            while (open > kOpenViews) {
+                auto oldest = state.segments.end();
+                for (auto other = state.segments.begin(); other != state.segments.end(); ++other) {
+                    if (other->second.view && other->first != segmentId &&
+                        (oldest == state.segments.end() || other->second.lastUse < oldest->second.lastUse)) {
+                        oldest = other;
+                    }
+                }
+                if (oldest == state.segments.end()) break;
+                oldest->second.view.reset();
+                open--;
+            }
+            return view;
+        }
+
+        std::filesystem::path TempPath(std::uint32_t segment) {
+            return kArchiveDirectory / std::format("{:06}.seg.tmp", segment);
+        }
+
+        // Startup, before segments are listed. An entry is only written once its copy is complete,
+        // so its source is dead whatever happened after: a rename the crash cut off is finished
+        // here, and a source still on disk is deleted rather than indexed next to its copy
+        void ResolveCompactions(std::unordered_set<std::uint32_t>& superseded) {
+            std::vector<std::array<std::uint32_t, 2>> pairs;
+            {
+                std::ifstream in(kCompactedFile, std::ios::binary);
+                std::array<std::uint32_t, 2> pair;
+                while (in.read(reinterpret_cast<char*>(pair.data()), sizeof(pair))) {
+                    pairs.push_back(pair);
+                }
+            }
+
+            std::vector<std::array<std::uint32_t, 2>> pending;
+            std::error_code error;
+            for (const auto& [source, target] : pairs) {
+                if (std::filesystem::exists(TempPath(target), error)) {
+                    std::filesystem::rename(TempPath(target), SegmentPath(target), error);
+                }
+                superseded.insert(source);
+                if (std::filesystem::exists(SegmentPath(source), error) &&
+                    !std::filesystem::remove(SegmentPath(source), error)) {
+                    logger::warn("Archive segment {} was compacted but could not be deleted", source);
+                    pending.push_back({source, target});
+                }
+            }
+
+            // Only sources still on disk need remembering
+            std::ofstream out(kCompactedFile, std::ios::binary | std::ios::trunc);
+            for (const auto& pair : pending) {
+                out.write(reinterpret_cast<const char*>(pair.data()), sizeof(pair));
+            }
+        }
+
+        void CompactSegment(std::uint32_t segmentId);
+
+        void MaybeCompact(State& state) {
+            if (state.compacting) {
+                return;
+            }
+
+            for (const auto& [id, segment] : state.segments) {
+                if (id != state.activeSegment && segment.bytes > 0 && segment.deadBytes * 2 >= segment.bytes) {
+                    state.compacting = true;
+                    Tasks::Post(Tasks::Executor::Io, [id]() {
+                        CompactSegment(id);
+                        auto& state = GetState();
+                        std::lock_guard lock(state.mutex);
+                        state.compacting = false;
+                    });
+                    return;
+                }
+            }
+        }
+
+        // Copies a segment's live records into a fresh segment, then swaps the index over.
+        // The copy is written as .tmp, noted in compacted.bin and only then renamed, so after
+        // a crash at any point exactly one of source and copy gets indexed.
+        void CompactSegment(std::uint32_t segmentId) {
+            auto startTime = std::chrono::high_resolution_clock::now();
+            auto& state = GetState();
+
+            std::vector<std::uint32_t> liveOffsets;
+            std::shared_ptr<Utils::MappedFile> view;
+            std::uint32_t targetId;
+            {
+                std::lock_guard lock(state.mutex);
+                auto it = state.segments.find(segmentId);
+                if (it == state.segments.end()) return;
+
+                for (const auto& [formId, streams] : state.index) {
+                    for (const auto& entries : streams) {
+                        for (const auto& entry : entries) {
+                            if (entry.segment == segmentId) liveOffsets.push_back(entry.offset);
+                        }
+                    }
+                }
+                if (!liveOffsets.empty()) {
+                    view = View(state, segmentId, it->second.bytes);
+                    if (!view) return;
+                }
+                targetId = state.nextSegment++;
+            }
+
+            // Copy without holding the lock; only the index swap below needs it
+            std::sort(liveOffsets.begin(), liveOffsets.end());
+            std::unordered_map<std::uint32_t, std::uint32_t> moved;
+            std::uint64_t written = 0;
+            if (!liveOffsets.empty()) {
+                std::ofstream out(TempPath(targetId), std::ios::binary | std::ios::trunc);
+                auto bytes = view->Bytes();
+                for (auto offset : liveOffsets) {
+                    RecordHeader header;
+                    std::memcpy(&header, bytes.data() + offset, sizeof(header));
+                    std::uint64_t length = sizeof(header) + header.length;
+
+                    out.write(reinterpret_cast<const char*>(bytes.data() + offset), static_cast<std::streamsize>(length));
+                    moved[offset] = static_cast<std::uint32_t>(written);
+                    written += length;
+                }
+                out.close();
+                if (!out) {
+                    logger::error("Archive compaction of segment {} failed, keeping it", segmentId);
+                    std::error_code error;
+                    std::filesystem::remove(TempPath(targetId), error);
+                    return;
+                }
+
+                std::ofstream manifest(kCompactedFile, std::ios::binary | std::ios::app);
+                std::uint32_t pair[2] = {segmentId, targetId};
+                manifest.write(reinterpret_cast<const char*>(pair), sizeof(pair));
+                manifest.close();
+
+                std::error_code error;
+                if (!manifest) {
+                    logger::error("Archive compaction of segment {} could not be recorded, keeping it", segmentId);
+                    std::filesystem::remove(TempPath(targetId), error);
+                    return;
+                }
+                // Committed from here on; if the rename fails the next startup finishes it
+                std::filesystem::rename(TempPath(targetId), SegmentPath(targetId), error);
+                if (error) {
+                    logger::error("Archive compaction of segment {} is finished at the next start: {}", segmentId,
+                                  error.message());
+                    return;
+                }
+            }
+            view.reset();
+
+            {
+                std::lock_guard lock(state.mutex);
+                std::uint64_t live = 0;
+                for (auto& [formId, streams] : state.index) {
+                    for (auto& entries : streams) {
+                        for (auto& entry : entries) {
+                            if (entry.segment != segmentId) continue;
+                            entry.segment = targetId;
+                            entry.offset = moved[entry.offset];
+                            live += entry.length;
+                        }
+                    }
+                }
+
+                if (written > 0) {
+                    auto& target = state.segments[targetId];
+                    target.bytes = written;
+                    target.deadBytes = written - live;  // Forgotten while we were copying
+                }
+                state.segments.erase(segmentId);  // Drops our mapping, so the file can go
+            }
+
+            // If this fails the next startup skips it (see ResolveCompactions) and retries
+            std::error_code error;
+            if (!std::filesystem::remove(SegmentPath(segmentId), error) && error) {
+                logger::warn("Archive could not delete compacted segment {}: {}", segmentId, error.message());
+            }
+
+            auto endTime = std::chrono::high_resolution_clock::now();
+            auto duration = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
+            logger::info("Archive compacted segment {} into {} ({} live records) in {} microseconds",
+                segmentId, targetId, liveOffsets.size(), duration.count());
+        }
+    }
+
+    void Initialize() {
+        auto startTime = std::chrono::high_resolution_clock::now();
+        auto& state = GetState();
+        std::lock_guard lock(state.mutex);
+        if (state.initialized) {
+            return;
+        }
+
+        std::error_code error;
+        std::filesystem::create_directories(kArchiveDirectory, error);
+
+        LoadForgotten(state);
+
+        std::unordered_set<std::uint32_t> superseded;
+        ResolveCompactions(superseded);
+
+        std::vector<std::uint32_t> ids;
+        for (const auto& file : std::filesystem::directory_iterator(kArchiveDirectory, error)) {
+            if (file.path().extension() == ".tmp") {
+                std::filesystem::remove(file.path(), error);  // A compaction that never committed
+                continue;
+            }
+            if (file.path().extension() != ".seg") continue;
+            try {
+                auto id = static_cast<std::uint32_t>(std::stoul(file.path().stem().string()));
+                if (superseded.contains(id)) {
+                    state.nextSegment = (std::max)(state.nextSegment, id + 1);  // Never reuse its name
+                    continue;
+                }
+                ids.push_back(id);
+            } catch (const std::exception&) {
+                continue;
+            }
+        }
+        std::sort(ids.begin(), ids.end());
+
+        // Walk the record headers of every segment to rebuild the index
+        std::size_t records = 0;
+        for (auto id : ids) {
+            Utils::MappedFile view;
+            if (!view.Open(SegmentPath(id))) {
+                state.segments[id];
+                continue;
+            }
+
+            auto bytes = view.Bytes();
+            std::size_t offset = 0;
+            while (offset + sizeof(RecordHeader) <= bytes.size()) {
+                RecordHeader header;
+                std::memcpy(&header, bytes.data() + offset, sizeof(header));
+                if (header.magic != kRecordMagic || header.stream > 1 ||
+                    offset + sizeof(header) + header.length > bytes.size()) {
+                    break;
+                }
+
+                auto length = static_cast<std::uint32_t>(sizeof(header) + header.length);
+                auto forgotten = state.forgotten.find(header.formId);
+                if (forgotten != state.forgotten.end() && header.timestamp <= forgotten->second) {
+                    state.segments[id].deadBytes += length;
+                } else {
+                    state.index[header.formId][header.stream].push_back(
+                        {id, static_cast<std::uint32_t>(offset), header.timestamp, length});
+                    records++;
+                }
+                offset += length;
+            }
+
+            std::size_t fileSize = bytes.size();
+            view.Close();
+
+            // A torn write at the end (crash mid-append) is cut off
+            if (offset < fileSize) {
+                logger::warn("Archive segment {} has {} trailing bytes, truncating", id, fileSize - offset);
+                std::filesystem::resize_file(SegmentPath(id), offset, error);
+            }
+            state.segments[id].bytes = offset;
+        }
+
+        // Compaction output can land after a newer segment, so restore time order
+        for (auto& [formId, streams] : state.index) {
+            for (auto& entries : streams) {
+                std::stable_sort(entries.begin(), entries.end(),
+                    [](const Entry& a, const Entry& b) { return a.timestamp < b.timestamp; });
+            }
+        }
+
+        if (!ids.empty() && state.segments[ids.back()].bytes < kSegmentBytes) {
+            OpenActive(state, ids.back());
+        } else {
+            OpenActive(state, ids.empty() ? 1 : ids.back() + 1);
+        }
+        state.initialized = true;
+
+        auto endTime = std::chrono::high_resolution_clock::now();
+        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
+        logger::info("Archive indexed {} records in {} segments in {} microseconds", records, ids.size(), duration.count());
+    }
+
+    namespace {
+        void Write(State& state, const PendingRecord& record) {
+            std::lock_guard lock(state.mutex);
+            if (!state.initialized || !state.active) {
+                return;
+            }
+
+            RecordHeader header{};
+            header.magic = kRecordMagic;
+            header.formId = record.formId;
+            header.timestamp = static_cast<std::uint32_t>(record.timestamp);
+            header.length = static_cast<std::uint32_t>(record.content.size());
+            header.stream = static_cast<std::uint8_t>(record.stream);
+            header.role = RoleCode(record.role);
+
+            auto& segment = state.segments[state.activeSegment];
+            auto offset = static_cast<std::uint32_t>(segment.bytes);
+            auto length = static_cast<std::uint32_t>(sizeof(header) + record.content.size());
+
+            state.active.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            state.active.write(record.content.data(), static_cast<std::streamsize>(record.content.size()));
+            state.activeUnflushed = true;
+
+            segment.bytes += length;
+            state.index[record.formId][static_cast<std::size_t>(record.stream)].push_back({state.activeSegment, offset, header.timestamp, length});
+
+            // Seal full segments
+            if (segment.bytes >= kSegmentBytes) {
+                state.active.flush();
+                state.activeUnflushed = false;
+                OpenActive(state, state.nextSegment);
+            }
+        }
+
+        // Pool task: writes until the queue is empty; only one runs at a time, so records keep their order
+        void WritePending() {
+            auto& state = GetState();
+            std::vector<PendingRecord> batch;
+            while (true) {
+                {
+                    std::lock_guard lock(state.pendingMutex);
+                    if (state.pending.empty()) {
+                        state.writing = false;
+                        return;
+                    }
+                    batch.swap(state.pending);
+                }
+                for (const auto& record : batch) {
+                    Write(state, record);
+                }
+                batch.clear();
+            }
+        }
+    }
+
+    void Append(RE::FormID formId, Stream stream, std::string_view role, std::string_view content, std::time_t timestamp) {
+        // Callers may be on the game thread, so the file is written by a pool task
+        auto& state = GetState();
+        std::lock_guard lock(state.pendingMutex);
+        state.pending.push_back({formId, stream, std::string(role), std::string(content), timestamp});
+        if (!state.writing) {
+            state.writing = true;
+            Tasks::Post(Tasks::Executor::Io, WritePending);
+        }
+    }
+
+    std::size_t Count(RE::FormID formId, Stream stream) {
+        auto& state = GetState();
+        std::lock_guard lock(state.mutex);
+        auto it = state.index.find(formId);
+        return it == state.index.end() ? 0 : it->second[static_cast<std::size_t>(stream)].size();
+    }
+
+    std::vector<Turn> Read(RE::FormID formId, Stream stream, std::size_t first, std::size_t count) {
+        std::vector<Turn> result;
+        auto& state = GetState();
+        std::lock_guard lock(state.mutex);
+
+        auto it = state.index.find(formId);
+        if (it == state.index.end()) {
+            return result;
+        }
+
+        const auto& entries = it->second[static_cast<std::size_t>(stream)];
+        std::size_t last = (std::min)(entries.size(), first + count);
+        for (std::size_t i = first; i < last; i++) {
+            const auto& entry = entries[i];
+            auto view = View(state, entry.segment, static_cast<std::uint64_t>(entry.offset) + entry.length);
+            if (!view || view->Size() < static_cast<std::uint64_t>(entry.offset) + entry.length) {
+                continue;
+            }
+
+            RecordHeader header;
+            std::memcpy(&header, view->Bytes().data() + entry.offset, sizeof(header));
+            if (header.magic != kRecordMagic) {
+                continue;
+            }
+
+            auto text = reinterpret_cast<const char*>(view->Bytes().data() + entry.offset + sizeof(header));
+            result.push_back({
+                std::string(kRoles[(std::min)(static_cast<std::size_t>(header.role), kRoles.size() - 1)]),
+                std::string(text, header.length),
+                static_cast<std::time_t>(header.timestamp)
+            });
+        }
+        return result;
+    }
+
+    void Forget(RE::FormID formId) {
+        auto& state = GetState();
+        std::lock_guard lock(state.mutex);
+
+        auto it = state.index.find(formId);
+        if (it == state.index.end()) {
+            return;
+        }
+
+        // Remembered on disk so the records stay dead across restarts until compacted away
+        std::uint32_t newest = 0;
+        for (const auto& entries : it->second) {
+            for (const auto& entry : entries) {
+                state.segments[entry.segment].deadBytes += entry.length;
+                newest = (std::max)(newest, entry.timestamp);
+            }
+        }
+        state.index.erase(it);
+        state.forgotten[formId] = (std::max)(state.forgotten[formId], newest);
+        SaveForgotten(state);
+
+        MaybeCompact(state);
+    }
+
+    Stats GetStats() {
+        auto& state = GetState();
+        std::lock_guard lock(state.mutex);
+
+        Stats stats;
+        stats.segments = state.segments.size();
+        for (const auto& [formId, streams] : state.index) {
+            for (const auto& entries : streams) {
+                stats.records += entries.size();
+            }
+        }
+        for (const auto& [id, segment] : state.segments) {
+            stats.diskBytes += segment.bytes;
+            stats.deadBytes += segment.deadBytes;
+        }
+        return stats;
+    }
+}
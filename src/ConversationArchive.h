@@ -0,0 +1,75 @@
+#pragma once
+#include "RE/Skyrim.h"
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * Conversation Archive Overview
+ *
+ * The full transcript of every agent, kept on disk instead of in RAM or the
+ * co-save (agents themselves only keep a bounded, consolidated memory).
+ *
+ * 1. Segments:
+ *    - Append-only log files under Data\SKSE\Plugins\TESSERACT\archive
+ *    - Records are a fixed header (magic, FormID, timestamp, stream, role,
+ *      length) followed by the text; a segment is sealed at kSegmentBytes
+ *    - Append() only queues the record; one I/O pool task at a time writes the
+ *      queue in order, so callers (the game thread too) never touch the file
+ *
+ * 2. Index:
+ *    - Per FormID and stream, a 16 byte (segment, offset, timestamp, length) entry per
+ *      record; rebuilt at startup by walking record headers
+ *    - Text is only read for the page being displayed, through a memory
+ *      mapping of the segment
+ *
+ * 3. Compaction:
+ *    - Forget() drops index entries and records the NPC in forgotten.bin so
+ *      the records stay dead across restarts; sealed segments that are
+ *      mostly dead are rewritten by an I/O pool task
+ *    - The live records go to a .seg.tmp; the (source, target) pair is
+ *      appended to compacted.bin, then the tmp is renamed and the source
+ *      deleted. Initialize() replays compacted.bin, so a crash or a failed
+ *      delete never leaves a record in two segments
+ *
+ * Transcripts are global, not tied to a save game.
+ */
+
+namespace TESSERACT::Agent::Archive {
+    enum class Stream : std::uint8_t {
+        Dialogue = 0,  // Player and NPC turns
+        Summary = 1    // Consolidated memories
+    };
+
+    struct Turn {
+        std::string role;
+        std::string content;
+        std::time_t timestamp;
+    };
+
+    constexpr std::size_t kSegmentBytes = 8 * 1024 * 1024;
+
+    // Startup: scans the segments and builds the index
+    void Initialize();
+
+    // Any thread; the record shows up in Count/Read once the writer task got to it
+    void Append(RE::FormID formId, Stream stream, std::string_view role, std::string_view content, std::time_t timestamp);
+
+    // Paging, oldest first
+    std::size_t Count(RE::FormID formId, Stream stream);
+    std::vector<Turn> Read(RE::FormID formId, Stream stream, std::size_t first, std::size_t count);
+
+    // Drops an NPC's history; the space is reclaimed by compaction
+    void Forget(RE::FormID formId);
+
+    struct Stats {
+        std::size_t segments = 0;
+        std::size_t records = 0;
+        std::uint64_t diskBytes = 0;
+        std::uint64_t deadBytes = 0;
+    };
+    Stats GetStats();
+}
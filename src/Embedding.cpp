@@ -0,0 +1,313 @@
+#include "Embedding.h"
+#include "Agent.h"
+#include "Tasks.h"
+#include "VectorMath.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <condition_variable>
+#include <mutex>
+#include <unordered_map>
+
+namespace TESSERACT::Agent::Embedding {
+    namespace {
+        constexpr std::size_t kCacheCapacity = 8192;
+        constexpr std::size_t kParallelBatchSize = 256;
+
+        // Feature weights
+        constexpr float kWordWeight = 1.0f;
+        constexpr float kStopWordWeight = 0.25f;
+        constexpr float kBigramWeight = 0.5f;
+        constexpr float kTrigramWeight = 0.3f;
+
+        // Feature type seeds keep "ab" the word apart from "ab" the trigram
+        constexpr std::uint64_t kWordSeed = 0x9E3779B97F4A7C15ull;
+        constexpr std::uint64_t kBigramSeed = 0xC2B2AE3D27D4EB4Full;
+        constexpr std::uint64_t kTrigramSeed = 0x165667B19E3779F9ull;
+
+        constexpr std::array<std::string_view, 40> kStopWords = {
+            "a", "an", "and", "are", "as", "at", "be", "but", "by", "do",
+            "for", "from", "had", "has", "have", "he", "her", "his", "i", "if",
+            "in", "is", "it", "me", "my", "not", "of", "on", "or", "she",
+            "so", "that", "the", "to", "was", "we", "with", "you", "your", "what"
+        };
+
+        struct Cache {
+            std::mutex mutex;
+            std::unordered_map<std::uint64_t, std::vector<float>> entries;
+            std::deque<std::uint64_t> order;  // Insertion order for eviction
+        };
+
+        Cache& GetCache() {
+            static Cache cache;
+            return cache;
+        }
+
+        std::uint64_t Mix(std::uint64_t h) {
+            // splitmix64 finalizer
+            h ^= h >> 30;
+            h *= 0xBF58476D1CE4E5B9ull;
+            h ^= h >> 27;
+            h *= 0x94D049BB133111EBull;
+            h ^= h >> 31;
+            return h;
+        }
+
+        std::uint64_t HashBytes(std::string_view text, std::uint64_t seed) {
+            std::uint64_t h = 0xCBF29CE484222325ull ^ seed;
+            for (unsigned char c : text) {
+                h ^= c;
+                h *= 0x100000001B3ull;
+            }
+            return Mix(h);
+        }
+
+        void AddFeature(float* out, std::size_t dimensions, std::uint64_t h, float weight) {
+            // Two signed buckets per feature halves the damage done by collisions
+            out[h % dimensions] += (h >> 63) ? -weight : weight;
+            std::uint64_t h2 = Mix(h + 1);
+            out[h2 % dimensions] += (h2 >> 63) ? -0.5f * weight : 0.5f * weight;
+        }
+
+        bool IsWordByte(unsigned char c) {
+            return (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c >= 0x80;
+        }
+
+        bool IsStopWord(std::string_view word) {
+            return std::find(kStopWords.begin(), kStopWords.end(), word) != kStopWords.end();
+        }
+
+        std::uint64_t CacheKey(std::string_view text) {
+            return ContentHash(text) ^ Space();
+        }
+
+        bool CacheLookup(std::uint64_t key, std::vector<float>& out) {
+            auto& cache = GetCache();
+            std::lock_guard lock(cache.mutex);
+            auto it = cache.entries.find(key);
+            if (it == cache.entries.end()) return false;
+            out = it->second;
+            return true;
+        }
+
+        void CacheStore(std::uint64_t key, const std::vector<float>& embedding) {
+            auto& cache = GetCache();
+            std::lock_guard lock(cache.mutex);
+            if (!cache.entries.try_emplace(key, embedding).second) return;
+
+            cache.order.push_back(key);
+            while (cache.order.size() > kCacheCapacity) {
+                cache.entries.erase(cache.order.front());
+                cache.order.pop_front();
+            }
+        }
+
+        void EmbedRange(const std::vector<std::string>& texts, const std::vector<std::size_t>& indices,
+                        std::size_t begin, std::size_t end, std::vector<std::vector<float>>& out,
+                        std::size_t dimensions) {
+            for (std::size_t i = begin; i < end; i++) {
+                auto& embedding = out[indices[i]];
+                embedding.assign(dimensions, 0.0f);
+                EmbedLocal(texts[indices[i]], embedding.data(), dimensions);
+            }
+        }
+    }
+
+    std::uint64_t ContentHash(std::string_view text) {
+        return HashBytes(text, 0);
+    }
+
+    void EmbedLocal(std::string_view text, float* out, std::size_t dimensions) {
+        std::fill(out, out + dimensions, 0.0f);
+        if (dimensions == 0) return;
+
+        // Lowercase copy so words can be sliced out as views
+        std::string lowered(text);
+        for (auto& c : lowered) {
+            if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+        }
+
+        std::string_view previous;
+        std::size_t i = 0;
+        while (i < lowered.size()) {
+            while (i < lowered.size() && !IsWordByte(static_cast<unsigned char>(lowered[i]))) i++;
+            std::size_t start = i;
+            while (i < lowered.size() && IsWordByte(static_cast<unsigned char>(lowered[i]))) i++;
+            if (start == i) break;
+
+            std::string_view word(lowered.data() + start, i - start);
+            bool stopWord = IsStopWord(word);
+
+            // Whole word
+            AddFeature(out, dimensions, HashBytes(word, kWordSeed), stopWord ? kStopWordWeight : kWordWeight);
+
+            // Word bigram with the previous word
+            if (!previous.empty()) {
+                std::uint64_t h = HashBytes(previous, kBigramSeed);
+                h = HashBytes(word, h);
+                AddFeature(out, dimensions, h, kBigramWeight);
+            }
+            previous = word;
+
+            // Character trigrams with word boundary markers ("^na", "naz", ..., "em$")
+            if (!stopWord && word.size() >= 3) {
+                char gram[3];
+                for (std::size_t g = 0; g < word.size(); g++) {
+                    std::size_t pos = g;  // Position in "^word$"
+                    for (int k = 0; k < 3; k++, pos++) {
+                        gram[k] = pos == 0 ? '^' : (pos > word.size() ? '$' : word[pos - 1]);
+                    }
+                    AddFeature(out, dimensions, HashBytes(std::string_view(gram, 3), kTrigramSeed), kTrigramWeight);
+                }
+            }
+        }
+
+        VectorMath::Normalize(out, dimensions);
+    }
+
+    std::vector<float> Embed(std::string_view text) {
+        auto batch = EmbedBatch({std::string(text)});
+        return batch.empty() ? std::vector<float>{} : std::move(batch.front());
+    }
+
+    std::vector<std::vector<float>> EmbedBatch(const std::vector<std::string>& texts) {
+        std::vector<std::vector<float>> result(texts.size());
+        const auto dimensions = static_cast<std::size_t>((std::max)(Memory::embeddingDimensions, 1));
+
+        // Serve what we can from the cache
+        std::vector<std::uint64_t> keys(texts.size());
+        std::vector<std::size_t> misses;
+        for (std::size_t i = 0; i < texts.size(); i++) {
+            keys[i] = CacheKey(texts[i]);
+            if (!CacheLookup(keys[i], result[i])) {
+                misses.push_back(i);
+            }
+        }
+
+        if (misses.empty()) {
+            return result;
+        }
+
+        if (!Memory::useLocalEmbeddings) {
+            // Remote provider: one request for every miss
+            std::vector<std::string> pending;
+            pending.reserve(misses.size());
+            for (auto index : misses) {
+                pending.push_back(texts[index]);
+            }
+
+            auto embeddings = Communication::RequestEmbeddings(pending);
+            if (embeddings.size() != misses.size()) {
+                return {};
+            }
+            for (std::size_t i = 0; i < misses.size(); i++) {
+                result[misses[i]] = std::move(embeddings[i]);
+            }
+        } else if (misses.size() < kParallelBatchSize) {
+            EmbedRange(texts, misses, 0, misses.size(), result, dimensions);
+        } else {
+            // Large batches (e.g. restoring a long history) get split into chunks on the task pool
+            struct Chunks {
+                std::atomic<std::size_t> next{0};
+                std::size_t count = 0;
+                std::size_t finished = 0;
+                std::mutex mutex;
+                std::condition_variable done;
+            };
+            auto chunks = std::make_shared<Chunks>();
+            chunks->count = (misses.size() + kParallelBatchSize - 1) / kParallelBatchSize;
+
+            // Claims chunks until none are left; a helper that starts after the caller
+            // took the last one touches nothing, so it may outlive this call
+            auto work = [chunks, &texts, &misses, &result, dimensions]() {
+                std::size_t chunk;
+                while ((chunk = chunks->next.fetch_add(1)) < chunks->count) {
+                    std::size_t begin = chunk * kParallelBatchSize;
+                    EmbedRange(texts, misses, begin, (std::min)(begin + kParallelBatchSize, misses.size()), result, dimensions);
+
+                    std::lock_guard lock(chunks->mutex);
+                    if (++chunks->finished == chunks->count) {
+                        chunks->done.notify_all();
+                    }
+                }
+            };
+
+            auto helpers = (std::min)(chunks->count - 1, Tasks::kWorkerThreads);
+            for (std::size_t i = 0; i < helpers; i++) {
+                Tasks::Post(Tasks::Executor::Worker, work);
+            }
+            work();
+
+            // Only chunks a running helper already claimed are left to wait for
+            std::unique_lock lock(chunks->mutex);
+            chunks->done.wait(lock, [&] { return chunks->finished == chunks->count; });
+        }
+
+        for (auto index : misses) {
+            if (!result[index].empty()) {
+                CacheStore(keys[index], result[index]);
+            }
+        }
+
+        return result;
+    }
+
+    std::uint64_t Space() {
+        std::uint64_t space = Mix(static_cast<std::uint64_t>(Memory::embeddingDimensions) << 1 |
+                                  (Memory::useLocalEmbeddings ? 1u : 0u));
+        // The local model ignores the remote model name
+        return Memory::useLocalEmbeddings ? space : space ^ ContentHash(Memory::embeddingModel);
+    }
+
+    void ClearCache() {
+        auto& cache = GetCache();
+        std::lock_guard lock(cache.mutex);
+        cache.entries.clear();
+        cache.order.clear();
+    }
+
+    std::size_t CacheSize() {
+        auto& cache = GetCache();
+        std::lock_guard lock(cache.mutex);
+        return cache.entries.size();
+    }
+
+    BenchmarkResult Benchmark(std::size_t count) {
+        static constexpr std::array<std::string_view, 16> kWords = {
+            "dragon", "whiterun", "nazeem", "cloud", "district", "gold", "sword", "jarl",
+            "guard", "arrow", "knee", "adventurer", "skooma", "stormcloak", "imperial", "mead"
+        };
+
+        // Synthetic dialogue lines, generated up front so only embedding is timed
+        std::vector<std::string> lines(count);
+        std::uint32_t state = 12345;
+        for (auto& line : lines) {
+            for (int w = 0; w < 12; w++) {
+                state = state * 1664525u + 1013904223u;
+                line += kWords[(state >> 16) % kWords.size()];
+                line += ' ';
+            }
+        }
+
+        const auto dimensions = static_cast<std::size_t>((std::max)(Memory::embeddingDimensions, 1));
+        std::vector<float> embedding(dimensions);
+
+        auto startTime = std::chrono::high_resolution_clock::now();
+        for (const auto& line : lines) {
+            EmbedLocal(line, embedding.data(), dimensions);
+        }
+        auto endTime = std::chrono::high_resolution_clock::now();
+
+        BenchmarkResult result;
+        result.count = count;
+        result.seconds = std::chrono::duration<double>(endTime - startTime).count();
+        result.embeddingsPerSecond = result.seconds > 0.0 ? count / result.seconds : 0.0;
+
+        logger::info("Embedding benchmark: {} embeddings ({} dims) in {:.3f} ms, {:.0f} embeddings/s/core",
+            count, dimensions, result.seconds * 1000.0, result.embeddingsPerSecond);
+        return result;
+    }
+}
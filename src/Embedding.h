@@ -0,0 +1,62 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * Local Embedding Engine Overview
+ *
+ * Memory retrieval needs an embedding for every memory and every query. Asking
+ * the remote provider costs a round trip per insert, so by default we embed
+ * in-process on the CPU instead:
+ *
+ * 1. Model:
+ *    - Signed feature hashing of word unigrams, word bigrams and character
+ *      trigrams into Memory::embeddingDimensions buckets, then L2 normalized
+ *    - Character trigrams make it robust to inflections and typos, bigrams keep
+ *      some word order ("owes me" vs "me owes")
+ *    - Deterministic and weight-free, so nothing extra ships with the plugin
+ *
+ * 2. Batching and caching:
+ *    - EmbedBatch splits large local batches into chunks on the task pool
+ *      (Tasks.h); the caller works through chunks too, so it never waits on
+ *      a queue it is part of
+ *    - Results are cached by a 64-bit content hash, so re-embedding the same
+ *      line (greetings, repeated questions, restored memories) is a lookup
+ *
+ * 3. Providers:
+ *    - Memory::useLocalEmbeddings = false routes batches to the remote
+ *      embeddings endpoint (Communication::RequestEmbeddings) instead
+ *    - Vectors from different providers, models or dimensions are not
+ *      comparable; Space() identifies the current one, and agents re-embed
+ *      their memories when it changes (see SubAgent::IndexPendingMemories)
+ */
+
+namespace TESSERACT::Agent::Embedding {
+    // Embedding entry points (dispatch to the configured provider)
+    std::vector<float> Embed(std::string_view text);
+    std::vector<std::vector<float>> EmbedBatch(const std::vector<std::string>& texts);
+
+    // Identifies the embedding space the current settings produce
+    std::uint64_t Space();
+
+    // Local model, uncached
+    void EmbedLocal(std::string_view text, float* out, std::size_t dimensions);
+
+    // Content hash used as the cache key (also handy for other content lookups)
+    std::uint64_t ContentHash(std::string_view text);
+
+    // Cache management
+    void ClearCache();
+    std::size_t CacheSize();
+
+    // Throughput check, logged and returned for the settings panel
+    struct BenchmarkResult {
+        std::size_t count = 0;
+        double seconds = 0.0;
+        double embeddingsPerSecond = 0.0;  // Single core, cache bypassed
+    };
+    BenchmarkResult Benchmark(std::size_t count = 10000);
+}
@@ -0,0 +1,275 @@
+#include "FactStore.h"
+#include "LexicalIndex.h"
+#include <algorithm>
+#include <array>
+#include <cctype>
+
+namespace TESSERACT::Agent::Memory {
+    namespace {
+        // Words too common to say anything about which facts matter
+        constexpr std::array<std::string_view, 24> kStopWords = {
+            "a", "an", "and", "are", "at", "be", "do", "for", "have", "i", "in", "is",
+            "it", "me", "my", "of", "on", "so", "that", "the", "to", "was", "what", "with"
+        };
+
+        bool IsStopWord(std::string_view word) {
+            return word.size() < 2 || std::find(kStopWords.begin(), kStopWords.end(), word) != kStopWords.end();
+        }
+
+        void Append(std::unordered_map<FactStore::TermId, std::vector<FactStore::FactId>>& index,
+                    FactStore::TermId term, FactStore::FactId id) {
+            index[term].push_back(id);
+        }
+    }
+
+    std::string FactStore::Normalize(std::string_view text) {
+        std::string result;
+        result.reserve(text.size());
+        bool space = false;
+        for (unsigned char c : text) {
+            if (std::isspace(c)) {
+                space = !result.empty();
+                continue;
+            }
+            if (space) result += ' ';
+            result += static_cast<char>(std::tolower(c));
+            space = false;
+        }
+        return result;
+    }
+
+    FactStore::TermId FactStore::Find(std::string_view normalized) const {
+        auto it = termIds.find(std::string(normalized));
+        return it == termIds.end() ? 0 : it->second;
+    }
+
+    FactStore::TermId FactStore::Intern(std::string_view normalized) {
+        if (auto existing = Find(normalized)) {
+            return existing;
+        }
+
+        auto id = static_cast<TermId>(terms.size());
+        terms.emplace_back(normalized);
+        termIds.emplace(terms.back(), id);
+
+        std::vector<std::string> words;
+        LexicalIndex::Tokenize(normalized, words);
+        std::sort(words.begin(), words.end());
+        words.erase(std::unique(words.begin(), words.end()), words.end());
+        for (const auto& word : words) {
+            if (!IsStopWord(word)) termsByWord[word].push_back(id);
+        }
+        return id;
+    }
+
+    bool FactStore::Assert(std::string_view subject, std::string_view predicate, std::string_view object,
+                           std::time_t timestamp, bool replace) {
+        auto s = Normalize(subject);
+        auto p = Normalize(predicate);
+        auto o = Normalize(object);
+        if (s.empty() || p.empty() || o.empty()) {
+            return false;
+        }
+
+        TermId subjectId = Intern(s);
+        TermId predicateId = Intern(p);
+        TermId objectId = Intern(o);
+
+        bool known = false;
+        if (auto it = bySubject.find(subjectId); it != bySubject.end()) {
+            for (auto id : std::vector<FactId>(it->second)) {
+                auto& fact = facts[id];
+                if (fact.subject != subjectId || fact.predicate != predicateId) continue;
+                if (fact.object == objectId) {
+                    fact.timestamp = (std::max)(fact.timestamp, timestamp);
+                    known = true;
+                } else if (replace) {
+                    Remove(id);
+                }
+            }
+        }
+        if (known) {
+            return false;
+        }
+        if (CompactIfSparse()) {
+            subjectId = Intern(s);
+            predicateId = Intern(p);
+            objectId = Intern(o);
+        }
+
+        auto id = static_cast<FactId>(facts.size());
+        facts.push_back({subjectId, predicateId, objectId, timestamp});
+        Append(bySubject, subjectId, id);
+        Append(byPredicate, predicateId, id);
+        Append(byObject, objectId, id);
+        return true;
+    }
+
+    bool FactStore::Retract(std::string_view subject, std::string_view predicate, std::string_view object) {
+        TermId subjectId = Find(Normalize(subject));
+        TermId predicateId = Find(Normalize(predicate));
+        TermId objectId = Find(Normalize(object));
+        auto it = bySubject.find(subjectId);
+        if (subjectId == 0 || predicateId == 0 || objectId == 0 || it == bySubject.end()) {
+            return false;
+        }
+
+        for (auto id : it->second) {
+            const auto& fact = facts[id];
+            if (fact.subject == subjectId && fact.predicate == predicateId && fact.object == objectId) {
+                Remove(id);
+                CompactIfSparse();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void FactStore::Remove(FactId id) {
+        if (facts[id].subject == 0) return;
+        facts[id].subject = 0;
+        removed++;
+    }
+
+    bool FactStore::CompactIfSparse() {
+        // Index lists skip removed facts until enough of them pile up
+        if (removed <= 32 || removed * 2 <= facts.size()) {
+            return false;
+        }
+        RebuildIndexes();
+        return true;
+    }
+
+    void FactStore::EvictOldest(std::size_t keep) {
+        if (Size() <= keep) {
+            return;
+        }
+
+        std::vector<FactId> live;
+        for (FactId id = 0; id < facts.size(); id++) {
+            if (facts[id].subject != 0) live.push_back(id);
+        }
+        size_t drop = live.size() - keep;
+        std::nth_element(live.begin(), live.begin() + drop, live.end(),
+            [this](FactId a, FactId b) { return facts[a].timestamp < facts[b].timestamp; });
+        for (size_t i = 0; i < drop; i++) {
+            facts[live[i]].subject = 0;
+            removed++;
+        }
+        RebuildIndexes();
+    }
+
+    void FactStore::RebuildIndexes() {
+        // Re-intern live facts so both the fact ids and the term table stay compact
+        std::vector<Triple> live;
+        std::vector<std::time_t> timestamps;
+        for (const auto& fact : facts) {
+            if (fact.subject == 0) continue;
+            live.push_back({terms[fact.subject], terms[fact.predicate], terms[fact.object]});
+            timestamps.push_back(fact.timestamp);
+        }
+
+        Clear();
+        for (size_t i = 0; i < live.size(); i++) {
+            auto id = static_cast<FactId>(facts.size());
+            Fact fact{Intern(live[i].subject), Intern(live[i].predicate), Intern(live[i].object), timestamps[i]};
+            facts.push_back(fact);
+            Append(bySubject, fact.subject, id);
+            Append(byPredicate, fact.predicate, id);
+            Append(byObject, fact.object, id);
+        }
+    }
+
+    void FactStore::Clear() {
+        terms.assign(1, "");
+        termIds.clear();
+        termsByWord.clear();
+        facts.clear();
+        removed = 0;
+        bySubject.clear();
+        byPredicate.clear();
+        byObject.clear();
+    }
+
+    std::vector<FactStore::FactId> FactStore::BySubject(std::string_view subject) const {
+        std::vector<FactId> result;
+        auto it = bySubject.find(Find(Normalize(subject)));
+        if (it != bySubject.end()) {
+            for (auto id : it->second) {
+                if (facts[id].subject != 0) result.push_back(id);
+            }
+        }
+        return result;
+    }
+
+    std::vector<FactStore::FactId> FactStore::ByPredicate(std::string_view predicate) const {
+        std::vector<FactId> result;
+        auto it = byPredicate.find(Find(Normalize(predicate)));
+        if (it != byPredicate.end()) {
+            for (auto id : it->second) {
+                if (facts[id].subject != 0) result.push_back(id);
+            }
+        }
+        return result;
+    }
+
+    std::vector<FactStore::FactId> FactStore::Relevant(std::string_view input, std::size_t limit,
+                                                       std::string_view fallbackSubject) const {
+        if (limit == 0 || Size() == 0) {
+            return {};
+        }
+
+        // Terms mentioned by the input
+        std::vector<std::string> words;
+        LexicalIndex::Tokenize(input, words);
+        std::unordered_map<TermId, int> mentioned;
+        for (const auto& word : words) {
+            if (IsStopWord(word)) continue;
+            if (auto it = termsByWord.find(word); it != termsByWord.end()) {
+                for (auto term : it->second) mentioned[term]++;
+            }
+        }
+
+        // A subject match says the most about relevance, then the object, then the predicate
+        std::unordered_map<FactId, int> scores;
+        auto collect = [&](const std::unordered_map<TermId, std::vector<FactId>>& index, TermId term, int weight) {
+            if (auto it = index.find(term); it != index.end()) {
+                for (auto id : it->second) {
+                    if (facts[id].subject != 0) scores[id] += weight;
+                }
+            }
+        };
+        for (const auto& [term, count] : mentioned) {
+            collect(bySubject, term, 3 * count);
+            collect(byObject, term, 2 * count);
+            collect(byPredicate, term, count);
+        }
+
+        std::vector<FactId> result;
+        result.reserve(scores.size());
+        for (const auto& [id, score] : scores) result.push_back(id);
+        auto better = [&](FactId a, FactId b) {
+            if (scores[a] != scores[b]) return scores[a] > scores[b];
+            return facts[a].timestamp > facts[b].timestamp;
+        };
+        std::sort(result.begin(), result.end(), better);
+        if (result.size() > limit) result.resize(limit);
+
+        // The speaker is always part of the conversation, so their newest facts fill the rest
+        if (result.size() < limit && !fallbackSubject.empty()) {
+            auto fallback = BySubject(fallbackSubject);
+            std::sort(fallback.begin(), fallback.end(),
+                [this](FactId a, FactId b) { return facts[a].timestamp > facts[b].timestamp; });
+            for (auto id : fallback) {
+                if (result.size() >= limit) break;
+                if (!scores.contains(id)) result.push_back(id);
+            }
+        }
+        return result;
+    }
+
+    std::string FactStore::Format(FactId id) const {
+        const auto& fact = facts[id];
+        return terms[fact.subject] + " " + terms[fact.predicate] + " " + terms[fact.object];
+    }
+}
@@ -0,0 +1,102 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Fact Store Overview
+ *
+ * Free-text memories make the model re-read transcripts to recall simple facts.
+ * Each agent also keeps a small set of subject-predicate-object triples
+ * ("player | owes | 100 gold", "you | brother of | hadvar") extracted from its
+ * dialogue, and PrepareContext injects only the ones relevant to the input.
+ *
+ * 1. Terms:
+ *    - Subjects, predicates and objects are normalized (lowercase, single spaces)
+ *      and interned; a fact is three term ids and a timestamp
+ *
+ * 2. Indexes:
+ *    - Fact lists per subject, predicate and object term
+ *    - Word -> terms map, so words of the input find the terms that contain them
+ *
+ * 3. Updates:
+ *    - Assert() skips exact duplicates; with replace it first retracts other
+ *      objects of the same subject and predicate ("owes" 100 gold -> 50 gold)
+ *    - Removed facts are tombstoned and the indexes rebuilt once they pile up
+ *
+ * Not synchronized; the owning agent guards it with its memory lock.
+ */
+
+namespace TESSERACT::Agent::Memory {
+    class FactStore {
+    public:
+        using TermId = std::uint32_t;
+        using FactId = std::uint32_t;
+
+        struct Fact {
+            TermId subject = 0;  // 0 = removed
+            TermId predicate = 0;
+            TermId object = 0;
+            std::time_t timestamp = 0;
+        };
+
+        // Extraction output before interning
+        struct Triple {
+            std::string subject;
+            std::string predicate;
+            std::string object;
+            bool replace = false;
+        };
+
+        // Returns false if the fact was already known (or empty)
+        bool Assert(std::string_view subject, std::string_view predicate, std::string_view object,
+                    std::time_t timestamp, bool replace = false);
+        bool Retract(std::string_view subject, std::string_view predicate, std::string_view object);
+        void EvictOldest(std::size_t keep);
+        void Clear();
+
+        // Lookups return live fact ids
+        std::vector<FactId> BySubject(std::string_view subject) const;
+        std::vector<FactId> ByPredicate(std::string_view predicate) const;
+
+        // Facts whose terms share words with the input, best first; tops up with
+        // the newest facts about fallbackSubject when fewer than limit match
+        std::vector<FactId> Relevant(std::string_view input, std::size_t limit,
+                                     std::string_view fallbackSubject = "player") const;
+
+        const Fact& Get(FactId id) const { return facts[id]; }
+        const std::string& Term(TermId id) const { return terms[id]; }
+        std::string Format(FactId id) const;  // "subject predicate object"
+
+        std::size_t Size() const { return facts.size() - removed; }
+        template <class Fn>
+        void ForEach(Fn&& fn) const {
+            for (FactId id = 0; id < facts.size(); id++) {
+                if (facts[id].subject != 0) fn(facts[id]);
+            }
+        }
+
+        static std::string Normalize(std::string_view text);
+
+    private:
+        TermId Intern(std::string_view normalized);
+        TermId Find(std::string_view normalized) const;
+        void Remove(FactId id);  // Tombstones only; ids stay valid
+        bool CompactIfSparse();  // Renumbers facts and terms when it rebuilds
+        void RebuildIndexes();
+
+        std::vector<std::string> terms{""};  // Term 0 is reserved
+        std::unordered_map<std::string, TermId> termIds;
+        std::unordered_map<std::string, std::vector<TermId>> termsByWord;
+
+        std::vector<Fact> facts;
+        std::size_t removed = 0;
+        std::unordered_map<TermId, std::vector<FactId>> bySubject;
+        std::unordered_map<TermId, std::vector<FactId>> byPredicate;
+        std::unordered_map<TermId, std::vector<FactId>> byObject;
+    };
+}
@@ -0,0 +1,101 @@
+#include "Fingerprint.h"
+#include "Embedding.h"
+#include "LexicalIndex.h"
+#include <algorithm>
+#include <bit>
+#include <string>
+
+namespace TESSERACT::Agent::Memory {
+    namespace {
+        std::uint64_t Mix(std::uint64_t x) {
+            // splitmix64 finalizer: feature hashes need well spread bits
+            x ^= x >> 30;
+            x *= 0xBF58476D1CE4E5B9ull;
+            x ^= x >> 27;
+            x *= 0x94D049BB133111EBull;
+            x ^= x >> 31;
+            return x;
+        }
+    }
+
+    std::uint64_t SimHash(std::string_view role, std::string_view text) {
+        thread_local std::vector<std::string> words;
+        words.clear();
+        LexicalIndex::Tokenize(text, words);
+        if (words.empty()) {
+            return 0;
+        }
+
+        const auto seed = Embedding::ContentHash(role);
+        std::array<int, 64> weights{};
+        auto addFeature = [&](std::uint64_t hash) {
+            hash = Mix(hash ^ seed);
+            for (int bit = 0; bit < 64; bit++) {
+                weights[bit] += (hash >> bit) & 1 ? 1 : -1;
+            }
+        };
+
+        std::uint64_t previous = 0;
+        for (size_t i = 0; i < words.size(); i++) {
+            auto hash = Embedding::ContentHash(words[i]);
+            addFeature(hash);
+            if (i > 0) addFeature(previous * 31 + hash);
+            previous = hash;
+        }
+
+        std::uint64_t fingerprint = 0;
+        for (int bit = 0; bit < 64; bit++) {
+            if (weights[bit] > 0) fingerprint |= std::uint64_t{1} << bit;
+        }
+        return fingerprint ? fingerprint : 1;  // 0 is reserved for "no words"
+    }
+
+    void FingerprintIndex::Add(std::uint32_t id, std::uint64_t fingerprint) {
+        if (!fingerprint || !byId.emplace(id, fingerprint).second) {
+            return;
+        }
+        for (size_t band = 0; band < kBands; band++) {
+            bands[band][Band(fingerprint, band)].push_back(id);
+        }
+    }
+
+    void FingerprintIndex::Remove(std::uint32_t id) {
+        auto it = byId.find(id);
+        if (it == byId.end()) {
+            return;
+        }
+        for (size_t band = 0; band < kBands; band++) {
+            auto bucket = bands[band].find(Band(it->second, band));
+            if (bucket == bands[band].end()) continue;
+            std::erase(bucket->second, id);
+            if (bucket->second.empty()) bands[band].erase(bucket);
+        }
+        byId.erase(it);
+    }
+
+    void FingerprintIndex::Clear() {
+        byId.clear();
+        for (auto& band : bands) band.clear();
+    }
+
+    std::uint32_t FingerprintIndex::FindNear(std::uint64_t fingerprint, int maxDistance) const {
+        if (!fingerprint) {
+            return 0;
+        }
+
+        std::uint32_t best = 0;
+        int bestDistance = maxDistance + 1;
+        for (size_t band = 0; band < kBands; band++) {
+            auto bucket = bands[band].find(Band(fingerprint, band));
+            if (bucket == bands[band].end()) continue;
+            for (auto id : bucket->second) {
+                int distance = std::popcount(byId.at(id) ^ fingerprint);
+                if (distance < bestDistance || (distance == bestDistance && id > best)) {
+                    best = id;
+                    bestDistance = distance;
+                }
+            }
+        }
+        return best;
+    }
+}
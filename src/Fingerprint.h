@@ -0,0 +1,57 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Near-Duplicate Memory Overview
+ *
+ * Conversations with NPCs repeat themselves ("what do you sell?", greetings),
+ * so a new line that is nearly identical to one the agent already remembers
+ * replaces it and bumps a repetition count instead of being stored again.
+ * Copies still inside the recent history the NPC sees verbatim are left alone.
+ *
+ * 1. Fingerprints:
+ *    - 64-bit SimHash over lowercased words and word pairs; case, punctuation
+ *      and spacing don't matter, a changed word usually flips many bits
+ *    - The role is folded into every feature, so the player and the NPC saying
+ *      the same thing never match
+ *
+ * 2. Lookup:
+ *    - Four 16-bit bands; two fingerprints within kNearDistance bits share at
+ *      least one band exactly, so only the band buckets are compared
+ *
+ * The index is not synchronized; the owning agent guards it with its memory lock.
+ */
+
+namespace TESSERACT::Agent::Memory {
+    constexpr int kNearDistance = 3;  // Hamming bits
+
+    // 0 when the text has no words (never matches anything)
+    std::uint64_t SimHash(std::string_view role, std::string_view text);
+
+    class FingerprintIndex {
+    public:
+        void Add(std::uint32_t id, std::uint64_t fingerprint);
+        void Remove(std::uint32_t id);
+        void Clear();
+
+        // Closest fingerprint within maxDistance bits (newest on ties), 0 if none
+        std::uint32_t FindNear(std::uint64_t fingerprint, int maxDistance = kNearDistance) const;
+
+        std::size_t Size() const { return byId.size(); }
+
+    private:
+        static constexpr std::size_t kBands = 4;
+
+        static std::uint16_t Band(std::uint64_t fingerprint, std::size_t band) {
+            return static_cast<std::uint16_t>(fingerprint >> (band * 16));
+        }
+
+        std::unordered_map<std::uint32_t, std::uint64_t> byId;
+        std::array<std::unordered_map<std::uint16_t, std::vector<std::uint32_t>>, kBands> bands;
+    };
+}
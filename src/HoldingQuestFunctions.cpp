@@ -1,4 +1,5 @@
 #include "HoldingQuestFunctions.h"
+#include "AgentManager.h"
 #include "UI.h"
 #include "Utils.h"
 
@@ -213,6 +214,17 @@ namespace TESSERACT::HoldingQuest {
             }
         }
 
+        // Keep one agent per held NPC; NPCs that left lose theirs unless a chat has them
+        std::vector<RE::Actor*> heldActors;
+        for (auto* ref : holdingContents) {
+            if (placeholderSet.find(ref) == placeholderSet.end()) {
+                if (auto actor = ref->As<RE::Actor>()) {
+                    heldActors.push_back(actor);
+                }
+            }
+        }
+        Agent::Manager::SyncHolding(heldActors);
+
         auto endTime = std::chrono::high_resolution_clock::now();
         auto duration = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
         logger::info("FastQuestFill execution time: {} microseconds", duration.count());
@@ -0,0 +1,29 @@
+#include "Hooks.h"
+#include "ActionExecutor.h"
+#include "ActorSnapshot.h"
+#include "SceneConversation.h"
+#include "Scheduler.h"
+#include "WorldContext.h"
+
+namespace TESSERACT::Hooks {
+    namespace {
+        struct MainUpdate {
+            static void thunk(RE::Main* a_this, float a_delta) {
+                func(a_this, a_delta);
+                Agent::WorldContext::Sample();
+                Agent::Snapshots::Capture();
+                Agent::Scheduler::Tick();
+                Agent::Actions::Execute();
+                Agent::Scenes::Tick();
+            }
+            static inline REL::Relocation<decltype(thunk)> func;
+        };
+    }
+
+    void Install() {
+        REL::Relocation<std::uintptr_t> target{RELOCATION_ID(35565, 36564), REL::Relocate(0x748, 0xC26)};
+        auto& trampoline = SKSE::GetTrampoline();
+        MainUpdate::func = trampoline.write_call<5>(target.address(), MainUpdate::thunk);
+        logger::info("Installed main update hook");
+    }
+}
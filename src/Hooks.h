@@ -0,0 +1,22 @@
+#pragma once
+#include "RE/Skyrim.h"
+
+/**
+ * Hooks Overview
+ *
+ * Engine hooks for work that has to happen on the game thread every frame.
+ *
+ * 1. Main update:
+ *    - Wraps the call Main::Update makes once per frame and runs our work
+ *      after the game's own
+ *    - Samples the shared world context (see WorldContext.h)
+ *    - Copies the state of every agent's actor (see ActorSnapshot.h)
+ *    - Ticks the agents within a frame budget (see Scheduler.h)
+ *    - Applies the actions agents queued (see ActionExecutor.h)
+ *    - Plays NPC to NPC conversations (see SceneConversation.h)
+ */
+
+namespace TESSERACT::Hooks {
+    // SKSEPluginLoad: needs the trampoline allocated
+    void Install();
+}
@@ -0,0 +1,73 @@
+#include "Inbox.h"
+#include "Agent.h"
+#include "MpscQueue.h"
+#include <atomic>
+#include <deque>
+#include <thread>
+
+namespace TESSERACT::Agent::Inbox {
+    namespace {
+        MpscQueue<Result, kCapacity>& Results() {
+            static MpscQueue<Result, kCapacity> queue;
+            return queue;
+        }
+
+        // Results whose agent was busy with the UI, and results the game thread posted itself
+        // when the queue was full; retried first on the next drain (game thread only)
+        std::deque<Result>& Deferred() {
+            static std::deque<Result> deferred;
+            return deferred;
+        }
+
+        // Whoever drains; it must never wait for room it is the only one to make
+        std::atomic<std::thread::id> consumer;
+
+        MpscQueue<ChatLine, kCapacity>& ChatLines() {
+            static MpscQueue<ChatLine, kCapacity> queue;
+            return queue;
+        }
+    }
+
+    void Post(Result result) {
+        if (std::this_thread::get_id() == consumer.load(std::memory_order_relaxed)) {
+            if (!Results().TryPush(std::move(result))) {
+                Deferred().push_back(std::move(result));
+            }
+            return;
+        }
+        Results().Push(std::move(result));
+    }
+
+    std::size_t Drain(std::size_t max) {
+        consumer.store(std::this_thread::get_id(), std::memory_order_relaxed);
+        auto& deferred = Deferred();
+        auto handle = [&](Result result) {
+            // Retired meanwhile (left the holding quest, or a load): nobody to tell
+            if (auto agent = result.agent.lock()) {
+                if (!agent->Deliver(result.kind, result.text)) {
+                    deferred.push_back(std::move(result));
+                }
+            }
+        };
+
+        // Each deferred result is tried once per drain, before anything newer
+        std::size_t count = 0;
+        for (auto retries = deferred.size(); retries > 0 && count < max; retries--, count++) {
+            auto result = std::move(deferred.front());
+            deferred.pop_front();
+            handle(std::move(result));
+        }
+        return count + Results().Drain(handle, max - count);
+    }
+
+    void PostChatLine(RE::FormID formId, std::string text) {
+        // Nobody may be reading (chat closed); drop rather than stall the game thread
+        if (!ChatLines().TryPush({formId, std::move(text)})) {
+            logger::warn("Chat line queue is full, dropped a line from {:08X}", formId);
+        }
+    }
+
+    bool TakeChatLine(ChatLine& out) {
+        return ChatLines().TryPop(out);
+    }
+}
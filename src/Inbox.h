@@ -0,0 +1,67 @@
+#pragma once
+#include "RE/Skyrim.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+/**
+ * Inbox Overview
+ *
+ * Results travel from worker threads to the game thread, and replies from
+ * there to the chat window, through bounded lock-free queues (MpscQueue.h)
+ * instead of futures and strings polled per agent.
+ *
+ * 1. Game thread inbox:
+ *    - Workers Post() completed work for an agent
+ *    - The scheduler drains up to kDrainBatch results per frame (see
+ *      Scheduler.h) and hands each to its agent, if it still exists
+ *    - An agent busy with the UI (ProcessInput) or whose memories a worker
+ *      holds is not waited for; its result is kept aside and retried first
+ *      on the next frame
+ *    - The game thread posts too (action outcomes); as the only consumer it
+ *      cannot wait for room, so when the queue is full its result is kept
+ *      aside the same way
+ *
+ * 2. Chat lines:
+ *    - Delivered replies are queued once more for the UI, which takes the
+ *      lines of the NPC it is showing
+ */
+
+namespace TESSERACT::Agent {
+    class SubAgent;
+}
+
+namespace TESSERACT::Agent::Inbox {
+    constexpr std::size_t kCapacity = 1024;
+    constexpr std::size_t kDrainBatch = 32;
+
+    enum class Kind : std::uint8_t {
+        Response,  // Finished dialogue reply
+        Action     // Outcome of an action, as the NPC would remember it (see ActionExecutor.h)
+    };
+
+    struct Result {
+        Kind kind = Kind::Response;
+        std::weak_ptr<SubAgent> agent;
+        std::string text;
+    };
+
+    // Any thread; waits (yielding) only if kCapacity results are already queued,
+    // except on the game thread, which keeps the result aside for its next drain
+    void Post(Result result);
+
+    // Game thread, once per frame; returns how many results were handled
+    std::size_t Drain(std::size_t max = kDrainBatch);
+
+    struct ChatLine {
+        RE::FormID formId = 0;
+        std::string text;
+    };
+
+    // Game thread: a line for the chat window
+    void PostChatLine(RE::FormID formId, std::string text);
+
+    // UI thread only
+    bool TakeChatLine(ChatLine& out);
+}
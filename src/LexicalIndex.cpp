@@ -0,0 +1,279 @@
+#include "LexicalIndex.h"
+#include <algorithm>
+#include <cmath>
+
+namespace TESSERACT::Agent::Memory {
+    namespace {
+        constexpr float kK1 = 1.2f;
+        constexpr float kB = 0.75f;
+
+        // Compact once tombstones are both numerous and a real share of the index
+        constexpr std::size_t kCompactMinTombstones = 256;
+
+        void WriteVarint(std::vector<std::uint8_t>& out, std::uint32_t value) {
+            while (value >= 0x80) {
+                out.push_back(static_cast<std::uint8_t>(value | 0x80));
+                value >>= 7;
+            }
+            out.push_back(static_cast<std::uint8_t>(value));
+        }
+
+        std::uint32_t ReadVarint(const std::uint8_t*& p) {
+            std::uint32_t value = 0;
+            int shift = 0;
+            while (*p & 0x80) {
+                value |= static_cast<std::uint32_t>(*p++ & 0x7F) << shift;
+                shift += 7;
+            }
+            value |= static_cast<std::uint32_t>(*p++) << shift;
+            return value;
+        }
+
+        // Sorted unique terms with their counts
+        void CountTerms(std::vector<std::string>& tokens, std::vector<std::pair<std::string, std::uint32_t>>& out) {
+            std::sort(tokens.begin(), tokens.end());
+            for (auto& token : tokens) {
+                if (!out.empty() && out.back().first == token) {
+                    out.back().second++;
+                } else {
+                    out.emplace_back(std::move(token), 1);
+                }
+            }
+        }
+    }
+
+    void LexicalIndex::Tokenize(std::string_view text, std::vector<std::string>& out) {
+        std::string current;
+        for (char ch : text) {
+            auto c = static_cast<unsigned char>(ch);
+            if ((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c >= 0x80) {
+                current.push_back(ch);
+            } else if (c >= 'A' && c <= 'Z') {
+                current.push_back(static_cast<char>(c - 'A' + 'a'));
+            } else if (!current.empty()) {
+                out.push_back(std::move(current));
+                current.clear();
+            }
+        }
+        if (!current.empty()) {
+            out.push_back(std::move(current));
+        }
+    }
+
+    void LexicalIndex::Add(DocId doc, std::string_view content) {
+        if (liveDocs.contains(doc)) {
+            return;
+        }
+
+        // Reusing a removed id: purge its old postings first so they can't resurface
+        if (tombstones.contains(doc)) {
+            Compact();
+        }
+
+        std::vector<std::string> tokens;
+        Tokenize(content, tokens);
+        std::uint32_t length = static_cast<std::uint32_t>(tokens.size());
+
+        std::vector<std::pair<std::string, std::uint32_t>> terms;
+        CountTerms(tokens, terms);
+
+        auto& entry = liveDocs[doc];
+        entry.length = length;
+        entry.lists.reserve(terms.size());
+        for (auto& [term, frequency] : terms) {
+            auto& list = postings[term];
+            entry.lists.push_back(&list);
+            list.tailDocs.push_back(doc);
+            list.tailFrequencies.push_back(frequency);
+            list.documentFrequency++;
+
+            if (list.tailDocs.size() >= kBlockSize) {
+                SealTail(list);
+            }
+        }
+
+        totalLength += length;
+    }
+
+    void LexicalIndex::Remove(DocId doc) {
+        auto it = liveDocs.find(doc);
+        if (it == liveDocs.end()) {
+            return;
+        }
+
+        // Document frequencies are fixed now, postings are dropped on compaction
+        for (auto* list : it->second.lists) {
+            if (list->documentFrequency > 0) {
+                list->documentFrequency--;
+            }
+        }
+
+        totalLength -= it->second.length;
+        liveDocs.erase(it);
+        tombstones.insert(doc);
+
+        if (tombstones.size() >= kCompactMinTombstones && tombstones.size() * 4 >= liveDocs.size()) {
+            Compact();
+        }
+    }
+
+    void LexicalIndex::Compact() {
+        if (tombstones.empty()) {
+            return;
+        }
+
+        std::vector<DocId> docs;
+        std::vector<std::uint32_t> frequencies;
+
+        for (auto it = postings.begin(); it != postings.end();) {
+            auto& list = it->second;
+
+            // Decode everything, keep live postings, re-encode
+            docs.clear();
+            frequencies.clear();
+            for (const auto& block : list.blocks) {
+                DecodeBlock(block, docs, frequencies);
+            }
+            docs.insert(docs.end(), list.tailDocs.begin(), list.tailDocs.end());
+            frequencies.insert(frequencies.end(), list.tailFrequencies.begin(), list.tailFrequencies.end());
+
+            PostingList rebuilt;
+            rebuilt.documentFrequency = list.documentFrequency;
+            for (std::size_t i = 0; i < docs.size(); i++) {
+                if (tombstones.contains(docs[i])) continue;
+
+                rebuilt.tailDocs.push_back(docs[i]);
+                rebuilt.tailFrequencies.push_back(frequencies[i]);
+                if (rebuilt.tailDocs.size() >= kBlockSize) {
+                    SealTail(rebuilt);
+                }
+            }
+
+            if (rebuilt.blocks.empty() && rebuilt.tailDocs.empty()) {
+                it = postings.erase(it);
+            } else {
+                list = std::move(rebuilt);
+                ++it;
+            }
+        }
+
+        tombstones.clear();
+    }
+
+    void LexicalIndex::Clear() {
+        postings.clear();
+        liveDocs.clear();
+        tombstones.clear();
+        totalLength = 0;
+    }
+
+    LexicalIndex::SearchResult LexicalIndex::Search(std::string_view query, std::size_t k,
+                                                    std::chrono::microseconds budget,
+                                                    const std::function<bool(DocId)>& filter) const {
+        SearchResult result;
+        if (k == 0 || liveDocs.empty()) {
+            return result;
+        }
+
+        auto deadline = std::chrono::steady_clock::now() + budget;
+
+        std::vector<std::string> tokens;
+        Tokenize(query, tokens);
+        std::sort(tokens.begin(), tokens.end());
+        tokens.erase(std::unique(tokens.begin(), tokens.end()), tokens.end());
+
+        const float docCount = static_cast<float>(liveDocs.size());
+        const float averageLength = (std::max)(1.0f, static_cast<float>(totalLength) / docCount);
+
+        // Rarest terms first; terms in over half the docs carry almost no signal
+        std::vector<std::pair<float, const PostingList*>> terms;
+        for (const auto& token : tokens) {
+            auto it = postings.find(token);
+            if (it == postings.end() || it->second.documentFrequency == 0) continue;
+
+            float df = static_cast<float>(it->second.documentFrequency);
+            if (df > docCount * 0.5f && docCount > 8.0f) continue;
+
+            float idf = std::log(1.0f + (docCount - df + 0.5f) / (df + 0.5f));
+            terms.emplace_back(idf, &it->second);
+        }
+        std::sort(terms.begin(), terms.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+
+        std::unordered_map<DocId, float> scores;
+        std::vector<DocId> docs;
+        std::vector<std::uint32_t> frequencies;
+
+        auto scorePostings = [&](float idf, const std::vector<DocId>& blockDocs, const std::vector<std::uint32_t>& blockFrequencies) {
+            for (std::size_t i = 0; i < blockDocs.size(); i++) {
+                auto entry = liveDocs.find(blockDocs[i]);
+                if (entry == liveDocs.end()) continue;  // Tombstoned
+
+                float tf = static_cast<float>(blockFrequencies[i]);
+                float norm = kK1 * (1.0f - kB + kB * static_cast<float>(entry->second.length) / averageLength);
+                scores[blockDocs[i]] += idf * tf * (kK1 + 1.0f) / (tf + norm);
+            }
+        };
+
+        for (const auto& [idf, list] : terms) {
+            for (const auto& block : list->blocks) {
+                if (std::chrono::steady_clock::now() > deadline) {
+                    result.truncated = true;
+                    break;
+                }
+                docs.clear();
+                frequencies.clear();
+                DecodeBlock(block, docs, frequencies);
+                scorePostings(idf, docs, frequencies);
+            }
+            if (result.truncated) break;
+
+            scorePostings(idf, list->tailDocs, list->tailFrequencies);
+        }
+
+        result.hits.reserve(scores.size());
+        for (const auto& [doc, score] : scores) {
+            if (!filter || filter(doc)) {
+                result.hits.push_back({doc, score});
+            }
+        }
+
+        std::size_t count = (std::min)(k, result.hits.size());
+        std::partial_sort(result.hits.begin(), result.hits.begin() + count, result.hits.end(),
+            [](const Hit& a, const Hit& b) { return a.score > b.score; });
+        result.hits.resize(count);
+        return result;
+    }
+
+    void LexicalIndex::SealTail(PostingList& list) {
+        if (list.tailDocs.empty()) {
+            return;
+        }
+
+        Block block;
+        block.firstDoc = list.tailDocs.front();
+        block.count = static_cast<std::uint32_t>(list.tailDocs.size());
+        block.bytes.reserve(list.tailDocs.size() * 2);
+
+        DocId previous = block.firstDoc;
+        for (std::size_t i = 0; i < list.tailDocs.size(); i++) {
+            WriteVarint(block.bytes, list.tailDocs[i] - previous);
+            WriteVarint(block.bytes, list.tailFrequencies[i]);
+            previous = list.tailDocs[i];
+        }
+        block.bytes.shrink_to_fit();
+
+        list.blocks.push_back(std::move(block));
+        list.tailDocs.clear();
+        list.tailFrequencies.clear();
+    }
+
+    void LexicalIndex::DecodeBlock(const Block& block, std::vector<DocId>& docs, std::vector<std::uint32_t>& frequencies) {
+        const std::uint8_t* p = block.bytes.data();
+        DocId doc = block.firstDoc;
+        for (std::uint32_t i = 0; i < block.count; i++) {
+            doc += ReadVarint(p);
+            docs.push_back(doc);
+            frequencies.push_back(ReadVarint(p));
+        }
+    }
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * Lexical Memory Index Overview
+ *
+ * Vector search is good at paraphrases but weak on exact names ("Nazeem",
+ * "Cloud District"). This is an incremental BM25 inverted index over the same
+ * memories so PrepareContext can fuse both kinds of recall.
+ *
+ * 1. Postings:
+ *    - One posting list per term, doc ids are memory ids (always increasing)
+ *    - New postings go to an uncompressed tail; every kBlockSize postings the
+ *      tail is sealed into a block of varint (doc delta, term frequency) pairs
+ *
+ * 2. Deletion:
+ *    - Each live doc keeps pointers to its posting lists, so Remove() needs
+ *      only the id; it tombstones the doc and fixes document frequencies
+ *    - Postings of removed docs are dropped lazily by Compact(), which runs
+ *      automatically once tombstones make up a large share of the index
+ *
+ * 3. Search:
+ *    - Term-at-a-time BM25 (k1 = 1.2, b = 0.75) with a time budget; rarest
+ *      terms are scored first so a truncated search still ranks the most
+ *      selective evidence
+ *
+ * The index is not synchronized; the owning agent guards it with its memory lock.
+ */
+
+namespace TESSERACT::Agent::Memory {
+    class LexicalIndex {
+    public:
+        using DocId = std::uint32_t;
+
+        struct Hit {
+            DocId doc;
+            float score;
+        };
+
+        struct SearchResult {
+            std::vector<Hit> hits;
+            bool truncated = false;  // Ran out of time budget before scoring every term
+        };
+
+        static constexpr std::size_t kBlockSize = 128;
+
+        // Index maintenance
+        void Add(DocId doc, std::string_view content);
+        void Remove(DocId doc);  // Needs no text, so evicting a packed memory never unpacks it
+        void Compact();
+        void Clear();
+
+        // Top-k BM25 search within a time budget
+        SearchResult Search(std::string_view query, std::size_t k, std::chrono::microseconds budget,
+                            const std::function<bool(DocId)>& filter = {}) const;
+
+        std::size_t Size() const { return liveDocs.size(); }
+
+        // Shared tokenizer: lowercased ASCII words, UTF-8 bytes kept as word characters
+        static void Tokenize(std::string_view text, std::vector<std::string>& out);
+
+    private:
+        struct Block {
+            DocId firstDoc;
+            std::uint32_t count;
+            std::vector<std::uint8_t> bytes;  // varint (doc delta, frequency) pairs
+        };
+
+        struct PostingList {
+            std::vector<Block> blocks;
+            std::vector<DocId> tailDocs;
+            std::vector<std::uint32_t> tailFrequencies;
+            std::uint32_t documentFrequency = 0;  // Live docs only
+        };
+
+        static void SealTail(PostingList& list);
+        static void DecodeBlock(const Block& block, std::vector<DocId>& docs, std::vector<std::uint32_t>& frequencies);
+
+        struct Doc {
+            std::uint32_t length;
+            std::vector<PostingList*> lists;  // One per distinct term; map nodes never move
+        };
+
+        std::unordered_map<std::string, PostingList> postings;
+        std::unordered_map<DocId, Doc> liveDocs;
+        std::unordered_set<DocId> tombstones;     // Removed docs still present in postings
+        std::uint64_t totalLength = 0;
+    };
+}
@@ -0,0 +1,67 @@
+#include "Lod.h"
+#include "Agent.h"
+#include <algorithm>
+#include <array>
+
+namespace TESSERACT::Agent::Lod {
+    namespace {
+        constexpr std::array<Policy, static_cast<std::size_t>(Tier::Count)> kPolicies{{
+            {1, 0, true},       // Focus: every frame, replies are waited on
+            {4, 0, true},       // Near
+            {30, 2048, true},   // Far: about twice a second
+            {300, 1024, false}  // Dormant: collect finished work and events only
+        }};
+
+        // Distance tier with hysteresis: entering needs d <= edge, leaving needs d > edge * (1 + kHysteresis)
+        Tier ByDistance(float distance, Tier current) {
+            const float nearEdge = static_cast<float>(Memory::lodNearDistance);
+            const float farEdge = static_cast<float>(Memory::lodFarDistance);
+            const float slack = 1.0f + kHysteresis;
+
+            bool wasNear = current <= Tier::Near;
+            bool wasFar = current <= Tier::Far;
+            if (distance <= (wasNear ? nearEdge * slack : nearEdge)) return Tier::Near;
+            if (distance <= (wasFar ? farEdge * slack : farEdge)) return Tier::Far;
+            return Tier::Dormant;
+        }
+    }
+
+    Tier Classify(const Snapshots::ActorSnapshot& actor, bool talking, Tier current) {
+        if (talking) {
+            return Tier::Focus;
+        }
+        if (!actor.frame || !actor.loaded || actor.dead || actor.distance < 0.0f) {
+            return Tier::Dormant;
+        }
+
+        auto tier = ByDistance(actor.distance, current);
+        // Something the player is looking at or fighting beside gets near treatment
+        if (tier == Tier::Far && (actor.inSight || actor.inCombat)) {
+            tier = Tier::Near;
+        }
+        return tier;
+    }
+
+    const Policy& PolicyFor(Tier tier) {
+        auto index = static_cast<std::size_t>(tier);
+        return kPolicies[index < kPolicies.size() ? index : kPolicies.size() - 1];
+    }
+
+    const std::string& ModelFor(Tier tier, const std::string& fallback) {
+        return tier >= Tier::Far && !Memory::lodFarModel.empty() ? Memory::lodFarModel : fallback;
+    }
+
+    std::uint32_t PromptBudget(Tier tier, std::uint32_t budget) {
+        auto cap = PolicyFor(tier).contextTokens;
+        return cap > 0 ? (std::min)(budget, cap) : budget;
+    }
+
+    const char* Name(Tier tier) {
+        switch (tier) {
+            case Tier::Focus: return "focus";
+            case Tier::Near: return "near";
+            case Tier::Far: return "far";
+            default: return "dormant";
+        }
+    }
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include "ActorSnapshot.h"
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+/**
+ * Agent Level of Detail Overview
+ *
+ * Spends backend capacity where the player can notice it. Every managed agent
+ * sits in one tier, which the scheduler recomputes whenever it visits the
+ * agent (see Scheduler.h) from its actor snapshot alone.
+ *
+ * 1. Tiers:
+ *    - Focus: in conversation with the player
+ *    - Near: within lodNearDistance, or fighting, or in the player's sight
+ *      within lodFarDistance
+ *    - Far: within lodFarDistance
+ *    - Dormant: beyond that, unloaded or dead
+ *
+ * 2. Hysteresis:
+ *    - Moving out a tier takes kHysteresis more distance than moving in, so
+ *      an NPC pacing on a boundary does not flip every frame
+ *
+ * 3. Policy per tier:
+ *    - How often Update() runs, the prompt token cap, whether background
+ *      thoughts (consolidation, fact mining) start, and the model (Far and
+ *      Dormant use lodFarModel when it is set)
+ *    - Every request an agent makes goes through its tier: replies, the span
+ *      a consolidation folds, the lines fact mining reads, scene segments
+ *    - Dialogue only happens in a pinned chat, which is always Focus, so in
+ *      practice the caps and lodFarModel shape background requests of Far
+ *      agents; scenes only form between Near agents, which have no cap
+ */
+
+namespace TESSERACT::Agent::Lod {
+    enum class Tier : std::uint8_t {
+        Focus,
+        Near,
+        Far,
+        Dormant,
+        Count
+    };
+
+    struct Policy {
+        std::uint32_t tickInterval;   // Frames between updates
+        std::uint32_t contextTokens;  // Prompt cap, 0 = the full dialogue budget
+        bool background;              // Consolidation and fact extraction
+    };
+
+    constexpr float kHysteresis = 0.15f;
+
+    // Per agent, written by the scheduler
+    struct AgentLod {
+        std::atomic<Tier> tier{Tier::Near};
+        std::uint64_t lastTick = 0;  // Scheduler frame of the last update
+    };
+
+    Tier Classify(const Snapshots::ActorSnapshot& actor, bool talking, Tier current);
+
+    const Policy& PolicyFor(Tier tier);
+    const std::string& ModelFor(Tier tier, const std::string& fallback);
+    std::uint32_t PromptBudget(Tier tier, std::uint32_t budget);  // A request class's prompt budget under the tier's cap
+    const char* Name(Tier tier);
+}
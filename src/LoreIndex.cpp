@@ -0,0 +1,511 @@
+#include "LoreIndex.h"
+#include "Embedding.h"
+#include "LexicalIndex.h"
+#include "MappedFile.h"
+#include "VectorMath.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <cmath>
+#include <format>
+#include <fstream>
+#include <future>
+#include <memory>
+#include <sstream>
+#include <unordered_map>
+
+namespace TESSERACT::Agent::Lore {
+    namespace {
+        constexpr std::uint32_t kMagic = 0x45524F4C;  // "LORE"
+        constexpr std::uint32_t kVersion = 1;
+        constexpr std::uint32_t kDimensions = 256;     // Fixed, so memory settings never force a rebuild
+        constexpr std::size_t kMaxChunkWords = kChunkWords * 3 / 2;
+        constexpr float kMinSimilarity = 0.2f;         // Below this an embedding match is noise
+        constexpr float kFusionOffset = 60.0f;
+        constexpr float kK1 = 1.2f;
+        constexpr float kB = 0.75f;
+
+        // Words that would match every passage; neither indexed nor searched
+        constexpr std::array<std::string_view, 32> kStopWords = {
+            "a", "about", "an", "and", "are", "at", "be", "by", "do", "for", "from", "have", "i", "in", "is", "it",
+            "me", "my", "of", "on", "so", "tell", "that", "the", "this", "to", "was", "what", "who", "with", "you", "your"
+        };
+
+        bool IsStopWord(std::string_view word) {
+            return word.size() < 2 || std::find(kStopWords.begin(), kStopWords.end(), word) != kStopWords.end();
+        }
+
+        const std::filesystem::path kCorpusDirectory = "Data\\SKSE\\Plugins\\TESSERACT\\lore";
+        const std::filesystem::path kIndexFile = "Data\\SKSE\\Plugins\\TESSERACT\\lore.idx";
+
+        struct Header {
+            std::uint32_t magic;
+            std::uint32_t version;
+            std::uint64_t stamp;         // Of the corpus it was built from
+            std::uint32_t dimensions;
+            std::uint32_t chunkCount;
+            std::uint32_t termCount;
+            std::uint32_t postingCount;
+            float averageLength;         // Words per chunk, for BM25
+            std::uint32_t reserved;
+            std::uint64_t chunksOffset;
+            std::uint64_t vectorsOffset;
+            std::uint64_t termsOffset;
+            std::uint64_t postingsOffset;
+            std::uint64_t textOffset;
+            std::uint64_t fileSize;
+        };
+        static_assert(sizeof(Header) == 88);
+
+        struct ChunkRecord {
+            std::uint64_t textOffset;  // From Header::textOffset
+            std::uint32_t textLength;
+            std::uint32_t length;      // Words
+            float scale;               // Of the int8 embedding
+            std::uint32_t reserved;
+        };
+        static_assert(sizeof(ChunkRecord) == 24);
+
+        struct TermRecord {
+            std::uint64_t hash;
+            std::uint32_t first;  // Into the postings
+            std::uint32_t count;
+        };
+        static_assert(sizeof(TermRecord) == 16);
+
+        struct Posting {
+            std::uint32_t chunk;
+            std::uint32_t frequency;
+        };
+        static_assert(sizeof(Posting) == 8);
+
+        // A mapped index; readers keep it alive through the shared_ptr
+        struct Index {
+            Utils::MappedFile file;
+            const Header* header = nullptr;
+            const ChunkRecord* chunks = nullptr;
+            const std::int8_t* vectors = nullptr;
+            const TermRecord* terms = nullptr;
+            const Posting* postings = nullptr;
+            const char* text = nullptr;
+
+            std::string_view Text(std::uint32_t chunk) const {
+                return {text + chunks[chunk].textOffset, chunks[chunk].textLength};
+            }
+        };
+
+        struct State {
+            std::atomic<std::shared_ptr<const Index>> index;
+            std::future<void> build;
+        };
+
+        State& GetState() {
+            static State state;
+            return state;
+        }
+
+        bool IsLoreFile(const std::filesystem::path& path) {
+            auto extension = path.extension().string();
+            std::transform(extension.begin(), extension.end(), extension.begin(),
+                [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+            return extension == ".txt" || extension == ".md";
+        }
+
+        std::vector<std::filesystem::path> CorpusFiles(const std::filesystem::path& corpus) {
+            std::vector<std::filesystem::path> files;
+            std::error_code error;
+            for (std::filesystem::recursive_directory_iterator it(corpus, error), end; !error && it != end; it.increment(error)) {
+                if (it->is_regular_file(error) && IsLoreFile(it->path())) {
+                    files.push_back(it->path());
+                }
+            }
+            std::sort(files.begin(), files.end());
+            return files;
+        }
+
+        // Changes whenever a file is added, removed, resized or touched
+        std::uint64_t CorpusStamp(const std::vector<std::filesystem::path>& files) {
+            std::string listing = std::format("v{} d{}\n", kVersion, kDimensions);
+            std::error_code error;
+            for (const auto& file : files) {
+                auto size = std::filesystem::file_size(file, error);
+                auto time = std::filesystem::last_write_time(file, error).time_since_epoch().count();
+                listing += std::format("{}|{}|{}\n", file.generic_string(), size, static_cast<long long>(time));
+            }
+            return Embedding::ContentHash(listing);
+        }
+
+        std::string Trim(std::string_view text) {
+            auto begin = text.find_first_not_of(" \t\r\n");
+            if (begin == std::string_view::npos) return {};
+            auto end = text.find_last_not_of(" \t\r\n");
+            return std::string(text.substr(begin, end - begin + 1));
+        }
+
+        // Paragraphs packed into chunks, each prefixed with where it came from
+        void ChunkFile(const std::filesystem::path& path, std::vector<std::string>& chunks) {
+            std::ifstream file(path, std::ios::binary);
+            if (!file.is_open()) {
+                logger::warn("Could not read lore file {}", path.string());
+                return;
+            }
+
+            auto title = path.stem().string();
+            std::replace(title.begin(), title.end(), '_', ' ');
+            std::string section;
+
+            std::string body;
+            std::size_t words = 0;
+            auto flush = [&]() {
+                if (body.empty()) return;
+                chunks.push_back(section.empty() ? std::format("{}: {}", title, body) :
+                                                   std::format("{} ({}): {}", title, section, body));
+                body.clear();
+                words = 0;
+            };
+            auto addWord = [&](std::string_view word) {
+                if (words >= kMaxChunkWords) flush();
+                if (!body.empty()) body += ' ';
+                body += word;
+                words++;
+            };
+
+            std::string line, paragraph;
+            auto endParagraph = [&]() {
+                if (paragraph.empty()) return;
+                auto paragraphWords = static_cast<std::size_t>(std::count(paragraph.begin(), paragraph.end(), ' ')) + 1;
+                if (words > 0 && words + paragraphWords > kChunkWords) flush();
+                std::istringstream stream(paragraph);
+                std::string word;
+                while (stream >> word) addWord(word);
+                paragraph.clear();
+            };
+
+            while (std::getline(file, line)) {
+                auto trimmed = Trim(line);
+                if (trimmed.empty()) {
+                    endParagraph();
+                } else if (trimmed[0] == '#') {
+                    // A new heading starts a new chunk
+                    endParagraph();
+                    flush();
+                    auto start = trimmed.find_first_not_of('#');
+                    section = start == std::string::npos ? "" : Trim(std::string_view(trimmed).substr(start));
+                } else {
+                    if (!paragraph.empty()) paragraph += ' ';
+                    paragraph += trimmed;
+                }
+            }
+            endParagraph();
+            flush();
+        }
+
+        std::shared_ptr<const Index> Load(const std::filesystem::path& path, std::uint64_t stamp) {
+            auto index = std::make_shared<Index>();
+            if (!index->file.Open(path) || index->file.Size() < sizeof(Header)) {
+                return nullptr;
+            }
+
+            auto bytes = index->file.Bytes();
+            const auto* header = reinterpret_cast<const Header*>(bytes.data());
+            if (header->magic != kMagic || header->version != kVersion || header->stamp != stamp ||
+                header->dimensions != kDimensions || header->fileSize != bytes.size()) {
+                return nullptr;
+            }
+
+            auto fits = [&](std::uint64_t offset, std::uint64_t length) {
+                return offset <= bytes.size() && length <= bytes.size() - offset;
+            };
+            if (!fits(header->chunksOffset, std::uint64_t{header->chunkCount} * sizeof(ChunkRecord)) ||
+                !fits(header->vectorsOffset, std::uint64_t{header->chunkCount} * kDimensions) ||
+                !fits(header->termsOffset, std::uint64_t{header->termCount} * sizeof(TermRecord)) ||
+                !fits(header->postingsOffset, std::uint64_t{header->postingCount} * sizeof(Posting)) ||
+                !fits(header->textOffset, 0)) {
+                logger::error("Lore index {} is damaged", path.string());
+                return nullptr;
+            }
+
+            index->header = header;
+            index->chunks = reinterpret_cast<const ChunkRecord*>(bytes.data() + header->chunksOffset);
+            index->vectors = reinterpret_cast<const std::int8_t*>(bytes.data() + header->vectorsOffset);
+            index->terms = reinterpret_cast<const TermRecord*>(bytes.data() + header->termsOffset);
+            index->postings = reinterpret_cast<const Posting*>(bytes.data() + header->postingsOffset);
+            index->text = reinterpret_cast<const char*>(bytes.data() + header->textOffset);
+
+            // Everything the retriever dereferences stays inside the mapping
+            const auto textBytes = bytes.size() - header->textOffset;
+            for (std::uint32_t i = 0; i < header->chunkCount; i++) {
+                const auto& chunk = index->chunks[i];
+                if (chunk.textOffset > textBytes || chunk.textLength > textBytes - chunk.textOffset) {
+                    logger::error("Lore index {} is damaged", path.string());
+                    return nullptr;
+                }
+            }
+            for (std::uint32_t i = 0; i < header->termCount; i++) {
+                const auto& term = index->terms[i];
+                if (term.first > header->postingCount || term.count > header->postingCount - term.first) {
+                    logger::error("Lore index {} is damaged", path.string());
+                    return nullptr;
+                }
+            }
+            return index;
+        }
+
+        std::uint64_t Align(std::uint64_t offset) {
+            return (offset + 7) & ~std::uint64_t{7};
+        }
+    }
+
+    bool Build(const std::filesystem::path& corpus, const std::filesystem::path& indexPath) {
+        auto startTime = std::chrono::high_resolution_clock::now();
+        auto files = CorpusFiles(corpus);
+
+        std::vector<std::string> chunks;
+        for (const auto& file : files) {
+            ChunkFile(file, chunks);
+        }
+        if (chunks.empty()) {
+            return false;
+        }
+
+        Header header{};
+        header.magic = kMagic;
+        header.version = kVersion;
+        header.stamp = CorpusStamp(files);
+        header.dimensions = kDimensions;
+        header.chunkCount = static_cast<std::uint32_t>(chunks.size());
+
+        // Postings and embeddings
+        std::vector<ChunkRecord> records(chunks.size());
+        std::vector<std::int8_t> vectors(chunks.size() * kDimensions);
+        std::unordered_map<std::uint64_t, std::vector<Posting>> postingsByTerm;
+        std::vector<float> embedding(kDimensions);
+        std::vector<std::string> words;
+        std::unordered_map<std::uint64_t, std::uint32_t> frequencies;
+        std::uint64_t textBytes = 0, totalWords = 0;
+
+        for (std::uint32_t i = 0; i < chunks.size(); i++) {
+            words.clear();
+            frequencies.clear();
+            Memory::LexicalIndex::Tokenize(chunks[i], words);
+            for (const auto& word : words) {
+                if (!IsStopWord(word)) frequencies[Embedding::ContentHash(word)]++;
+            }
+            for (auto [hash, frequency] : frequencies) {
+                postingsByTerm[hash].push_back({i, frequency});
+            }
+
+            Embedding::EmbedLocal(chunks[i], embedding.data(), kDimensions);
+            records[i].scale = VectorMath::QuantizeInt8(embedding.data(), &vectors[std::size_t{i} * kDimensions], kDimensions);
+            records[i].textOffset = textBytes;
+            records[i].textLength = static_cast<std::uint32_t>(chunks[i].size());
+            records[i].length = static_cast<std::uint32_t>(words.size());
+            textBytes += chunks[i].size();
+            totalWords += words.size();
+        }
+        header.averageLength = static_cast<float>(totalWords) / static_cast<float>(chunks.size());
+
+        std::vector<TermRecord> terms;
+        terms.reserve(postingsByTerm.size());
+        for (const auto& [hash, list] : postingsByTerm) {
+            terms.push_back({hash, 0, static_cast<std::uint32_t>(list.size())});
+        }
+        std::sort(terms.begin(), terms.end(), [](const TermRecord& a, const TermRecord& b) { return a.hash < b.hash; });
+        std::vector<Posting> postings;
+        for (auto& term : terms) {
+            term.first = static_cast<std::uint32_t>(postings.size());
+            const auto& list = postingsByTerm[term.hash];
+            postings.insert(postings.end(), list.begin(), list.end());
+        }
+        header.termCount = static_cast<std::uint32_t>(terms.size());
+        header.postingCount = static_cast<std::uint32_t>(postings.size());
+
+        // Layout: every section 8 byte aligned so the mapping can be read in place
+        header.chunksOffset = Align(sizeof(Header));
+        header.vectorsOffset = Align(header.chunksOffset + records.size() * sizeof(ChunkRecord));
+        header.termsOffset = Align(header.vectorsOffset + vectors.size());
+        header.postingsOffset = Align(header.termsOffset + terms.size() * sizeof(TermRecord));
+        header.textOffset = Align(header.postingsOffset + postings.size() * sizeof(Posting));
+        header.fileSize = header.textOffset + textBytes;
+
+        // Written next to the index and renamed, so a crash never leaves half an index
+        auto temporary = indexPath;
+        temporary += ".tmp";
+        {
+            std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+            if (!out.is_open()) {
+                logger::error("Could not write lore index {}", temporary.string());
+                return false;
+            }
+
+            auto writeAt = [&](std::uint64_t offset, const void* data, std::size_t size) {
+                static const char padding[8] = {};
+                auto position = static_cast<std::uint64_t>(out.tellp());
+                out.write(padding, static_cast<std::streamsize>(offset - position));
+                out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+            };
+            writeAt(0, &header, sizeof(header));
+            writeAt(header.chunksOffset, records.data(), records.size() * sizeof(ChunkRecord));
+            writeAt(header.vectorsOffset, vectors.data(), vectors.size());
+            writeAt(header.termsOffset, terms.data(), terms.size() * sizeof(TermRecord));
+            writeAt(header.postingsOffset, postings.data(), postings.size() * sizeof(Posting));
+            out.seekp(static_cast<std::streamoff>(header.textOffset));
+            for (const auto& chunk : chunks) {
+                out.write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+            }
+            if (!out) {
+                logger::error("Could not write lore index {}", temporary.string());
+                return false;
+            }
+        }
+
+        std::error_code error;
+        std::filesystem::rename(temporary, indexPath, error);
+        if (error) {
+            logger::error("Could not replace lore index {}: {}", indexPath.string(), error.message());
+            return false;
+        }
+
+        auto endTime = std::chrono::high_resolution_clock::now();
+        logger::info("Indexed {} lore files into {} passages ({} terms) in {} ms", files.size(), chunks.size(), terms.size(),
+            std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count());
+        return true;
+    }
+
+    void Initialize() {
+        auto& state = GetState();
+        auto startTime = std::chrono::high_resolution_clock::now();
+
+        auto files = CorpusFiles(kCorpusDirectory);
+        if (files.empty()) {
+            logger::info("No lore corpus at {}, lore retrieval is off", kCorpusDirectory.string());
+            return;
+        }
+
+        auto stamp = CorpusStamp(files);
+        if (auto index = Load(kIndexFile, stamp)) {
+            auto endTime = std::chrono::high_resolution_clock::now();
+            logger::info("Mapped lore index ({} passages) in {} ms", index->header->chunkCount,
+                std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count());
+            state.index.store(std::move(index));
+            return;
+        }
+
+        // Missing or stale: rebuild off the game thread, lore is simply absent until then
+        logger::info("Lore corpus changed, rebuilding the lore index in the background");
+        state.build = std::async(std::launch::async, [stamp]() {
+            if (!Build(kCorpusDirectory, kIndexFile)) return;
+            if (auto index = Load(kIndexFile, stamp)) {
+                GetState().index.store(std::move(index));
+            } else {
+                logger::warn("Lore corpus changed during indexing, it will be rebuilt next start");
+            }
+        });
+    }
+
+    bool IsReady() {
+        return GetState().index.load() != nullptr;
+    }
+
+    std::size_t Size() {
+        auto index = GetState().index.load();
+        return index ? index->header->chunkCount : 0;
+    }
+
+    std::vector<Passage> Retrieve(std::string_view query, std::size_t k, std::chrono::microseconds budget) {
+        auto index = GetState().index.load();
+        if (!index || k == 0 || query.empty()) {
+            return {};
+        }
+
+        const auto deadline = std::chrono::steady_clock::now() + budget;
+        const auto& header = *index->header;
+        const std::size_t candidates = k * 4;
+
+        // Lexical: BM25, rarest terms first so a cut-off search keeps the most selective evidence
+        std::vector<std::string> words;
+        Memory::LexicalIndex::Tokenize(query, words);
+        std::vector<const TermRecord*> queryTerms;
+        for (const auto& word : words) {
+            if (IsStopWord(word)) continue;
+            auto hash = Embedding::ContentHash(word);
+            auto it = std::lower_bound(index->terms, index->terms + header.termCount, hash,
+                [](const TermRecord& term, std::uint64_t value) { return term.hash < value; });
+            if (it != index->terms + header.termCount && it->hash == hash &&
+                std::find(queryTerms.begin(), queryTerms.end(), it) == queryTerms.end()) {
+                queryTerms.push_back(it);
+            }
+        }
+        std::sort(queryTerms.begin(), queryTerms.end(),
+            [](const TermRecord* a, const TermRecord* b) { return a->count < b->count; });
+
+        std::unordered_map<std::uint32_t, float> bm25;
+        const auto n = static_cast<float>(header.chunkCount);
+        for (const auto* term : queryTerms) {
+            if (std::chrono::steady_clock::now() > deadline) break;
+            auto df = static_cast<float>(term->count);
+            float idf = std::log(1.0f + (n - df + 0.5f) / (df + 0.5f));
+            for (std::uint32_t i = 0; i < term->count; i++) {
+                const auto& posting = index->postings[term->first + i];
+                auto tf = static_cast<float>(posting.frequency);
+                float norm = kK1 * (1.0f - kB + kB * index->chunks[posting.chunk].length / header.averageLength);
+                bm25[posting.chunk] += idf * tf * (kK1 + 1.0f) / (tf + norm);
+            }
+        }
+
+        std::vector<std::pair<std::uint32_t, float>> lexical(bm25.begin(), bm25.end());
+        auto byScore = [](const auto& a, const auto& b) { return a.second > b.second; };
+        if (lexical.size() > candidates) {
+            std::partial_sort(lexical.begin(), lexical.begin() + candidates, lexical.end(), byScore);
+            lexical.resize(candidates);
+        } else {
+            std::sort(lexical.begin(), lexical.end(), byScore);
+        }
+
+        // Semantic: int8 scan with whatever budget is left
+        std::vector<float> embedding(kDimensions);
+        std::vector<std::int8_t> queryCode(kDimensions);
+        Embedding::EmbedLocal(query, embedding.data(), kDimensions);
+        float queryScale = VectorMath::QuantizeInt8(embedding.data(), queryCode.data(), kDimensions);
+
+        std::vector<std::pair<std::uint32_t, float>> semantic;
+        for (std::uint32_t chunk = 0; chunk < header.chunkCount; chunk++) {
+            if ((chunk & 511) == 0 && chunk > 0 && std::chrono::steady_clock::now() > deadline) {
+                logger::debug("Lore scan ran out of its {}us budget after {} passages", budget.count(), chunk);
+                break;
+            }
+            float similarity = queryScale * index->chunks[chunk].scale *
+                static_cast<float>(VectorMath::DotInt8(queryCode.data(), index->vectors + std::size_t{chunk} * kDimensions, kDimensions));
+            if (similarity >= kMinSimilarity) {
+                semantic.push_back({chunk, similarity});
+            }
+        }
+        if (semantic.size() > candidates) {
+            std::partial_sort(semantic.begin(), semantic.begin() + candidates, semantic.end(), byScore);
+            semantic.resize(candidates);
+        } else {
+            std::sort(semantic.begin(), semantic.end(), byScore);
+        }
+
+        // Reciprocal rank fusion
+        std::unordered_map<std::uint32_t, float> fused;
+        for (std::size_t rank = 0; rank < lexical.size(); rank++) {
+            fused[lexical[rank].first] += 1.0f / (kFusionOffset + rank + 1);
+        }
+        for (std::size_t rank = 0; rank < semantic.size(); rank++) {
+            fused[semantic[rank].first] += 1.0f / (kFusionOffset + rank + 1);
+        }
+
+        std::vector<std::pair<std::uint32_t, float>> ranked(fused.begin(), fused.end());
+        std::sort(ranked.begin(), ranked.end(), byScore);
+        if (ranked.size() > k) ranked.resize(k);
+
+        std::vector<Passage> passages;
+        passages.reserve(ranked.size());
+        for (auto [chunk, score] : ranked) {
+            passages.push_back({std::string(index->Text(chunk)), score});
+        }
+        return passages;
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * Lore Index Overview
+ *
+ * Grounds NPCs in the setting without pasting lore into every prompt: a local
+ * corpus is indexed once, and each turn pulls the few passages relevant to
+ * what the player just said.
+ *
+ * 1. Corpus and indexing:
+ *    - .txt and .md files under Data\SKSE\Plugins\TESSERACT\lore; the file name
+ *      and markdown headings become the title of each passage
+ *    - Paragraphs are packed into chunks of ~kChunkWords words
+ *    - Build() writes lore.idx next to the folder; Initialize() only runs it
+ *      (in the background) when the corpus changed since the last build
+ *
+ * 2. Index file (memory-mapped, loads in milliseconds):
+ *    - Header, chunk table, int8 embeddings (local model, see Embedding.h),
+ *      a term table sorted by hash with BM25 postings, then the chunk text
+ *
+ * 3. Retrieval:
+ *    - BM25 over the postings (rarest terms first), then a brute-force int8
+ *      scan of the embeddings, both within one time budget; the two rankings
+ *      are fused like memory recall (reciprocal rank)
+ */
+
+namespace TESSERACT::Agent::Lore {
+    constexpr std::size_t kChunkWords = 120;
+
+    struct Passage {
+        std::string text;
+        float score;
+    };
+
+    // Startup: maps the index, rebuilding it first if the corpus changed
+    void Initialize();
+
+    // Offline indexer: corpus folder to index file, false if there was nothing to index
+    bool Build(const std::filesystem::path& corpus, const std::filesystem::path& indexPath);
+
+    bool IsReady();
+    std::size_t Size();  // Indexed passages
+
+    // Best passages for the query, best first; empty when nothing is relevant
+    std::vector<Passage> Retrieve(std::string_view query, std::size_t k, std::chrono::microseconds budget);
+}
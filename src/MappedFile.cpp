@@ -0,0 +1,93 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace TESSERACT::Utils {
+    MappedFile::~MappedFile() {
+        Close();
+    }
+
+#ifdef _WIN32
+    bool MappedFile::Open(const std::filesystem::path& path) {
+        Close();
+
+        file = ::CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+            nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            file = nullptr;
+            return false;
+        }
+
+        LARGE_INTEGER fileSize;
+        if (!::GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+            Close();
+            return false;
+        }
+
+        mapping = ::CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping) {
+            Close();
+            return false;
+        }
+
+        data = static_cast<const std::uint8_t*>(::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        if (!data) {
+            Close();
+            return false;
+        }
+
+        size = static_cast<std::size_t>(fileSize.QuadPart);
+        return true;
+    }
+
+    void MappedFile::Close() {
+        if (data) ::UnmapViewOfFile(data);
+        if (mapping) ::CloseHandle(mapping);
+        if (file) ::CloseHandle(file);
+        data = nullptr;
+        mapping = nullptr;
+        file = nullptr;
+        size = 0;
+    }
+#else
+    bool MappedFile::Open(const std::filesystem::path& path) {
+        Close();
+
+        descriptor = ::open(path.c_str(), O_RDONLY);
+        if (descriptor < 0) {
+            return false;
+        }
+
+        struct stat info;
+        if (::fstat(descriptor, &info) != 0 || info.st_size == 0) {
+            Close();
+            return false;
+        }
+
+        void* view = ::mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_SHARED, descriptor, 0);
+        if (view == MAP_FAILED) {
+            Close();
+            return false;
+        }
+
+        data = static_cast<const std::uint8_t*>(view);
+        size = static_cast<std::size_t>(info.st_size);
+        return true;
+    }
+
+    void MappedFile::Close() {
+        if (data) ::munmap(const_cast<std::uint8_t*>(data), size);
+        if (descriptor >= 0) ::close(descriptor);
+        data = nullptr;
+        descriptor = -1;
+        size = 0;
+    }
+#endif
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+
+namespace TESSERACT::Utils {
+    // Read-only memory mapping of a whole file. The mapping reflects the file size
+    // at Open time; call Open again to see data appended since.
+    class MappedFile {
+    public:
+        MappedFile() = default;
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        bool Open(const std::filesystem::path& path);
+        void Close();
+
+        bool IsOpen() const { return data != nullptr; }
+        std::size_t Size() const { return size; }
+        std::span<const std::uint8_t> Bytes() const { return {data, size}; }
+
+    private:
+        const std::uint8_t* data = nullptr;
+        std::size_t size = 0;
+#ifdef _WIN32
+        void* file = nullptr;
+        void* mapping = nullptr;
+#else
+        int descriptor = -1;
+#endif
+    };
+}
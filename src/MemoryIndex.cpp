@@ -0,0 +1,93 @@
+#include "MemoryIndex.h"
+#include "MemoryScoring.h"
+#include "VectorMath.h"
+#include <algorithm>
+
+namespace TESSERACT::Agent::Memory {
+    VectorIndex::VectorIndex(std::size_t dimensions)
+        : dimensions(dimensions) {
+    }
+
+    void VectorIndex::Append() {
+        scales.push_back(0.0f);
+        codes.resize(codes.size() + dimensions, 0);
+    }
+
+    void VectorIndex::Insert(std::size_t row) {
+        row = (std::min)(row, Rows());
+        scales.insert(scales.begin() + row, 0.0f);
+        codes.insert(codes.begin() + row * dimensions, dimensions, 0);
+    }
+
+    void VectorIndex::Erase(std::size_t row) {
+        if (row >= Rows()) {
+            return;
+        }
+        scales.erase(scales.begin() + row);
+        auto first = codes.begin() + row * dimensions;
+        codes.erase(first, first + dimensions);
+    }
+
+    void VectorIndex::Erase(std::span<const std::size_t> rows) {
+        // One compaction pass instead of shifting the tail once per row
+        std::size_t write = 0;
+        std::size_t next = 0;
+        for (std::size_t read = 0; read < Rows(); read++) {
+            if (next < rows.size() && rows[next] == read) {
+                next++;
+                continue;
+            }
+            if (write != read) {
+                scales[write] = scales[read];
+                std::copy_n(&codes[read * dimensions], dimensions, &codes[write * dimensions]);
+            }
+            write++;
+        }
+        scales.resize(write);
+        codes.resize(write * dimensions);
+    }
+
+    void VectorIndex::Resize(std::size_t rows) {
+        scales.resize(rows, 0.0f);
+        codes.resize(rows * dimensions, 0);
+    }
+
+    void VectorIndex::Clear() {
+        scales.clear();
+        codes.clear();
+    }
+
+    bool VectorIndex::Set(std::size_t row, std::span<const float> embedding) {
+        if (row >= Rows()) {
+            return false;
+        }
+        if (embedding.size() != dimensions) {
+            logger::warn("VectorIndex::Set: Expected {} dimensions, got {}", dimensions, embedding.size());
+            return false;
+        }
+
+        // Normalize a copy so scores are cosine similarities
+        std::vector<float> normalized(embedding.begin(), embedding.end());
+        VectorMath::Normalize(normalized.data(), dimensions);
+        scales[row] = VectorMath::QuantizeInt8(normalized.data(), &codes[row * dimensions], dimensions);
+        return true;
+    }
+
+    void VectorIndex::Relevance(std::span<const float> query, std::span<float> out) const {
+        auto rows = (std::min)(out.size(), Rows());
+        std::fill(out.begin() + rows, out.end(), 0.0f);
+        if (query.size() != dimensions) {
+            std::fill(out.begin(), out.begin() + rows, 0.0f);
+            return;
+        }
+
+        thread_local std::vector<float> normalized;
+        thread_local std::vector<std::int8_t> queryCode;
+        normalized.assign(query.begin(), query.end());
+        queryCode.resize(dimensions);
+        VectorMath::Normalize(normalized.data(), dimensions);
+        float queryScale = VectorMath::QuantizeInt8(normalized.data(), queryCode.data(), dimensions);
+
+        Scoring::RelevanceInt8(queryCode.data(), queryScale, codes.data(), scales.data(), rows, dimensions, out.data());
+    }
+}
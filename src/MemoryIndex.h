@@ -0,0 +1,60 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+/**
+ * Memory Vector Index Overview
+ *
+ * Int8 embedding codes of one agent's memories, used by
+ * SubAgent::RetrieveRelevant to rank every older memory by relevance to the
+ * current input instead of replaying the whole history.
+ *
+ * 1. Storage:
+ *    - Embeddings are unit length and stored as int8 codes with one float scale
+ *    - Structure of arrays, row i belongs to the agent's memories[i]; the
+ *      agent inserts and erases rows together with its memories
+ *    - A row without an embedding yet has scale 0 and scores 0
+ *
+ * 2. Relevance:
+ *    - One batch kernel call scores every row against the query
+ *      (Scoring::RelevanceInt8, AVX2 when available), so there are no
+ *      per-memory lookups; at 10k memories and 384 dimensions a full exact
+ *      scan is a fraction of a millisecond (see Scoring::Benchmark)
+ *    - There is no approximate layer (IVF, HNSW) on purpose: one agent's
+ *      memories never get big enough for it to beat the exact scan, and
+ *      retraining one would stall retrieval while it holds the index
+ *
+ * 3. Threading:
+ *    - Not synchronized; the owning agent guards it with its memoryMutex
+ */
+
+namespace TESSERACT::Agent::Memory {
+    class VectorIndex {
+    public:
+        explicit VectorIndex(std::size_t dimensions);
+
+        // Row maintenance, mirroring the memories vector
+        void Append();
+        void Insert(std::size_t row);
+        void Erase(std::size_t row);
+        void Erase(std::span<const std::size_t> rows);  // Ascending
+        void Resize(std::size_t rows);                  // New rows are empty
+        void Clear();
+
+        // Stores the embedding of a row (false on a dimension mismatch)
+        bool Set(std::size_t row, std::span<const float> embedding);
+
+        // Cosine of the query against the first out.size() rows, clamped to [0, 1]
+        void Relevance(std::span<const float> query, std::span<float> out) const;
+
+        std::size_t Rows() const { return scales.size(); }
+        std::size_t Dimensions() const { return dimensions; }
+
+    private:
+        std::size_t dimensions;
+        std::vector<float> scales;
+        std::vector<std::int8_t> codes;  // Rows() * dimensions
+    };
+}
@@ -0,0 +1,267 @@
+#include "MemoryScoring.h"
+#include "Agent.h"
+#include "MemoryIndex.h"
+#include "VectorMath.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+#if defined(_M_X64) || defined(__x86_64__)
+    #define TESSERACT_X86_SIMD 1
+    #include <immintrin.h>
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+    #endif
+#endif
+
+// MSVC allows intrinsics in any function, GCC/Clang need the target attribute
+#if defined(TESSERACT_X86_SIMD) && (defined(__GNUC__) || defined(__clang__))
+    #define TESSERACT_AVX2_TARGET __attribute__((target("avx2,fma")))
+#else
+    #define TESSERACT_AVX2_TARGET
+#endif
+
+namespace TESSERACT::Agent::Scoring {
+    namespace {
+        // Taylor coefficients of 2^f = e^(f ln2) on [0, 1)
+        constexpr float kExp2C1 = 0.693147181f;
+        constexpr float kExp2C2 = 0.240226507f;
+        constexpr float kExp2C3 = 0.0555041087f;
+        constexpr float kExp2C4 = 0.00961812911f;
+        constexpr float kExp2C5 = 0.00133335581f;
+        constexpr float kExp2C6 = 0.000154035304f;
+
+#if defined(TESSERACT_X86_SIMD)
+        // 2^x for x <= 0: split into integer and fractional part, polynomial for
+        // the fraction, integer part goes straight into the exponent bits
+        TESSERACT_AVX2_TARGET __m256 Exp2AVX2(__m256 x) {
+            x = _mm256_max_ps(x, _mm256_set1_ps(-126.0f));
+            __m256 whole = _mm256_floor_ps(x);
+            __m256 f = _mm256_sub_ps(x, whole);
+
+            __m256 p = _mm256_set1_ps(kExp2C6);
+            p = _mm256_fmadd_ps(p, f, _mm256_set1_ps(kExp2C5));
+            p = _mm256_fmadd_ps(p, f, _mm256_set1_ps(kExp2C4));
+            p = _mm256_fmadd_ps(p, f, _mm256_set1_ps(kExp2C3));
+            p = _mm256_fmadd_ps(p, f, _mm256_set1_ps(kExp2C2));
+            p = _mm256_fmadd_ps(p, f, _mm256_set1_ps(kExp2C1));
+            p = _mm256_fmadd_ps(p, f, _mm256_set1_ps(1.0f));
+
+            __m256i exponent = _mm256_slli_epi32(_mm256_cvtps_epi32(whole), 23);
+            return _mm256_castsi256_ps(_mm256_add_epi32(_mm256_castps_si256(p), exponent));
+        }
+
+        TESSERACT_AVX2_TARGET void ScoreAVX2(const Columns& columns, const Weights& weights, float* scores) {
+            const std::size_t n = columns.Size();
+            const float* age = columns.ageHours.data();
+            const float* importance = columns.importance.data();
+            const float* relevance = columns.relevance.data();
+
+            const __m256 decay = _mm256_set1_ps(-1.0f / (std::max)(weights.halfLifeHours, 1e-3f));
+            const __m256 wRecency = _mm256_set1_ps(weights.recency);
+            const __m256 wImportance = _mm256_set1_ps(weights.importance);
+            const __m256 wRelevance = _mm256_set1_ps(weights.relevance);
+
+            std::size_t i = 0;
+            for (; i + 8 <= n; i += 8) {
+                __m256 recency = Exp2AVX2(_mm256_mul_ps(_mm256_loadu_ps(age + i), decay));
+                __m256 score = _mm256_mul_ps(wRecency, recency);
+                score = _mm256_fmadd_ps(wImportance, _mm256_loadu_ps(importance + i), score);
+                score = _mm256_fmadd_ps(wRelevance, _mm256_loadu_ps(relevance + i), score);
+                _mm256_storeu_ps(scores + i, score);
+            }
+
+            const float scalarDecay = -1.0f / (std::max)(weights.halfLifeHours, 1e-3f);
+            for (; i < n; i++) {
+                scores[i] = weights.recency * std::exp2(age[i] * scalarDecay) +
+                            weights.importance * importance[i] + weights.relevance * relevance[i];
+            }
+        }
+
+        TESSERACT_AVX2_TARGET std::int32_t HorizontalSum(__m256i v) {
+            __m128i lo = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+            lo = _mm_add_epi32(lo, _mm_shuffle_epi32(lo, 0x4E));
+            lo = _mm_add_epi32(lo, _mm_shuffle_epi32(lo, 0xB1));
+            return _mm_cvtsi128_si32(lo);
+        }
+
+        std::int32_t DotTail(const std::int8_t* a, const std::int8_t* b, std::size_t from, std::size_t n) {
+            std::int32_t sum = 0;
+            for (std::size_t d = from; d < n; d++) {
+                sum += static_cast<std::int32_t>(a[d]) * static_cast<std::int32_t>(b[d]);
+            }
+            return sum;
+        }
+
+        // 32 products per step: |q| as unsigned bytes times row bytes carrying q's sign. Codes
+        // stay within [-127, 127], so a pair sum (at most 2 * 127 * 127) cannot saturate int16
+        TESSERACT_AVX2_TARGET __m256i DotStep(__m256i acc, __m256i queryAbs, __m256i querySign, const std::int8_t* row) {
+            __m256i values = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row));
+            __m256i pairs = _mm256_maddubs_epi16(queryAbs, _mm256_sign_epi8(values, querySign));
+            return _mm256_add_epi32(acc, _mm256_madd_epi16(pairs, _mm256_set1_epi16(1)));
+        }
+
+        // Every row against one query, four rows per pass so each query block is loaded once for all four
+        TESSERACT_AVX2_TARGET void RelevanceInt8AVX2(const std::int8_t* query, float queryScale, const std::int8_t* codes,
+                                                     const float* scales, std::size_t count, std::size_t dimensions,
+                                                     float* out) {
+            const std::size_t blocks = dimensions / 32;
+            const std::size_t body = blocks * 32;
+            thread_local std::vector<std::int8_t> queryAbs;
+            queryAbs.resize(body);
+            for (std::size_t d = 0; d < body; d++) {
+                queryAbs[d] = static_cast<std::int8_t>(query[d] < 0 ? -query[d] : query[d]);
+            }
+
+            auto finish = [&](std::size_t i, std::int32_t dot) {
+                out[i] = std::clamp(queryScale * scales[i] * static_cast<float>(dot), 0.0f, 1.0f);
+            };
+
+            std::size_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                const std::int8_t* row = codes + i * dimensions;
+                __m256i acc[4] = {_mm256_setzero_si256(), _mm256_setzero_si256(), _mm256_setzero_si256(),
+                                  _mm256_setzero_si256()};
+                for (std::size_t b = 0; b < blocks; b++) {
+                    __m256i magnitude = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(queryAbs.data() + b * 32));
+                    __m256i sign = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(query + b * 32));
+                    for (std::size_t r = 0; r < 4; r++) {
+                        acc[r] = DotStep(acc[r], magnitude, sign, row + r * dimensions + b * 32);
+                    }
+                }
+                for (std::size_t r = 0; r < 4; r++) {
+                    finish(i + r, HorizontalSum(acc[r]) + DotTail(query, row + r * dimensions, body, dimensions));
+                }
+            }
+            for (; i < count; i++) {
+                const std::int8_t* row = codes + i * dimensions;
+                __m256i acc = _mm256_setzero_si256();
+                for (std::size_t b = 0; b < blocks; b++) {
+                    __m256i magnitude = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(queryAbs.data() + b * 32));
+                    __m256i sign = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(query + b * 32));
+                    acc = DotStep(acc, magnitude, sign, row + b * 32);
+                }
+                finish(i, HorizontalSum(acc) + DotTail(query, row, body, dimensions));
+            }
+        }
+
+        bool HasFMA() {
+    #if defined(_MSC_VER) && !defined(__clang__)
+            static const bool supported = [] {
+                int info[4] = {};
+                __cpuid(info, 1);
+                return (info[2] & (1 << 12)) != 0;
+            }();
+            return supported;
+    #else
+            return __builtin_cpu_supports("fma");
+    #endif
+        }
+#endif
+
+        void ScoreScalar(const Columns& columns, const Weights& weights, float* scores) {
+            const float decay = -1.0f / (std::max)(weights.halfLifeHours, 1e-3f);
+            for (std::size_t i = 0; i < columns.Size(); i++) {
+                scores[i] = weights.recency * std::exp2(columns.ageHours[i] * decay) +
+                            weights.importance * columns.importance[i] +
+                            weights.relevance * columns.relevance[i];
+            }
+        }
+    }
+
+    void Score(const Columns& columns, const Weights& weights, float* scores) {
+#if defined(TESSERACT_X86_SIMD)
+        if (VectorMath::HasAVX2() && HasFMA()) {
+            ScoreAVX2(columns, weights, scores);
+            return;
+        }
+#endif
+        ScoreScalar(columns, weights, scores);
+    }
+
+    void RelevanceInt8(const std::int8_t* query, float queryScale, const std::int8_t* codes, const float* scales,
+                       std::size_t count, std::size_t dimensions, float* out) {
+#if defined(TESSERACT_X86_SIMD)
+        if (VectorMath::HasAVX2()) {
+            RelevanceInt8AVX2(query, queryScale, codes, scales, count, dimensions, out);
+            return;
+        }
+#endif
+        for (std::size_t i = 0; i < count; i++) {
+            float cosine = queryScale * scales[i] *
+                static_cast<float>(VectorMath::DotInt8(query, codes + i * dimensions, dimensions));
+            out[i] = std::clamp(cosine, 0.0f, 1.0f);
+        }
+    }
+
+    void TopK(const float* scores, std::size_t count, std::size_t k, std::vector<std::uint32_t>& out) {
+        out.resize(count);
+        std::iota(out.begin(), out.end(), 0u);
+
+        k = (std::min)(k, count);
+        auto better = [scores](std::uint32_t a, std::uint32_t b) { return scores[a] > scores[b]; };
+        if (k < count) {
+            std::nth_element(out.begin(), out.begin() + k, out.end(), better);
+        }
+        out.resize(k);
+        std::sort(out.begin(), out.end(), better);
+    }
+
+    BenchmarkResult Benchmark(std::size_t memories, std::size_t k) {
+        constexpr int kRuns = 50;
+        const auto dimensions = static_cast<std::size_t>((std::max)(Memory::embeddingDimensions, 1));
+
+        // Synthetic agent: random embeddings in a vector index, ages up to a month, random importance
+        std::uint32_t state = 12345;
+        auto next = [&state]() {
+            state = state * 1664525u + 1013904223u;
+            return state >> 8;
+        };
+        auto randomEmbedding = [&](std::vector<float>& out) {
+            for (auto& value : out) value = static_cast<float>(next() % 2001) / 1000.0f - 1.0f;
+        };
+
+        // Built before timing; the same batch int8 scoring RetrieveRelevant does per turn
+        Memory::VectorIndex index(dimensions);
+        index.Resize(memories);
+        std::vector<float> embedding(dimensions);
+        for (std::size_t i = 0; i < memories; i++) {
+            randomEmbedding(embedding);
+            index.Set(i, embedding);
+        }
+
+        std::vector<float> query(dimensions);
+        randomEmbedding(query);
+
+        Columns columns;
+        columns.Resize(memories);
+        for (std::size_t i = 0; i < memories; i++) {
+            columns.ageHours[i] = static_cast<float>(next() % 720);
+            columns.importance[i] = static_cast<float>(next() % 1000) / 1000.0f;
+        }
+
+        Weights weights;
+        std::vector<float> scores(memories);
+        std::vector<std::uint32_t> top;
+
+        auto startTime = std::chrono::high_resolution_clock::now();
+        for (int run = 0; run < kRuns; run++) {
+            index.Relevance(query, columns.relevance);
+            Score(columns, weights, scores.data());
+            TopK(scores.data(), memories, k, top);
+        }
+        auto endTime = std::chrono::high_resolution_clock::now();
+
+        BenchmarkResult result;
+        result.memories = memories;
+        result.dimensions = dimensions;
+        result.microsecondsPerRanking = std::chrono::duration<double, std::micro>(endTime - startTime).count() / kRuns;
+        result.avx2 = VectorMath::HasAVX2();
+
+        logger::info("Scoring benchmark: {} memories ({} dims) ranked in {:.1f} microseconds per turn (AVX2: {})",
+            memories, dimensions, result.microsecondsPerRanking, result.avx2);
+        return result;
+    }
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Memory Scoring Overview
+ *
+ * Ranks every memory of an agent on every turn, the way generative agents do:
+ *
+ *     score = wRecency * 2^(-ageHours / halfLife) + wImportance * importance + wRelevance * relevance
+ *
+ * 1. Layout:
+ *    - Structure of arrays (age, importance, relevance) so the kernel streams
+ *      three contiguous float columns
+ *
+ * 2. Kernel:
+ *    - AVX2 path with a polynomial exp2 approximation (relative error ~2e-5,
+ *      plenty for ranking) and a scalar fallback using std::exp2
+ *    - Relevance is filled from int8 embedding codes in one batch over every
+ *      row of the agent's vector index (MemoryIndex.h); the AVX2 path does
+ *      32 products per instruction and four rows per pass
+ *
+ * 3. Selection:
+ *    - Partial top-k (nth_element, then only the k winners are sorted)
+ */
+
+namespace TESSERACT::Agent::Scoring {
+    struct Weights {
+        float recency = 1.0f;
+        float importance = 1.0f;
+        float relevance = 1.0f;
+        float halfLifeHours = 24.0f;
+    };
+
+    struct Columns {
+        std::vector<float> ageHours;
+        std::vector<float> importance;
+        std::vector<float> relevance;  // Expected in [0, 1]
+
+        void Resize(std::size_t count) {
+            ageHours.resize(count);
+            importance.resize(count);
+            relevance.assign(count, 0.0f);
+        }
+        std::size_t Size() const { return ageHours.size(); }
+    };
+
+    // scores must hold columns.Size() floats
+    void Score(const Columns& columns, const Weights& weights, float* scores);
+
+    // Cosine relevance from int8 codes (row-major, dimensions per row), clamped to [0, 1]
+    void RelevanceInt8(const std::int8_t* query, float queryScale, const std::int8_t* codes, const float* scales,
+                       std::size_t count, std::size_t dimensions, float* out);
+
+    // Indices of the k best scores, best first
+    void TopK(const float* scores, std::size_t count, std::size_t k, std::vector<std::uint32_t>& out);
+
+    // Full per-turn ranking as RetrieveRelevant runs it (index relevance, score, top-k),
+    // timed over synthetic memories
+    struct BenchmarkResult {
+        std::size_t memories = 0;
+        std::size_t dimensions = 0;
+        double microsecondsPerRanking = 0.0;
+        bool avx2 = false;
+    };
+    BenchmarkResult Benchmark(std::size_t memories = 10000, std::size_t k = 8);
+}
@@ -0,0 +1,301 @@
+#include "MemoryTiers.h"
+#include "Agent.h"
+#include "Compression.h"
+#include "Tasks.h"
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace TESSERACT::Agent::Memory::Tiers {
+    namespace {
+        constexpr std::size_t kBlockBytes = 64 * 1024;
+        constexpr std::size_t kCacheBlocks = 8;
+
+        const std::filesystem::path kSpillPath = "Data\\SKSE\\Plugins\\TESSERACT\\memory.spill";
+
+        enum class BlockState { Open, Warm, Cold };
+
+        struct Block {
+            BlockState state = BlockState::Open;
+            std::vector<std::uint8_t> data;  // Raw while open, compressed while warm, empty when cold
+            std::uint32_t rawSize = 0;
+            std::uint32_t compressedSize = 0;
+            std::uint64_t fileOffset = 0;
+            std::uint64_t liveBytes = 0;
+            std::uint64_t lastUse = 0;
+        };
+
+        struct CachedBlock {
+            std::uint32_t id = 0;
+            std::uint64_t lastUse = 0;
+            std::vector<std::uint8_t> raw;
+        };
+
+        struct Store {
+            std::mutex mutex;
+            std::unordered_map<std::uint32_t, Block> blocks;
+            std::uint32_t openBlock = 0;
+            std::uint32_t nextBlock = 1;
+            std::uint64_t clock = 0;
+
+            std::vector<CachedBlock> cache;
+
+            std::fstream spill;
+            std::uint64_t spillEnd = 0;
+
+            std::uint64_t warmBytes = 0;
+            std::uint64_t warmRawBytes = 0;
+            std::uint64_t coldBytes = 0;
+            std::size_t coldBlocks = 0;
+            std::uint64_t cacheHits = 0;
+            std::uint64_t cacheMisses = 0;
+            std::atomic<std::int64_t> hotBytes{0};
+        };
+
+        Store& GetStore() {
+            static Store store;
+            return store;
+        }
+
+        // Everything below expects the store mutex to be held
+
+        bool OpenSpill(Store& store) {
+            if (store.spill.is_open()) {
+                return true;
+            }
+            std::error_code error;
+            std::filesystem::create_directories(kSpillPath.parent_path(), error);
+            store.spill.open(kSpillPath, std::ios::binary | std::ios::in | std::ios::out | std::ios::trunc);
+            store.spillEnd = 0;
+            return store.spill.is_open();
+        }
+
+        void Spill(Store& store, Block& block) {
+            if (!OpenSpill(store)) {
+                return;  // Stay warm rather than lose the text
+            }
+
+            store.spill.seekp(static_cast<std::streamoff>(store.spillEnd));
+            store.spill.write(reinterpret_cast<const char*>(block.data.data()), block.compressedSize);
+            if (!store.spill) {
+                store.spill.clear();
+                return;
+            }
+
+            block.fileOffset = store.spillEnd;
+            store.spillEnd += block.compressedSize;
+            block.state = BlockState::Cold;
+            block.data.clear();
+            block.data.shrink_to_fit();
+
+            store.warmBytes -= block.compressedSize;
+            store.warmRawBytes -= block.rawSize;
+            store.coldBytes += block.compressedSize;
+            store.coldBlocks++;
+        }
+
+        void EnforceBudget(Store& store) {
+            const std::uint64_t budget = static_cast<std::uint64_t>((std::max)(Memory::warmBudgetMB, 0)) * 1024 * 1024;
+            while (store.warmBytes > budget) {
+                Block* oldest = nullptr;
+                for (auto& [id, block] : store.blocks) {
+                    if (block.state == BlockState::Warm && (!oldest || block.lastUse < oldest->lastUse)) {
+                        oldest = &block;
+                    }
+                }
+                if (!oldest) break;
+
+                auto before = store.warmBytes;
+                Spill(store, *oldest);
+                if (store.warmBytes == before) break;  // Spill failed
+            }
+        }
+
+        // Pool task for a full block: compresses outside the lock (the raw block
+        // stays readable meanwhile), then swaps it in unless it was freed
+        void Seal(std::uint32_t id) {
+            auto& store = GetStore();
+            std::vector<std::uint8_t> raw;
+            {
+                std::lock_guard lock(store.mutex);
+                auto it = store.blocks.find(id);
+                if (it == store.blocks.end() || it->second.state != BlockState::Open) return;
+                raw = it->second.data;
+            }
+
+            std::vector<std::uint8_t> compressed;
+            Utils::Compression::Compress(raw, compressed);
+            compressed.shrink_to_fit();
+
+            std::lock_guard lock(store.mutex);
+            auto it = store.blocks.find(id);
+            if (it == store.blocks.end() || it->second.state != BlockState::Open) return;
+
+            auto& block = it->second;
+            block.rawSize = static_cast<std::uint32_t>(raw.size());
+            block.compressedSize = static_cast<std::uint32_t>(compressed.size());
+            block.data = std::move(compressed);
+            block.state = BlockState::Warm;
+
+            store.warmBytes += block.compressedSize;
+            store.warmRawBytes += block.rawSize;
+            EnforceBudget(store);
+        }
+
+        const std::vector<std::uint8_t>* Decompressed(Store& store, std::uint32_t id, Block& block) {
+            for (auto& cached : store.cache) {
+                if (cached.id == id) {
+                    cached.lastUse = ++store.clock;
+                    store.cacheHits++;
+                    return &cached.raw;
+                }
+            }
+            store.cacheMisses++;
+
+            std::vector<std::uint8_t> compressed;
+            const std::vector<std::uint8_t>* source = &block.data;
+            if (block.state == BlockState::Cold) {
+                compressed.resize(block.compressedSize);
+                store.spill.seekg(static_cast<std::streamoff>(block.fileOffset));
+                store.spill.read(reinterpret_cast<char*>(compressed.data()), block.compressedSize);
+                if (!store.spill) {
+                    store.spill.clear();
+                    logger::error("Failed to read memory block {} from the spill file", id);
+                    return nullptr;
+                }
+                source = &compressed;
+            }
+
+            CachedBlock entry;
+            entry.id = id;
+            entry.lastUse = ++store.clock;
+            entry.raw.resize(block.rawSize);
+            if (!Utils::Compression::Decompress(*source, entry.raw)) {
+                logger::error("Memory block {} is corrupt", id);
+                return nullptr;
+            }
+
+            if (store.cache.size() < kCacheBlocks) {
+                store.cache.push_back(std::move(entry));
+                return &store.cache.back().raw;
+            }
+
+            auto* victim = &store.cache.front();
+            for (auto& cached : store.cache) {
+                if (cached.lastUse < victim->lastUse) victim = &cached;
+            }
+            *victim = std::move(entry);
+            return &victim->raw;
+        }
+    }
+
+    Handle Pack(std::string_view text) {
+        auto& store = GetStore();
+        std::lock_guard lock(store.mutex);
+
+        auto open = store.blocks.find(store.openBlock);
+        if (open != store.blocks.end() && !open->second.data.empty() &&
+            open->second.data.size() + text.size() > kBlockBytes) {
+            // Packing happens on the game thread too; compression and spilling do not
+            Tasks::Post(Tasks::Executor::Worker, [id = store.openBlock]() { Seal(id); });
+            open = store.blocks.end();
+        }
+        if (open == store.blocks.end()) {
+            store.openBlock = store.nextBlock++;
+            open = store.blocks.emplace(store.openBlock, Block{}).first;
+            open->second.data.reserve(kBlockBytes);
+        }
+
+        auto& block = open->second;
+        Handle handle{store.openBlock, static_cast<std::uint32_t>(block.data.size()), static_cast<std::uint32_t>(text.size())};
+        block.data.insert(block.data.end(), text.begin(), text.end());
+        block.liveBytes += text.size();
+        block.lastUse = ++store.clock;
+        return handle;
+    }
+
+    std::string Unpack(Handle handle) {
+        auto& store = GetStore();
+        std::lock_guard lock(store.mutex);
+
+        auto it = store.blocks.find(handle.block);
+        if (it == store.blocks.end()) {
+            return {};
+        }
+
+        auto& block = it->second;
+        block.lastUse = ++store.clock;
+
+        const std::vector<std::uint8_t>* raw = block.state == BlockState::Open ?
+            &block.data : Decompressed(store, handle.block, block);
+        if (!raw || static_cast<std::size_t>(handle.offset) + handle.length > raw->size()) {
+            return {};
+        }
+        return std::string(reinterpret_cast<const char*>(raw->data() + handle.offset), handle.length);
+    }
+
+    void Release(Handle handle) {
+        auto& store = GetStore();
+        std::lock_guard lock(store.mutex);
+
+        auto it = store.blocks.find(handle.block);
+        if (it == store.blocks.end()) {
+            return;
+        }
+
+        auto& block = it->second;
+        block.liveBytes -= (std::min)(block.liveBytes, static_cast<std::uint64_t>(handle.length));
+        if (block.liveBytes > 0) {
+            return;
+        }
+
+        // Last reference gone: free the block
+        if (handle.block == store.openBlock) {
+            block.data.clear();
+            return;
+        }
+        if (block.state == BlockState::Warm) {
+            store.warmBytes -= block.compressedSize;
+            store.warmRawBytes -= block.rawSize;
+        } else if (block.state == BlockState::Cold) {
+            store.coldBytes -= block.compressedSize;
+            store.coldBlocks--;
+        }
+        std::erase_if(store.cache, [&](const CachedBlock& cached) { return cached.id == handle.block; });
+        store.blocks.erase(it);
+
+        // Nothing left on disk, start the spill file over
+        if (store.coldBlocks == 0 && store.spillEnd > 0) {
+            store.spill.close();
+            OpenSpill(store);
+        }
+    }
+
+    void NoteHot(std::int64_t bytes) {
+        GetStore().hotBytes += bytes;
+    }
+
+    Stats GetStats() {
+        auto& store = GetStore();
+        std::lock_guard lock(store.mutex);
+
+        Stats stats;
+        stats.hotBytes = static_cast<std::uint64_t>((std::max)(store.hotBytes.load(), std::int64_t{0}));
+        stats.warmBytes = store.warmBytes;
+        stats.warmRawBytes = store.warmRawBytes;
+        stats.coldBytes = store.coldBytes;
+        stats.coldBlocks = store.coldBlocks;
+        stats.cacheHits = store.cacheHits;
+        stats.cacheMisses = store.cacheMisses;
+        for (const auto& [id, block] : store.blocks) {
+            if (block.state == BlockState::Warm) stats.warmBlocks++;
+            if (block.state == BlockState::Open) stats.warmBytes += block.data.size();
+        }
+        return stats;
+    }
+}
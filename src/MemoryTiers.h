@@ -0,0 +1,56 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/**
+ * Tiered Memory Storage Overview
+ *
+ * Keeps the text of old memories out of the resident set. One store is shared
+ * by every agent so the budget is per plugin, not per NPC.
+ *
+ * 1. Hot:
+ *    - The newest Memory::hotMemories memories of each agent (and all
+ *      summaries) keep their text in MemoryEntry::content
+ *
+ * 2. Warm:
+ *    - Older text is packed into 64 KB blocks; a full block is compressed
+ *      (Compression.h) by a pool task and kept in RAM, read raw until then
+ *
+ * 3. Cold:
+ *    - Once warm blocks exceed Memory::warmBudgetMB, the least recently used
+ *      ones are spilled to a scratch file and dropped from RAM
+ *
+ * Reads of warm and cold text go through a small LRU of decompressed blocks.
+ * A block is freed once every memory packed into it has been released.
+ */
+
+namespace TESSERACT::Agent::Memory::Tiers {
+    struct Handle {
+        std::uint32_t block = 0;  // 0 = not packed
+        std::uint32_t offset = 0;
+        std::uint32_t length = 0;
+
+        explicit operator bool() const { return block != 0; }
+    };
+
+    Handle Pack(std::string_view text);
+    std::string Unpack(Handle handle);
+    void Release(Handle handle);
+
+    // Hot text lives in the agents; they report it here for the stats
+    void NoteHot(std::int64_t bytes);
+
+    struct Stats {
+        std::uint64_t hotBytes = 0;
+        std::uint64_t warmBytes = 0;     // Compressed, in RAM (includes the open block)
+        std::uint64_t warmRawBytes = 0;  // What the warm blocks hold uncompressed
+        std::uint64_t coldBytes = 0;     // Compressed, on disk
+        std::size_t warmBlocks = 0;
+        std::size_t coldBlocks = 0;
+        std::uint64_t cacheHits = 0;
+        std::uint64_t cacheMisses = 0;
+    };
+    Stats GetStats();
+}
@@ -0,0 +1,108 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <utility>
+
+/**
+ * MPSC Queue Overview
+ *
+ * Bounded, lock-free queue for handing results from any number of threads to
+ * one consumer thread (see Inbox.h).
+ *
+ * 1. Layout:
+ *    - A power-of-two ring of cells, each with a sequence number telling
+ *      whose turn it is: seq == pos means free for the producer claiming pos,
+ *      seq == pos + 1 means filled for the consumer
+ *    - Producers claim positions with one CAS on the tail; the consumer owns
+ *      the head and never writes shared counters except the cell sequence
+ *
+ * 2. Full queue:
+ *    - TryPush() fails instead of growing; Push() yields until the consumer
+ *      frees a cell (the consumers here drain every frame)
+ */
+
+namespace TESSERACT::Agent {
+    template <class T, std::size_t Capacity>
+    class MpscQueue {
+        static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+    public:
+        MpscQueue() : cells(std::make_unique<Cell[]>(Capacity)) {
+            for (std::size_t i = 0; i < Capacity; i++) {
+                cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        MpscQueue(const MpscQueue&) = delete;
+        MpscQueue& operator=(const MpscQueue&) = delete;
+
+        // Any thread; false (value untouched) when full
+        bool TryPush(T&& value) {
+            auto position = tail.load(std::memory_order_relaxed);
+            while (true) {
+                auto& cell = cells[position & kMask];
+                auto sequence = cell.sequence.load(std::memory_order_acquire);
+                auto difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+                if (difference == 0) {
+                    if (tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                        cell.value = std::move(value);
+                        cell.sequence.store(position + 1, std::memory_order_release);
+                        return true;
+                    }
+                } else if (difference < 0) {
+                    return false;
+                } else {
+                    position = tail.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        void Push(T value) {
+            while (!TryPush(std::move(value))) {
+                std::this_thread::yield();
+            }
+        }
+
+        // Consumer thread only
+        bool TryPop(T& out) {
+            auto& cell = cells[head & kMask];
+            auto sequence = cell.sequence.load(std::memory_order_acquire);
+            if (sequence != head + 1) {
+                return false;
+            }
+            out = std::move(cell.value);
+            cell.value = T();
+            cell.sequence.store(head + Capacity, std::memory_order_release);
+            head++;
+            return true;
+        }
+
+        // Consumer thread only; at most max items, returns how many
+        template <class F>
+        std::size_t Drain(F&& fn, std::size_t max) {
+            std::size_t count = 0;
+            T value;
+            while (count < max && TryPop(value)) {
+                fn(std::move(value));
+                count++;
+            }
+            return count;
+        }
+
+    private:
+        static constexpr std::size_t kMask = Capacity - 1;
+        static constexpr std::size_t kLine = 64;
+
+        struct alignas(kLine) Cell {
+            std::atomic<std::size_t> sequence;
+            T value;
+        };
+
+        std::unique_ptr<Cell[]> cells;
+        alignas(kLine) std::atomic<std::size_t> tail{0};
+        alignas(kLine) std::size_t head = 0;
+    };
+}
@@ -1,9 +1,13 @@
 #pragma once
 #include "RE/Skyrim.h"
 #include "SKSE/SKSE.h"
+#include "ActionExecutor.h"
 #include "AgentFunctions.h"
+#include "AgentManager.h"
 #include "HoldingQuestFunctions.h"
+#include "PersonaCache.h"
 #include "Utils.h"
+#include "WorldEvents.h"
 
 namespace TESSERACT {
     // Register all Papyrus functions
@@ -28,6 +32,21 @@ namespace TESSERACT {
         // Utility Functions
         vm->RegisterFunction("GetSpell", "TESSERACT", Utils::GetSpellPapyrus);
         vm->RegisterFunction("ForceRefToAlias", "TESSERACT", Utils::ForceRefToAliasPapyrus);
+
+        // World Event Functions
+        vm->RegisterFunction("BroadcastEvent", "TESSERACT", Agent::WorldEvents::BroadcastEventPapyrus);
+
+        // Persona Functions
+        vm->RegisterFunction("InvalidatePersona", "TESSERACT", Agent::Persona::InvalidatePersonaPapyrus);
+
+        // Agent Manager Functions
+        vm->RegisterFunction("GetAgent", "TESSERACT", Agent::Manager::GetAgentPapyrus);
+        vm->RegisterFunction("IsAgentValid", "TESSERACT", Agent::Manager::IsAgentValidPapyrus);
+
+        // Action Executor Functions
+        vm->RegisterFunction("QueueSpell", "TESSERACT", Agent::Actions::QueueSpellPapyrus);
+        vm->RegisterFunction("QueueTravel", "TESSERACT", Agent::Actions::QueueTravelPapyrus);
+        vm->RegisterFunction("QueueAcquire", "TESSERACT", Agent::Actions::QueueAcquirePapyrus);
         
         return true;
     }
@@ -0,0 +1,162 @@
+#include "Persistence.h"
+#include "Agent.h"
+#include <chrono>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace TESSERACT::Agent::Persistence {
+    namespace {
+        struct Store {
+            std::mutex mutex;
+            std::unordered_map<RE::FormID, std::vector<std::uint8_t>> blobs;  // Last serialized state per agent
+            std::unordered_set<SubAgent*> live;
+        };
+
+        Store& GetStore() {
+            static Store store;
+            return store;
+        }
+
+        RE::FormID AgentFormID(const SubAgent& agent) {
+            auto* npc = agent.GetNPC();
+            return npc ? npc->GetFormID() : 0;
+        }
+
+        void OnSave(SKSE::SerializationInterface* serde) {
+            auto startTime = std::chrono::high_resolution_clock::now();
+            auto& store = GetStore();
+            std::lock_guard lock(store.mutex);
+
+            // Only agents that changed since their last serialization cost anything
+            std::size_t serialized = 0;
+            for (auto* agent : store.live) {
+                auto formId = AgentFormID(*agent);
+                if (formId == 0) continue;
+
+                std::vector<std::uint8_t> blob;
+                if (agent->SerializeIfDirty(blob)) {
+                    store.blobs[formId] = std::move(blob);
+                    serialized++;
+                }
+            }
+
+            for (const auto& [formId, blob] : store.blobs) {
+                auto size = static_cast<std::uint32_t>(blob.size());
+                if (!serde->OpenRecord(kAgentRecord, kAgentRecordVersion) ||
+                    !serde->WriteRecordData(&formId, sizeof(formId)) ||
+                    !serde->WriteRecordData(&size, sizeof(size)) ||
+                    !serde->WriteRecordData(blob.data(), size)) {
+                    logger::error("Failed to write agent record for {:08X}", formId);
+                }
+            }
+
+            auto endTime = std::chrono::high_resolution_clock::now();
+            auto duration = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
+            logger::info("Saved {} agents ({} re-serialized) in {} microseconds", store.blobs.size(), serialized, duration.count());
+        }
+
+        void OnLoad(SKSE::SerializationInterface* serde) {
+            auto startTime = std::chrono::high_resolution_clock::now();
+            auto& store = GetStore();
+            std::lock_guard lock(store.mutex);
+            store.blobs.clear();
+
+            std::uint32_t type;
+            std::uint32_t version;
+            std::uint32_t length;
+            while (serde->GetNextRecordInfo(type, version, length)) {
+                if (type != kAgentRecord || version > kAgentRecordVersion) {
+                    logger::warn("Skipping unknown co-save record {:08X} (version {})", type, version);
+                    continue;
+                }
+
+                RE::FormID formId;
+                std::uint32_t size;
+                if (length < sizeof(formId) + sizeof(size) ||
+                    serde->ReadRecordData(&formId, sizeof(formId)) != sizeof(formId) ||
+                    serde->ReadRecordData(&size, sizeof(size)) != sizeof(size) ||
+                    size != length - sizeof(formId) - sizeof(size)) {
+                    logger::error("Corrupt agent record, skipping");
+                    continue;
+                }
+
+                // Keep the raw bytes; they are parsed when the agent is first used
+                std::vector<std::uint8_t> blob(size);
+                if (serde->ReadRecordData(blob.data(), size) != size) {
+                    logger::error("Truncated agent record for {:08X}, skipping", formId);
+                    continue;
+                }
+
+                RE::FormID resolved;
+                if (!serde->ResolveFormID(formId, resolved)) {
+                    continue;  // Plugin that owned the NPC was removed
+                }
+                store.blobs[resolved] = std::move(blob);
+            }
+
+            auto endTime = std::chrono::high_resolution_clock::now();
+            auto duration = std::chrono::duration_cast<std::chrono::microseconds>(endTime - startTime);
+            logger::info("Loaded {} agent records in {} microseconds", store.blobs.size(), duration.count());
+        }
+
+        void OnRevert(SKSE::SerializationInterface*) {
+            auto& store = GetStore();
+            std::lock_guard lock(store.mutex);
+
+            // Agents still alive belong to the old session and must not write into the new one
+            store.blobs.clear();
+            store.live.clear();
+        }
+    }
+
+    bool Register() {
+        auto* serde = SKSE::GetSerializationInterface();
+        if (!serde) {
+            return false;
+        }
+
+        serde->SetUniqueID(kUniqueID);
+        serde->SetSaveCallback(OnSave);
+        serde->SetLoadCallback(OnLoad);
+        serde->SetRevertCallback(OnRevert);
+        return true;
+    }
+
+    void Attach(SubAgent& agent) {
+        auto& store = GetStore();
+        std::lock_guard lock(store.mutex);
+        store.live.insert(&agent);
+
+        auto formId = AgentFormID(agent);
+        auto it = store.blobs.find(formId);
+        if (formId == 0 || it == store.blobs.end()) {
+            return;
+        }
+
+        if (!agent.Deserialize(it->second)) {
+            logger::error("Failed to restore agent {:08X}, starting fresh", formId);
+            store.blobs.erase(it);
+        }
+    }
+
+    void Detach(SubAgent& agent) {
+        auto& store = GetStore();
+        std::lock_guard lock(store.mutex);
+        if (store.live.erase(&agent) == 0) {
+            return;
+        }
+
+        auto formId = AgentFormID(agent);
+        std::vector<std::uint8_t> blob;
+        if (formId != 0 && agent.SerializeIfDirty(blob)) {
+            store.blobs[formId] = std::move(blob);
+        }
+    }
+
+    std::size_t StoredAgentCount() {
+        auto& store = GetStore();
+        std::lock_guard lock(store.mutex);
+        return store.blobs.size();
+    }
+}
@@ -0,0 +1,107 @@
+#pragma once
+#include "RE/Skyrim.h"
+#include "SKSE/SKSE.h"
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Agent Persistence Overview
+ *
+ * Agent memories live in the SKSE co-save so NPCs remember the player across
+ * saves and loads.
+ *
+ * 1. Format:
+ *    - One 'AGNT' record per agent: FormID, blob length, blob
+ *    - The blob is the agent's own versioned binary (SubAgent::Serialize), so
+ *      the record layout never has to change when the agent state does
+ *
+ * 2. Dirty-only writes:
+ *    - Every agent's last blob is cached here; on save only agents that changed
+ *      since their last serialization are serialized again, everyone else is a
+ *      straight copy of the cached bytes (SKSE rewrites the whole co-save, so
+ *      the bytes themselves still have to go out)
+ *
+ * 3. Lazy loads:
+ *    - The load callback only resolves FormIDs and keeps the raw blobs
+ *    - A blob is parsed when its agent is created (Attach), not on the load screen
+ */
+
+namespace TESSERACT::Agent {
+    class SubAgent;
+}
+
+namespace TESSERACT::Agent::Persistence {
+    constexpr std::uint32_t kUniqueID = 'TSRC';
+    constexpr std::uint32_t kAgentRecord = 'AGNT';
+    constexpr std::uint32_t kAgentRecordVersion = 1;
+
+    // Registers the co-save callbacks, call once from plugin load
+    bool Register();
+
+    // Live agents: Attach restores saved state, Detach stashes it
+    void Attach(SubAgent& agent);
+    void Detach(SubAgent& agent);
+
+    // Stored agents, for the dashboard and diagnostics
+    std::size_t StoredAgentCount();
+
+    // Little-endian binary helpers shared by the serialized formats
+    class BinaryWriter {
+    public:
+        explicit BinaryWriter(std::vector<std::uint8_t>& out) : out(out) {}
+
+        template <class T>
+        void Write(T value) {
+            static_assert(std::is_trivially_copyable_v<T>);
+            auto bytes = reinterpret_cast<const std::uint8_t*>(&value);
+            out.insert(out.end(), bytes, bytes + sizeof(T));
+        }
+
+        template <class Length = std::uint32_t>
+        void WriteString(std::string_view text) {
+            Write(static_cast<Length>(text.size()));
+            out.insert(out.end(), text.begin(), text.end());
+        }
+
+    private:
+        std::vector<std::uint8_t>& out;
+    };
+
+    class BinaryReader {
+    public:
+        explicit BinaryReader(std::span<const std::uint8_t> data) : data(data) {}
+
+        template <class T>
+        bool Read(T& value) {
+            static_assert(std::is_trivially_copyable_v<T>);
+            if (data.size() - offset < sizeof(T)) {
+                return false;
+            }
+            std::memcpy(&value, data.data() + offset, sizeof(T));
+            offset += sizeof(T);
+            return true;
+        }
+
+        template <class Length = std::uint32_t>
+        bool ReadString(std::string& text) {
+            Length length;
+            if (!Read(length) || data.size() - offset < length) {
+                return false;
+            }
+            text.assign(reinterpret_cast<const char*>(data.data() + offset), length);
+            offset += length;
+            return true;
+        }
+
+        bool AtEnd() const { return offset == data.size(); }
+
+    private:
+        std::span<const std::uint8_t> data;
+        std::size_t offset = 0;
+    };
+}
@@ -0,0 +1,120 @@
+#include "PersonaCache.h"
+#include "Embedding.h"
+#include "PromptTemplates.h"
+#include "Tokenizer.h"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+
+namespace TESSERACT::Agent::Persona {
+    namespace {
+        struct State {
+            std::mutex mutex;
+            std::unordered_map<RE::FormID, std::uint32_t> stamps;
+            std::atomic<std::uint32_t> counter{1};
+            std::atomic<std::uint32_t> allStamp{1};  // Every NPC is at least this new
+        };
+
+        State& GetState() {
+            static State state;
+            return state;
+        }
+
+        class EventSink : public RE::BSTEventSink<RE::TESActorLocationChangeEvent>,
+                          public RE::BSTEventSink<RE::TESSwitchRaceCompleteEvent> {
+        public:
+            static EventSink* GetSingleton() {
+                static EventSink singleton;
+                return &singleton;
+            }
+
+            RE::BSEventNotifyControl ProcessEvent(const RE::TESActorLocationChangeEvent* event,
+                                                  RE::BSTEventSource<RE::TESActorLocationChangeEvent>*) override {
+                if (event && event->actor) {
+                    Invalidate(event->actor->GetFormID());
+                }
+                return RE::BSEventNotifyControl::kContinue;
+            }
+
+            RE::BSEventNotifyControl ProcessEvent(const RE::TESSwitchRaceCompleteEvent* event,
+                                                  RE::BSTEventSource<RE::TESSwitchRaceCompleteEvent>*) override {
+                if (event && event->subject) {
+                    Invalidate(event->subject->GetFormID());
+                }
+                return RE::BSEventNotifyControl::kContinue;
+            }
+        };
+    }
+
+    void Register() {
+        auto* events = RE::ScriptEventSourceHolder::GetSingleton();
+        if (!events) {
+            logger::error("Script event source unavailable, personas will only refresh on load");
+            return;
+        }
+        events->AddEventSink<RE::TESActorLocationChangeEvent>(EventSink::GetSingleton());
+        events->AddEventSink<RE::TESSwitchRaceCompleteEvent>(EventSink::GetSingleton());
+        logger::info("Persona cache listening for location and race changes");
+    }
+
+    void Invalidate(RE::FormID formId) {
+        auto& state = GetState();
+        auto stamp = ++state.counter;
+        std::lock_guard lock(state.mutex);
+        state.stamps[formId] = stamp;
+    }
+
+    void InvalidateAll() {
+        auto& state = GetState();
+        state.allStamp.store(++state.counter);
+
+        // Per-NPC stamps are now all older than allStamp
+        std::lock_guard lock(state.mutex);
+        state.stamps.clear();
+    }
+
+    std::uint32_t Generation(RE::FormID formId) {
+        auto& state = GetState();
+        std::uint32_t generation = state.allStamp.load();
+        std::lock_guard lock(state.mutex);
+        if (auto it = state.stamps.find(formId); it != state.stamps.end()) {
+            generation = (std::max)(generation, it->second);
+        }
+        return generation;
+    }
+
+    bool Refresh(const Snapshots::ActorSnapshot& actor, Block& block) {
+        auto generation = actor.formId ? Generation(actor.formId) : 1;
+        if (block.generation != 0 && block.generation >= generation) {
+            return false;
+        }
+
+        // Read before rendering: an event arriving meanwhile must still win next time.
+        // A snapshot that was never captured is rendered but not kept
+        block.generation = actor.frame ? generation : 0;
+
+        thread_local Prompts::SlotValues slots;
+        Prompts::FillSlots(actor, slots,
+            Prompts::Get(Prompts::Section::World).Slots() | Prompts::Get(Prompts::Section::Persona).Slots());
+        const auto& world = Prompts::Render(Prompts::Section::World, slots);
+        const auto& persona = Prompts::Render(Prompts::Section::Persona, slots);
+
+        auto hash = Embedding::ContentHash(world) * 31 + Embedding::ContentHash(persona);
+        if (hash == block.hash) {
+            return false;
+        }
+
+        block.world = world;
+        block.persona = persona;
+        block.hash = hash;
+        block.tokens = Tokenizer::CountMessage(world) + Tokenizer::CountMessage(persona);
+        return true;
+    }
+
+    void __stdcall InvalidatePersonaPapyrus(RE::StaticFunctionTag*, RE::Actor* actor) {
+        if (actor) {
+            Invalidate(actor->GetFormID());
+        }
+    }
+}
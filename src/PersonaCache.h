@@ -0,0 +1,51 @@
+#pragma once
+#include "RE/Skyrim.h"
+#include "ActorSnapshot.h"
+#include <cstdint>
+#include <string>
+
+/**
+ * Persona Cache Overview
+ *
+ * The world and persona sections of the prompt (see PromptTemplates.h) almost
+ * never change, so each agent keeps them rendered and only rebuilds them when
+ * the game tells us something relevant happened.
+ *
+ * 1. Generations:
+ *    - Invalidating an NPC stamps it with a new value from a global counter;
+ *      a cached block is stale when the NPC's stamp is newer than the block
+ *    - InvalidateAll() moves every NPC forward at once (game load, new templates)
+ *
+ * 2. Sources:
+ *    - Location changes and race switches, from script event sinks
+ *    - Faction and relationship changes have no engine event; scripts that
+ *      change them call TESSERACT.InvalidatePersona(akActor)
+ *
+ * 3. Rebuild:
+ *    - Re-renders the two sections and compares content hashes, so an event
+ *      that does not affect the text keeps the prompt prefix byte-identical
+ */
+
+namespace TESSERACT::Agent::Persona {
+    // Rendered stable prompt sections of one agent
+    struct Block {
+        std::string world;
+        std::string persona;
+        std::uint64_t hash = 0;        // Of world + persona
+        std::uint32_t tokens = 0;      // Both sections as chat messages
+        std::uint32_t generation = 0;  // 0 = never built
+    };
+
+    // Startup: event sinks (call once the data is loaded)
+    void Register();
+
+    void Invalidate(RE::FormID formId);
+    void InvalidateAll();
+    std::uint32_t Generation(RE::FormID formId);
+
+    // Rebuilds the block if the NPC was invalidated since it was built; true if the text changed
+    bool Refresh(const Snapshots::ActorSnapshot& actor, Block& block);
+
+    // Papyrus: after SetFactionRank/SetRelationshipRank and the like
+    void __stdcall InvalidatePersonaPapyrus(RE::StaticFunctionTag*, RE::Actor* actor);
+}
@@ -0,0 +1,183 @@
+#include "PromptTemplates.h"
+#include "WorldContext.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <nlohmann/json.hpp>
+
+namespace TESSERACT::Agent::Prompts {
+    namespace {
+        const std::filesystem::path kOverridePath = "Data\\SKSE\\Plugins\\TESSERACT\\prompts.json";
+
+        constexpr std::array<std::string_view, static_cast<std::size_t>(Slot::Count)> kSlotNames = {
+            "name", "race", "location", "region", "time", "weather", "state"
+        };
+
+        constexpr std::array<std::string_view, static_cast<std::size_t>(Section::Count)> kSectionNames = {
+            "world", "persona", "state"
+        };
+
+        constexpr std::array<std::string_view, static_cast<std::size_t>(Section::Count)> kDefaults = {
+            // World
+            "You are a character living in the world of Skyrim. Maintain character and speak naturally. "
+            "You have your own goals, personality, and daily routine. "
+            "Keep responses concise and relevant to your character.",
+            // Persona
+            "You are {name}, a {race}.",
+            // State
+            "Current state: {state}\n"
+            "Location: {location}\n"
+            "Region: {region}\n"
+            "Time: {time}\n"
+            "Weather: {weather}"
+        };
+
+        std::array<Template, static_cast<std::size_t>(Section::Count)>& Templates() {
+            static std::array<Template, static_cast<std::size_t>(Section::Count)> templates = [] {
+                std::array<Template, static_cast<std::size_t>(Section::Count)> parsed;
+                for (std::size_t i = 0; i < parsed.size(); i++) {
+                    parsed[i] = Template::Parse(kDefaults[i]);
+                }
+                return parsed;
+            }();
+            return templates;
+        }
+    }
+
+    Template Template::Parse(std::string_view text) {
+        Template result;
+        auto addLiteral = [&](std::string_view literal) {
+            if (literal.empty()) return;
+            // Merge with the previous literal run
+            if (!result.segments.empty() && result.segments.back().slot == Slot::Count) {
+                result.segments.back().length += static_cast<std::uint32_t>(literal.size());
+            } else {
+                result.segments.push_back({static_cast<std::uint32_t>(result.literals.size()),
+                                           static_cast<std::uint32_t>(literal.size()), Slot::Count});
+            }
+            result.literals += literal;
+        };
+        auto addText = [&](std::string_view text) {
+            // "}}" is a literal brace, like "{{"
+            for (auto close = text.find("}}"); close != std::string_view::npos; close = text.find("}}")) {
+                addLiteral(text.substr(0, close + 1));
+                text.remove_prefix(close + 2);
+            }
+            addLiteral(text);
+        };
+
+        std::size_t i = 0;
+        while (i < text.size()) {
+            auto open = text.find('{', i);
+            if (open == std::string_view::npos) {
+                addText(text.substr(i));
+                break;
+            }
+            addText(text.substr(i, open - i));
+
+            if (open + 1 < text.size() && text[open + 1] == '{') {
+                addLiteral("{");
+                i = open + 2;
+                continue;
+            }
+
+            auto close = text.find('}', open);
+            if (close == std::string_view::npos) {
+                addText(text.substr(open));
+                break;
+            }
+
+            auto name = text.substr(open + 1, close - open - 1);
+            auto slot = std::find(kSlotNames.begin(), kSlotNames.end(), name);
+            if (slot == kSlotNames.end()) {
+                logger::warn("Unknown prompt slot {{{}}}, kept as text", name);
+                addLiteral(text.substr(open, close - open + 1));
+            } else {
+                auto index = static_cast<std::uint32_t>(slot - kSlotNames.begin());
+                result.segments.push_back({0, 0, static_cast<Slot>(index)});
+                result.slots |= 1u << index;
+            }
+            i = close + 1;
+        }
+        return result;
+    }
+
+    void Template::Render(const SlotValues& values, std::string& out) const {
+        for (const auto& segment : segments) {
+            if (segment.slot == Slot::Count) {
+                out.append(literals, segment.offset, segment.length);
+            } else {
+                out += values[static_cast<std::size_t>(segment.slot)];
+            }
+        }
+    }
+
+    void Initialize() {
+        auto& templates = Templates();
+
+        std::ifstream file(kOverridePath);
+        if (!file.is_open()) {
+            return;
+        }
+
+        auto overrides = nlohmann::json::parse(file, nullptr, false);
+        if (overrides.is_discarded() || !overrides.is_object()) {
+            logger::error("Could not parse {}, using the built-in prompts", kOverridePath.string());
+            return;
+        }
+
+        for (std::size_t i = 0; i < kSectionNames.size(); i++) {
+            std::string key(kSectionNames[i]);
+            if (overrides.contains(key) && overrides[key].is_string()) {
+                templates[i] = Template::Parse(overrides[key].get<std::string>());
+                logger::info("Using custom {} prompt", key);
+            }
+        }
+    }
+
+    const Template& Get(Section section) {
+        return Templates()[static_cast<std::size_t>(section)];
+    }
+
+    void FillSlots(const Snapshots::ActorSnapshot& actor, SlotValues& values, SlotMask mask) {
+        auto wants = [mask](Slot slot) { return (mask & (1u << static_cast<std::uint32_t>(slot))) != 0; };
+        auto set = [&](Slot slot, std::string_view value) {
+            values[static_cast<std::size_t>(slot)].assign(value);
+        };
+
+        if (!actor.formId) {
+            for (auto& value : values) value.clear();
+            return;
+        }
+
+        if (wants(Slot::Name)) {
+            set(Slot::Name, actor.Name());
+        }
+        if (wants(Slot::Race)) {
+            set(Slot::Race, actor.Race());
+        }
+        if (wants(Slot::Location)) {
+            set(Slot::Location, actor.Location());
+        }
+        // Shared by every agent, sampled once per frame on the game thread
+        if (wants(Slot::Region) || wants(Slot::Time) || wants(Slot::Weather)) {
+            auto world = WorldContext::Current();
+            if (wants(Slot::Region)) set(Slot::Region, world->region);
+            if (wants(Slot::Time)) set(Slot::Time, world->time);
+            if (wants(Slot::Weather)) set(Slot::Weather, world->weather);
+        }
+        if (wants(Slot::State)) {
+            set(Slot::State, actor.inCombat ? "In Combat!" :
+                             actor.alarmed ? "Alarmed" :
+                             actor.sneaking ? "Sneaking" : "Normal");
+        }
+    }
+
+    const std::string& Render(Section section, const SlotValues& values) {
+        thread_local std::array<std::string, static_cast<std::size_t>(Section::Count)> buffers;
+        auto& buffer = buffers[static_cast<std::size_t>(section)];
+        buffer.clear();  // Keeps the capacity from the last render
+        Get(section).Render(values, buffer);
+        return buffer;
+    }
+}
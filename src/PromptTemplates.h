@@ -0,0 +1,83 @@
+#pragma once
+#include "RE/Skyrim.h"
+#include "ActorSnapshot.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * Prompt Templates Overview
+ *
+ * The system prompt used to be rebuilt with std::format on every request, with
+ * volatile state (combat, location, time) in the very first message, which
+ * defeats provider and local-server prefix caches on every turn.
+ *
+ * 1. Templates:
+ *    - Parsed once at startup into literal runs and {slot} references
+ *      ("{{" and "}}" are literal braces); rendering appends into a reused buffer
+ *    - Built-in defaults, overridable per section in
+ *      Data\SKSE\Plugins\TESSERACT\prompts.json ({"world": ..., "persona": ..., "state": ...})
+ *
+ * 2. Sections, most stable first (this is also the message order):
+ *    - World: shared rules, identical for every NPC and every turn
+ *    - Persona: who this NPC is, stable per NPC
+ *    - (memories and conversation history, see PrepareContext)
+ *    - State: what is going on right now, last so it never breaks the prefix
+ */
+
+namespace TESSERACT::Agent::Prompts {
+    enum class Slot : std::uint8_t {
+        Name,
+        Race,
+        Location,
+        Region,
+        Time,
+        Weather,
+        State,
+        Count
+    };
+    using SlotValues = std::array<std::string, static_cast<std::size_t>(Slot::Count)>;
+    using SlotMask = std::uint32_t;  // Bit per Slot
+    constexpr SlotMask kAllSlots = (1u << static_cast<std::uint32_t>(Slot::Count)) - 1;
+
+    class Template {
+    public:
+        static Template Parse(std::string_view text);
+
+        // Appends the filled template to out
+        void Render(const SlotValues& values, std::string& out) const;
+        SlotMask Slots() const { return slots; }
+
+    private:
+        struct Segment {
+            std::uint32_t offset;  // Into literals (literal segments only)
+            std::uint32_t length;
+            Slot slot;             // Slot::Count = literal
+        };
+
+        std::string literals;
+        std::vector<Segment> segments;
+        SlotMask slots = 0;
+    };
+
+    enum class Section : std::uint8_t {
+        World,
+        Persona,
+        State,
+        Count
+    };
+
+    // Startup: parses the templates (built-in, then prompts.json overrides)
+    void Initialize();
+    const Template& Get(Section section);
+
+    // Slot values from snapshots only (safe on any thread); only the slots in mask
+    // are filled, pass Get(section).Slots() to fill one section
+    void FillSlots(const Snapshots::ActorSnapshot& actor, SlotValues& values, SlotMask mask = kAllSlots);
+
+    // Renders one section into a per-thread buffer that is reused across calls
+    const std::string& Render(Section section, const SlotValues& values);
+}
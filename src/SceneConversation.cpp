@@ -0,0 +1,358 @@
+#include "SceneConversation.h"
+#include "Agent.h"
+#include "AgentManager.h"
+#include "PromptTemplates.h"
+#include "Tokenizer.h"
+#include "UI.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <unordered_map>
+
+namespace TESSERACT::Agent::Scenes {
+    namespace {
+        using Clock = std::chrono::steady_clock;
+
+        constexpr std::uint32_t kSegmentTokens = 600;
+        constexpr float kLineImportance = 0.2f;
+        constexpr auto kRestTime = std::chrono::minutes(2);  // Before the same NPC starts another scene
+
+        struct Member {
+            AgentHandle handle;
+            RE::FormID formId = 0;
+            std::string name;
+        };
+
+        struct Line {
+            std::size_t speaker = 0;  // Into Scene::members
+            std::string text;
+        };
+
+        struct Scene {
+            std::uint32_t id = 0;
+            std::vector<Member> members;
+            std::deque<Line> queued;
+            std::deque<std::string> transcript;  // "Name: line", last kTranscriptLines
+            Clock::time_point nextLine;
+            std::uint32_t segments = 0;          // Received so far
+            std::size_t spoken = 0;
+            bool requesting = false;
+            bool finishing = false;              // No more segments, play out what is queued
+        };
+
+        // Game thread only, except the published count
+        struct State {
+            std::vector<Scene> scenes;
+            std::unordered_map<RE::FormID, Clock::time_point> resting;
+            std::uint32_t nextId = 1;
+            std::uint64_t frame = 0;
+            std::atomic<std::size_t> active{0};
+        };
+
+        State& GetState() {
+            static State state;
+            return state;
+        }
+
+        struct Segment {
+            std::vector<Line> lines;
+            bool end = true;
+        };
+
+        bool SameName(std::string_view a, std::string_view b) {
+            return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+                return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+            });
+        }
+
+        float Distance(const Snapshots::ActorSnapshot& a, const Snapshots::ActorSnapshot& b) {
+            auto dx = a.position[0] - b.position[0];
+            auto dy = a.position[1] - b.position[1];
+            auto dz = a.position[2] - b.position[2];
+            return std::sqrt(dx * dx + dy * dy + dz * dz);
+        }
+
+        // Near, calm and not in a chat: Focus is the tier of agents the player is talking to
+        bool CanTalk(SubAgent& agent, Snapshots::ActorSnapshot& out) {
+            return agent.ReadSnapshot(out) && out.loaded && !out.dead && !out.inCombat && !out.alarmed &&
+                !out.Name().empty() && agent.lod.tier.load(std::memory_order_relaxed) == Lod::Tier::Near;
+        }
+
+        // Worker: one completion for the next stretch of the scene
+        Segment Generate(const std::vector<Snapshots::ActorSnapshot>& speakers, const std::vector<std::string>& transcript,
+                         bool last, const std::string& model) {
+            Prompts::SlotValues slots;
+            Prompts::FillSlots(speakers.front(), slots, Prompts::Get(Prompts::Section::World).Slots());
+            std::string world = Prompts::Render(Prompts::Section::World, slots);
+
+            std::string names;
+            std::string people;
+            auto personaSlots = Prompts::Get(Prompts::Section::Persona).Slots() | Prompts::Get(Prompts::Section::State).Slots();
+            for (const auto& speaker : speakers) {
+                Prompts::FillSlots(speaker, slots, personaSlots);
+                names += names.empty() ? "" : ", ";
+                names += speaker.Name();
+                people += std::format("## {}\n{}\n{}\n\n", speaker.Name(), Prompts::Render(Prompts::Section::Persona, slots),
+                                      Prompts::Render(Prompts::Section::State, slots));
+            }
+
+            auto instructions = std::format(
+                "The people described below are standing together and talking among themselves; the player is not part "
+                "of this conversation. Continue it with the next {} lines, in character, short and natural, each spoken "
+                "by one of: {}. Answer with JSON only: {{\"lines\": [{{\"speaker\": \"<name>\", \"line\": \"<spoken words>\"}}], "
+                "\"end\": <true if the conversation is winding down>}}.", kSegmentLines, names);
+
+            std::string history = transcript.empty() ? std::string("They have just come together; someone starts talking.")
+                                                   : "The conversation so far:\n";
+            for (const auto& line : transcript) {
+                history += line + "\n";
+            }
+            if (last) {
+                history += "\nBring the conversation to a natural close.";
+            }
+
+            nlohmann::json request = {
+                {"model", model},
+                {"messages", nlohmann::json::array({
+                    {{"role", "system"}, {"content", world}},
+                    {{"role", "system"}, {"content", instructions}},
+                    {{"role", "system"}, {"content", people}},
+                    {{"role", "user"}, {"content", history}}
+                })},
+                {"max_tokens", kSegmentTokens},
+                {"response_format", {{"type", "json_object"}}}
+            };
+
+            Segment segment;
+            auto chat = openai::chat().create(request);
+            auto content = chat["choices"][0]["message"]["content"].get<std::string>();
+            auto json = nlohmann::json::parse(content, nullptr, false);
+            if (json.is_discarded() || !json.contains("lines") || !json["lines"].is_array()) {
+                logger::warn("Scene segment was not the JSON we asked for: {}", content);
+                return segment;
+            }
+
+            // Lines from anyone who is not in the scene are dropped
+            for (const auto& entry : json["lines"]) {
+                auto speaker = entry.value("speaker", "");
+                auto text = entry.value("line", "");
+                auto found = std::ranges::find_if(speakers, [&](const auto& s) { return SameName(s.Name(), speaker); });
+                if (found != speakers.end() && !text.empty()) {
+                    segment.lines.push_back({static_cast<std::size_t>(found - speakers.begin()), std::move(text)});
+                }
+            }
+            segment.end = json.value("end", false);
+            return segment;
+        }
+
+        void Receive(std::uint32_t id, Segment segment) {
+            auto& state = GetState();
+            auto scene = std::ranges::find(state.scenes, id, &Scene::id);
+            if (scene == state.scenes.end()) {
+                return;  // Ended while we were waiting
+            }
+
+            scene->requesting = false;
+            scene->segments++;
+            if (segment.lines.empty() || segment.end || scene->segments >= kMaxSegments) {
+                scene->finishing = true;
+            }
+            for (auto& line : segment.lines) {
+                scene->queued.push_back(std::move(line));
+            }
+        }
+
+        Tasks::Task<void> RequestSegment(std::uint32_t id, std::vector<Snapshots::ActorSnapshot> speakers,
+                                         std::vector<std::string> transcript, bool last, std::string model) {
+            Segment segment;
+            try {
+                auto request = Tasks::BlockingIo([speakers = std::move(speakers), transcript = std::move(transcript), last, model]() {
+                    return Generate(speakers, transcript, last, model);
+                });
+                segment = co_await request;
+            } catch (const std::exception& e) {
+                logger::error("Scene segment request failed: {}", e.what());
+            }
+
+            // Scenes are only touched on the game thread
+            co_await Tasks::ResumeOn{Tasks::Executor::Game};
+            Receive(id, std::move(segment));
+        }
+
+        // False once a speaker is gone, busy, or has wandered off
+        bool Intact(const Scene& scene, std::vector<Snapshots::ActorSnapshot>& speakers) {
+            speakers.resize(scene.members.size());
+            for (std::size_t i = 0; i < scene.members.size(); i++) {
+                auto agent = Manager::Get(scene.members[i].handle);
+                if (!agent || !CanTalk(*agent, speakers[i]) || Distance(speakers[i], speakers.front()) > kLeaveRadius) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        void Request(Scene& scene, std::vector<Snapshots::ActorSnapshot> speakers) {
+            scene.requesting = true;
+            bool last = scene.segments + 1 >= kMaxSegments;
+
+            // Lines still queued have not been said yet, but the next segment follows them
+            std::vector<std::string> transcript(scene.transcript.begin(), scene.transcript.end());
+            for (const auto& line : scene.queued) {
+                transcript.push_back(std::format("{}: {}", scene.members[line.speaker].name, line.text));
+            }
+            if (transcript.size() > kTranscriptLines) {
+                transcript.erase(transcript.begin(), transcript.end() - kTranscriptLines);
+            }
+
+            // A scene is asked for at the tier of its least detailed member (see Lod.h); the
+            // transcript is the part of the prompt that grows, so it is what the cap trims
+            auto tier = Lod::Tier::Focus;
+            for (const auto& member : scene.members) {
+                if (auto agent = Manager::Get(member.handle)) {
+                    tier = (std::max)(tier, agent->lod.tier.load(std::memory_order_relaxed));
+                }
+            }
+            const auto budget = Lod::PromptBudget(tier, Tokenizer::BudgetFor(Tokenizer::RequestClass::Dialogue).prompt);
+            std::uint32_t tokens = 0;
+            auto first = transcript.size();
+            while (first > 0) {
+                auto cost = Tokenizer::Count(transcript[first - 1]);
+                if (tokens + cost > budget) break;
+                tokens += cost;
+                first--;
+            }
+            transcript.erase(transcript.begin(), transcript.begin() + static_cast<std::ptrdiff_t>(first));
+
+            Tasks::Spawn(RequestSegment(scene.id, std::move(speakers), std::move(transcript), last,
+                                        Lod::ModelFor(tier, UI::Config::OpenAI::model)));
+        }
+
+        void Say(Scene& scene, Clock::time_point now) {
+            auto line = std::move(scene.queued.front());
+            scene.queued.pop_front();
+            const auto& member = scene.members[line.speaker];
+
+            auto agent = Manager::Get(member.handle);
+            auto* actor = agent ? agent->GetNPC() : nullptr;
+            if (actor) {
+                RE::DebugNotification(std::format("{}: {}", member.name, line.text).c_str());
+                WorldEvents::Publish(std::format("{} said: \"{}\"", member.name, line.text), actor, kHearingRadius,
+                                     kLineImportance);
+            }
+
+            scene.transcript.push_back(std::format("{}: {}", member.name, line.text));
+            if (scene.transcript.size() > kTranscriptLines) {
+                scene.transcript.pop_front();
+            }
+            scene.spoken++;
+
+            // Roughly the time it takes to say it
+            auto pause = std::chrono::milliseconds(1500 + 60 * static_cast<std::int64_t>(line.text.size()));
+            scene.nextLine = now + (std::min)(pause, std::chrono::milliseconds(8000));
+        }
+
+        void Group(Clock::time_point now) {
+            auto& state = GetState();
+            std::erase_if(state.resting, [&](const auto& entry) { return entry.second <= now; });
+
+            struct Candidate {
+                Member member;
+                Snapshots::ActorSnapshot actor;
+            };
+            std::vector<Candidate> candidates;
+
+            auto count = Manager::Count();
+            RE::FormID cursor = 0;
+            for (std::size_t i = 0; i < count; i++) {
+                auto entry = Manager::Next(cursor);
+                if (!entry.agent) {
+                    break;
+                }
+                cursor = entry.formId;
+                if (entry.pinned || state.resting.contains(entry.formId) ||
+                    std::ranges::any_of(state.scenes, [&](const Scene& scene) {
+                        return std::ranges::find(scene.members, entry.formId, &Member::formId) != scene.members.end();
+                    })) {
+                    continue;
+                }
+
+                Candidate candidate;
+                if (CanTalk(*entry.agent, candidate.actor)) {
+                    candidate.member = {entry.handle, entry.formId, std::string(candidate.actor.Name())};
+                    candidates.push_back(std::move(candidate));
+                }
+            }
+
+            std::vector<bool> taken(candidates.size(), false);
+            for (std::size_t i = 0; i < candidates.size(); i++) {
+                if (taken[i] || state.scenes.size() >= static_cast<std::size_t>((std::max)(Memory::maxScenes, 0))) {
+                    continue;
+                }
+
+                std::vector<std::size_t> group{i};
+                for (std::size_t j = i + 1; j < candidates.size() && group.size() < kMaxSpeakers; j++) {
+                    if (!taken[j] && Distance(candidates[i].actor, candidates[j].actor) <= kSceneRadius) {
+                        group.push_back(j);
+                    }
+                }
+                if (group.size() < 2) {
+                    continue;
+                }
+
+                Scene scene;
+                scene.id = state.nextId++;
+                scene.nextLine = now;
+                std::vector<Snapshots::ActorSnapshot> speakers;
+                for (auto index : group) {
+                    taken[index] = true;
+                    scene.members.push_back(candidates[index].member);
+                    speakers.push_back(candidates[index].actor);
+                }
+                logger::info("Scene {} started with {} speakers", scene.id, scene.members.size());
+                Request(scene, std::move(speakers));
+                state.scenes.push_back(std::move(scene));
+            }
+        }
+    }
+
+    void Tick() {
+        auto& state = GetState();
+        state.frame++;
+        auto now = Clock::now();
+
+        std::vector<Snapshots::ActorSnapshot> speakers;
+        std::erase_if(state.scenes, [&](Scene& scene) {
+            bool over = !Memory::sceneConversations || !Intact(scene, speakers) ||
+                (scene.finishing && scene.queued.empty() && !scene.requesting);
+            if (over) {
+                // Whatever is still in flight finds no scene and is dropped
+                for (const auto& member : scene.members) {
+                    state.resting[member.formId] = now + kRestTime;
+                }
+                logger::info("Scene {} ended after {} lines", scene.id, scene.spoken);
+                return true;
+            }
+
+            if (!scene.queued.empty() && now >= scene.nextLine) {
+                Say(scene, now);
+            }
+            // Ask for more while there is still something to play
+            if (!scene.requesting && !scene.finishing && scene.queued.size() <= kRefillAt) {
+                Request(scene, speakers);
+            }
+            return false;
+        });
+
+        if (Memory::sceneConversations && UI::Config::OpenAI::initialized.load() && state.frame % kGroupInterval == 0) {
+            Group(now);
+        }
+        state.active.store(state.scenes.size(), std::memory_order_relaxed);
+    }
+
+    std::size_t Active() {
+        return GetState().active.load(std::memory_order_relaxed);
+    }
+}
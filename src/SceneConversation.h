@@ -0,0 +1,49 @@
+#pragma once
+#include "RE/Skyrim.h"
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Scene Conversations Overview
+ *
+ * Managed NPCs standing together talk among themselves. Instead of one
+ * request per line per speaker, a scene asks for a whole stretch of the
+ * conversation, every speaker at once, in one structured completion.
+ *
+ * 1. Grouping (game thread, every kGroupInterval frames):
+ *    - Candidates are near tier agents (see Lod.h): loaded, calm, not in a
+ *      chat with the player and not resting after their last scene
+ *    - Up to kMaxSpeakers within kSceneRadius of each other form a scene,
+ *      at most maxScenes at a time
+ *
+ * 2. Segments (worker):
+ *    - One request with every speaker's persona and state and the last
+ *      kTranscriptLines of the scene returns kSegmentLines attributed lines
+ *      as JSON, plus whether the conversation is winding down
+ *    - The next segment is requested while kRefillAt lines are still
+ *      queued, so playback does not stall on the round trip
+ *
+ * 3. Playback (game thread, every frame):
+ *    - Lines are spaced by their length; each is shown and published as a
+ *      world event (see WorldEvents.h), so the speakers and anyone in
+ *      earshot remember it
+ *    - A scene ends when the model winds it down, after kMaxSegments, or as
+ *      soon as a speaker leaves, is retired, fights or is talked to
+ */
+
+namespace TESSERACT::Agent::Scenes {
+    constexpr std::size_t kMaxSpeakers = 4;
+    constexpr float kSceneRadius = 512.0f;      // Game units between speakers to start
+    constexpr float kLeaveRadius = 1024.0f;     // ... and to keep going
+    constexpr float kHearingRadius = 1024.0f;   // Who remembers a line
+    constexpr std::uint64_t kGroupInterval = 120;
+    constexpr std::size_t kSegmentLines = 6;
+    constexpr std::size_t kRefillAt = 2;
+    constexpr std::uint32_t kMaxSegments = 4;
+    constexpr std::size_t kTranscriptLines = 12;
+
+    // Game thread, once per frame (see Hooks.cpp)
+    void Tick();
+
+    std::size_t Active();  // Scenes playing, as of the last frame
+}
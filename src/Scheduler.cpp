@@ -0,0 +1,100 @@
+#include "Scheduler.h"
+#include "Agent.h"
+#include "AgentManager.h"
+#include "Inbox.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+
+namespace TESSERACT::Agent::Scheduler {
+    namespace {
+        using Clock = std::chrono::steady_clock;
+
+        // Game thread only, except the published stats
+        std::uint64_t frame = 0;
+        RE::FormID cursor = 0;        // Last agent visited
+        double averageMicros = 50.0;  // Running cost of one Update()
+        std::uint64_t overruns = 0;
+
+        std::atomic<std::uint32_t> lastAgents{0};
+        std::atomic<std::uint32_t> lastTicked{0};
+        std::atomic<std::uint32_t> lastMicros{0};
+        std::atomic<std::uint64_t> lastOverruns{0};
+        std::array<std::atomic<std::uint32_t>, static_cast<std::size_t>(Lod::Tier::Count)> tierCounts{};
+    }
+
+    void Tick() {
+        auto start = Clock::now();
+        auto budget = static_cast<double>((std::max)(Memory::tickBudgetMicros, 0));
+        auto count = static_cast<std::uint32_t>(Manager::Count());
+        frame++;
+
+        // Finished work first, in one bounded batch however many agents there are
+        Inbox::Drain();
+
+        std::array<std::uint32_t, static_cast<std::size_t>(Lod::Tier::Count)> tiers{};
+        std::uint32_t visited = 0;
+        std::uint32_t ticked = 0;
+        double elapsed = 0.0;
+        while (visited < count) {
+            // The rest wait for the next frame, starting where we stopped
+            elapsed = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+            if (ticked > 0 && elapsed + averageMicros > budget) {
+                break;
+            }
+
+            auto entry = Manager::Next(cursor);
+            if (!entry.agent) {
+                break;
+            }
+            cursor = entry.formId;
+            visited++;
+
+            // Retiering is a snapshot copy and a few compares, so it happens on every visit
+            Snapshots::ActorSnapshot actor;
+            if (!entry.agent->ReadSnapshot(actor)) {
+                actor = {};
+            }
+            auto& lod = entry.agent->lod;
+            auto tier = Lod::Classify(actor, entry.pinned, lod.tier.load(std::memory_order_relaxed));
+            lod.tier.store(tier, std::memory_order_relaxed);
+            tiers[static_cast<std::size_t>(tier)]++;
+            if (frame - lod.lastTick < Lod::PolicyFor(tier).tickInterval) {
+                continue;
+            }
+            lod.lastTick = frame;
+
+            auto before = Clock::now();
+            entry.agent->Update();
+            auto cost = std::chrono::duration<double, std::micro>(Clock::now() - before).count();
+            averageMicros += (cost - averageMicros) / 8.0;
+            ticked++;
+        }
+        elapsed = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+
+        if (elapsed > budget) {
+            overruns++;
+        }
+
+        lastAgents.store(count, std::memory_order_relaxed);
+        lastTicked.store(ticked, std::memory_order_relaxed);
+        lastMicros.store(static_cast<std::uint32_t>(elapsed), std::memory_order_relaxed);
+        lastOverruns.store(overruns, std::memory_order_relaxed);
+        // Only a full pass sees every agent
+        if (visited == count) {
+            for (std::size_t i = 0; i < tiers.size(); i++) {
+                tierCounts[i].store(tiers[i], std::memory_order_relaxed);
+            }
+        }
+    }
+
+    Stats LastFrame() {
+        Stats stats{lastAgents.load(std::memory_order_relaxed), lastTicked.load(std::memory_order_relaxed),
+                    lastMicros.load(std::memory_order_relaxed), lastOverruns.load(std::memory_order_relaxed)};
+        for (std::size_t i = 0; i < tierCounts.size(); i++) {
+            stats.tiers[i] = tierCounts[i].load(std::memory_order_relaxed);
+        }
+        return stats;
+    }
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include "Lod.h"
+#include <cstdint>
+
+/**
+ * Agent Scheduler Overview
+ *
+ * Ticks every managed agent (see AgentManager.h) from the game's main update,
+ * so NPCs keep thinking while the chat window is closed, without the frame
+ * paying for all of them at once.
+ *
+ * 1. Budget:
+ *    - Each frame gets tickBudgetMicros; an agent is only started if the
+ *      time spent so far plus the running average cost of one Update() fits
+ *    - The first agent of a frame always runs, so one slow agent cannot stall
+ *      the rest forever (counted as an overrun when it blows the budget)
+ *
+ * 2. Round robin:
+ *    - Agents are walked in FormID order from a cursor kept across frames;
+ *      those not reached this frame are the first ones ticked on the next
+ *    - Slow work (requests, consolidation, fact mining) already runs on
+ *      worker threads, Update() only collects and starts it
+ *
+ * 3. Results:
+ *    - Each frame starts by draining a bounded batch of worker results
+ *      (see Inbox.h), inside the same budget
+ *
+ * 4. Level of detail:
+ *    - Every visit retiers the agent from its snapshot (see Lod.h); the
+ *      agent is only updated when its tier's tick interval has passed
+ */
+
+namespace TESSERACT::Agent::Scheduler {
+    struct Stats {
+        std::uint32_t agents = 0;   // Managed agents
+        std::uint32_t ticked = 0;   // Updated last frame
+        std::uint32_t micros = 0;   // Spent last frame
+        std::uint64_t overruns = 0; // Frames over budget since startup
+        std::uint32_t tiers[static_cast<std::size_t>(Lod::Tier::Count)] = {};  // Agents per tier, last full pass
+    };
+
+    // Game thread, once per frame (see Hooks.cpp)
+    void Tick();
+
+    Stats LastFrame();
+}
@@ -0,0 +1,142 @@
+#include "Tasks.h"
+#include <condition_variable>
+#include <deque>
+#include <initializer_list>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace TESSERACT::Agent::Tasks {
+    namespace {
+        using Clock = std::chrono::steady_clock;
+
+        struct Timer {
+            Clock::time_point due;
+            std::uint64_t order;  // Same deadline: first posted runs first
+            Executor where;
+            std::function<void()> job;
+
+            bool operator>(const Timer& other) const {
+                return due != other.due ? due > other.due : order > other.order;
+            }
+        };
+
+        struct Pool {
+            std::condition_variable_any wake;
+            std::deque<std::function<void()>> jobs;
+            std::vector<std::jthread> threads;
+        };
+
+        struct State {
+            std::mutex mutex;
+            Pool workers;
+            Pool io;
+            std::condition_variable_any timerWake;
+            std::priority_queue<Timer, std::vector<Timer>, std::greater<>> timers;
+            std::uint64_t timerOrder = 0;
+            std::jthread timerThread;
+
+            State() {
+                Start(workers, kWorkerThreads);
+                Start(io, kIoThreads);
+                timerThread = std::jthread([this](std::stop_token stop) { TimerLoop(stop); });
+            }
+
+            ~State() {
+                for (auto* pool : {&workers, &io}) {
+                    for (auto& thread : pool->threads) thread.request_stop();
+                    pool->wake.notify_all();
+                }
+                timerThread.request_stop();
+                timerWake.notify_all();
+            }
+
+            void Start(Pool& pool, std::size_t count) {
+                for (std::size_t i = 0; i < count; i++) {
+                    pool.threads.emplace_back([this, &pool](std::stop_token stop) { PoolLoop(pool, stop); });
+                }
+            }
+
+            void PoolLoop(Pool& pool, std::stop_token stop) {
+                while (true) {
+                    std::function<void()> job;
+                    {
+                        std::unique_lock lock(mutex);
+                        if (!pool.wake.wait(lock, stop, [&pool] { return !pool.jobs.empty(); })) {
+                            return;
+                        }
+                        job = std::move(pool.jobs.front());
+                        pool.jobs.pop_front();
+                    }
+                    job();
+                }
+            }
+
+            void TimerLoop(std::stop_token stop) {
+                std::unique_lock lock(mutex);
+                while (!stop.stop_requested()) {
+                    if (timers.empty()) {
+                        timerWake.wait(lock, stop, [this] { return !timers.empty(); });
+                        continue;
+                    }
+                    auto due = timers.top().due;
+                    if (Clock::now() < due) {
+                        // Woken early by a new timer; re-check the earliest deadline
+                        timerWake.wait_until(lock, stop, due, [this, due] { return !timers.empty() && timers.top().due < due; });
+                        continue;
+                    }
+
+                    auto timer = std::move(const_cast<Timer&>(timers.top()));
+                    timers.pop();
+                    lock.unlock();
+                    Post(timer.where, std::move(timer.job));
+                    lock.lock();
+                }
+            }
+        };
+
+        State& GetState() {
+            static State state;
+            return state;
+        }
+    }
+
+    void Post(Executor where, std::function<void()> job) {
+        if (where == Executor::Game) {
+            if (auto* tasks = SKSE::GetTaskInterface()) {
+                tasks->AddTask(std::move(job));
+                return;
+            }
+            logger::error("No SKSE task interface, running game thread work on a worker");
+        }
+
+        auto& state = GetState();
+        auto& pool = where == Executor::Io ? state.io : state.workers;
+        {
+            std::lock_guard lock(state.mutex);
+            pool.jobs.push_back(std::move(job));
+        }
+        // One job, one thread; nobody else has anything new to look at
+        pool.wake.notify_one();
+    }
+
+    void PostAfter(std::chrono::steady_clock::duration delay, Executor where, std::function<void()> job) {
+        auto& state = GetState();
+        {
+            std::lock_guard lock(state.mutex);
+            state.timers.push({Clock::now() + delay, state.timerOrder++, where, std::move(job)});
+        }
+        state.timerWake.notify_one();
+    }
+
+    void LogUnhandled(std::exception_ptr exception) {
+        try {
+            std::rethrow_exception(exception);
+        } catch (const std::exception& e) {
+            logger::error("Agent task failed: {}", e.what());
+        } catch (...) {
+            logger::error("Agent task failed with an unknown error");
+        }
+    }
+}
@@ -0,0 +1,310 @@
+#pragma once
+#include <nlohmann/json.hpp>
+#include <openai/openai.hpp>
+#include <atomic>
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+/**
+ * Agent Tasks Overview
+ *
+ * Coroutines for multi-step agent work (retrieve -> think -> act -> reflect)
+ * so a flow reads top to bottom instead of being spread over futures polled
+ * from Update(), and no agent keeps a thread of its own while it waits.
+ *
+ * 1. Task<T>:
+ *    - Lazy: starts when awaited or spawned; co_await-ing a task resumes the
+ *      caller when it finishes, with its value or exception
+ *    - Spawn() runs one detached; it frees itself, exceptions are logged
+ *
+ * 2. Executors:
+ *    - Worker: a small shared pool (kWorkerThreads) for short CPU jobs and
+ *      resumes; nothing that waits on the network or the disk runs here
+ *    - Io: its own bounded pool (kIoThreads), so at most that many blocking
+ *      calls (HTTP, file writes) are in flight for all agents together, and
+ *      a slow provider never keeps workers from resuming anyone
+ *    - Game: the SKSE task interface, resumes on the game thread
+ *    - Each job wakes one thread of its pool
+ *
+ * 3. Awaitables:
+ *    - ResumeOn(executor): hop to the worker pool or the game thread
+ *    - Delay(duration, executor): timer thread, resumes on the executor
+ *    - Blocking(fn, executor): runs fn on a worker (or the I/O pool) and
+ *      resumes on a worker with its result
+ *    - BlockingIo(fn, timeout): fn on the I/O pool, but we resume with a
+ *      TimeoutError once the timeout passes; if fn had not started by then
+ *      it never does, otherwise its late result is dropped. fn must own
+ *      what it uses. Request(json) does that for a chat completion
+ */
+
+namespace TESSERACT::Agent::Tasks {
+    enum class Executor : std::uint8_t {
+        Worker,
+        Io,
+        Game
+    };
+
+    constexpr std::size_t kWorkerThreads = 4;
+    constexpr std::size_t kIoThreads = 4;
+    constexpr std::chrono::seconds kRequestTimeout{60};
+
+    struct TimeoutError : std::runtime_error {
+        TimeoutError() : std::runtime_error("Timed out waiting for the I/O pool") {}
+    };
+
+    // Queues work (Tasks.cpp); the pool and timer start on first use
+    void Post(Executor where, std::function<void()> job);
+    void PostAfter(std::chrono::steady_clock::duration delay, Executor where, std::function<void()> job);
+
+    void LogUnhandled(std::exception_ptr exception);
+
+    template <class T = void>
+    class Task;
+
+    namespace detail {
+        struct PromiseBase {
+            std::coroutine_handle<> continuation;
+            std::exception_ptr exception;
+            bool detached = false;
+
+            std::suspend_always initial_suspend() noexcept { return {}; }
+            void unhandled_exception() noexcept { exception = std::current_exception(); }
+
+            struct FinalAwaiter {
+                bool await_ready() const noexcept { return false; }
+
+                template <class Promise>
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+                    auto& promise = handle.promise();
+                    if (promise.detached) {
+                        if (promise.exception) LogUnhandled(promise.exception);
+                        handle.destroy();
+                        return std::noop_coroutine();
+                    }
+                    return promise.continuation ? promise.continuation : std::noop_coroutine();
+                }
+
+                void await_resume() const noexcept {}
+            };
+            FinalAwaiter final_suspend() noexcept { return {}; }
+        };
+
+        template <class T>
+        struct Promise : PromiseBase {
+            std::optional<T> value;
+
+            Task<T> get_return_object() noexcept;
+            template <class U>
+            void return_value(U&& result) { value.emplace(std::forward<U>(result)); }
+
+            T Take() {
+                if (exception) std::rethrow_exception(exception);
+                return std::move(*value);
+            }
+        };
+
+        template <>
+        struct Promise<void> : PromiseBase {
+            Task<void> get_return_object() noexcept;
+            void return_void() noexcept {}
+
+            void Take() {
+                if (exception) std::rethrow_exception(exception);
+            }
+        };
+    }
+
+    template <class T>
+    class Task {
+    public:
+        using promise_type = detail::Promise<T>;
+        using Handle = std::coroutine_handle<promise_type>;
+
+        explicit Task(Handle handle) noexcept : handle(handle) {}
+        Task(Task&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+        Task& operator=(Task&& other) noexcept {
+            if (this != &other) {
+                if (handle) handle.destroy();
+                handle = std::exchange(other.handle, {});
+            }
+            return *this;
+        }
+        Task(const Task&) = delete;
+        Task& operator=(const Task&) = delete;
+        ~Task() {
+            if (handle) handle.destroy();
+        }
+
+        // co_await task: start it and resume us when it is done (symmetric transfer, no stack growth)
+        auto operator co_await() && noexcept {
+            struct Awaiter {
+                Handle handle;
+                bool await_ready() const noexcept { return !handle || handle.done(); }
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller) noexcept {
+                    handle.promise().continuation = caller;
+                    return handle;
+                }
+                T await_resume() { return handle.promise().Take(); }
+            };
+            return Awaiter{handle};
+        }
+
+        // Hands the frame over to Spawn()
+        Handle Release() noexcept { return std::exchange(handle, {}); }
+
+    private:
+        Handle handle;
+    };
+
+    namespace detail {
+        template <class T>
+        Task<T> Promise<T>::get_return_object() noexcept {
+            return Task<T>(std::coroutine_handle<Promise<T>>::from_promise(*this));
+        }
+
+        inline Task<void> Promise<void>::get_return_object() noexcept {
+            return Task<void>(std::coroutine_handle<Promise<void>>::from_promise(*this));
+        }
+    }
+
+    // Fire and forget: starts on the executor, frees itself when done
+    inline void Spawn(Task<void> task, Executor where = Executor::Worker) {
+        auto handle = task.Release();
+        if (!handle) {
+            return;
+        }
+        handle.promise().detached = true;
+        Post(where, [handle]() { handle.resume(); });
+    }
+
+    struct ResumeOn {
+        Executor where;
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle) const { Post(where, [handle]() { handle.resume(); }); }
+        void await_resume() const noexcept {}
+    };
+
+    struct Delay {
+        std::chrono::steady_clock::duration duration;
+        Executor where = Executor::Worker;
+
+        bool await_ready() const noexcept { return duration <= std::chrono::steady_clock::duration::zero(); }
+        void await_suspend(std::coroutine_handle<> handle) const {
+            PostAfter(duration, where, [handle]() { handle.resume(); });
+        }
+        void await_resume() const noexcept {}
+    };
+
+    namespace detail {
+        template <class R>
+        using Slot = std::conditional_t<std::is_void_v<R>, bool, std::optional<R>>;
+
+        template <class F, class R = std::invoke_result_t<F&>>
+        void Invoke(F& fn, Slot<R>& result, std::exception_ptr& exception) {
+            try {
+                if constexpr (std::is_void_v<R>) {
+                    fn();
+                } else {
+                    result.emplace(fn());
+                }
+            } catch (...) {
+                exception = std::current_exception();
+            }
+        }
+
+        template <class R>
+        R Take(Slot<R>& result, std::exception_ptr& exception) {
+            if (exception) std::rethrow_exception(exception);
+            if constexpr (!std::is_void_v<R>) {
+                return std::move(*result);
+            }
+        }
+    }
+
+    // co_await Blocking(fn): fn runs on a worker (or the I/O pool), we resume on a worker with its result (or exception)
+    template <class F>
+    auto Blocking(F fn, Executor where = Executor::Worker) {
+        using R = std::invoke_result_t<F&>;
+        struct Awaiter {
+            F fn;
+            Executor where;
+            detail::Slot<R> result{};
+            std::exception_ptr exception;
+
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> handle) {
+                // The awaiter lives in the suspended frame until we resume it
+                Post(where, [this, handle]() {
+                    detail::Invoke(fn, result, exception);
+                    if (where == Executor::Worker) {
+                        handle.resume();
+                    } else {
+                        Post(Executor::Worker, [handle]() { handle.resume(); });
+                    }
+                });
+            }
+            R await_resume() { return detail::Take<R>(result, exception); }
+        };
+        return Awaiter{std::move(fn), where, {}, nullptr};
+    }
+
+    // co_await BlockingIo(fn): fn runs on the I/O pool, we resume on a worker with its result, or with a
+    // TimeoutError after timeout. fn lives on the heap, not in our frame, so it must own what it uses.
+    // Keep the awaiter in a local and co_await that: GCC 12 destroys a capturing lambda twice when it is
+    // a temporary of the co_await expression itself
+    template <class F>
+    auto BlockingIo(F fn, std::chrono::steady_clock::duration timeout = kRequestTimeout) {
+        using R = std::invoke_result_t<F&>;
+        struct Shared {
+            F fn;
+            std::atomic<bool> settled{false};  // Whoever sets it first (the job or the timer) resumes us
+            detail::Slot<R> result{};
+            std::exception_ptr exception;
+            std::coroutine_handle<> handle;
+        };
+        struct Awaiter {
+            std::shared_ptr<Shared> shared;
+            std::chrono::steady_clock::duration timeout;
+
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> handle) {
+                // Either job may resume us (and free this awaiter) as soon as it is queued
+                auto job = shared;
+                job->handle = handle;
+                PostAfter(timeout, Executor::Worker, [job]() {
+                    if (job->settled.exchange(true)) return;
+                    job->exception = std::make_exception_ptr(TimeoutError());
+                    job->handle.resume();
+                });
+                Post(Executor::Io, [job]() {
+                    if (job->settled.load()) return;  // Timed out while queued: never started
+
+                    detail::Slot<R> result{};
+                    std::exception_ptr exception;
+                    detail::Invoke(job->fn, result, exception);
+                    if (job->settled.exchange(true)) return;  // Nobody waits for it anymore
+
+                    job->result = std::move(result);
+                    job->exception = exception;
+                    Post(Executor::Worker, [job]() { job->handle.resume(); });
+                });
+            }
+            R await_resume() { return detail::Take<R>(shared->result, shared->exception); }
+        };
+        return Awaiter{std::make_shared<Shared>(std::move(fn)), timeout};
+    }
+
+    // co_await Request(json): a chat completion on the I/O pool, given up after timeout
+    inline auto Request(nlohmann::json request, std::chrono::steady_clock::duration timeout = kRequestTimeout) {
+        return BlockingIo([request = std::move(request)]() { return openai::chat().create(request); }, timeout);
+    }
+}
@@ -0,0 +1,276 @@
+#include "Tokenizer.h"
+#include "Agent.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace TESSERACT::Agent::Tokenizer {
+    namespace {
+        const std::filesystem::path kTokenizerDirectory = "Data\\SKSE\\Plugins\\TESSERACT\\tokenizers";
+        constexpr std::size_t kCacheEntries = 1 << 15;
+
+        struct StringHash {
+            using is_transparent = void;
+            std::size_t operator()(std::string_view text) const { return std::hash<std::string_view>{}(text); }
+        };
+        using RankMap = std::unordered_map<std::string, std::uint32_t, StringHash, std::equal_to<>>;
+
+        // Written once at startup, read-only afterwards
+        RankMap ranks;
+        std::atomic<bool> loaded{false};
+        std::atomic<std::uint32_t> generation{0};  // Invalidates the per-thread caches
+
+        enum class CharClass { Letter, Digit, Space, Newline, Other };
+
+        CharClass Classify(unsigned char c) {
+            if (c >= 0x80 || std::isalpha(c)) return CharClass::Letter;  // UTF-8 bytes count as letters
+            if (std::isdigit(c)) return CharClass::Digit;
+            if (c == '\r' || c == '\n') return CharClass::Newline;
+            if (std::isspace(c)) return CharClass::Space;
+            return CharClass::Other;
+        }
+
+        // The tiktoken pre-tokenizer pattern, written out by hand:
+        //   's|'t|'re|'ve|'m|'ll|'d | [^\r\n\p{L}\p{N}]?\p{L}+ | \p{N}{1,3} |
+        //    ?[^\s\p{L}\p{N}]+[\r\n]* | \s*[\r\n] | \s+(?!\S) | \s+
+        template <class Fn>
+        void Pretokenize(std::string_view text, Fn&& emit) {
+            const std::size_t n = text.size();
+            auto at = [&](std::size_t k) { return Classify(static_cast<unsigned char>(text[k])); };
+
+            std::size_t i = 0;
+            while (i < n) {
+                // Contractions
+                if (text[i] == '\'' && i + 1 < n) {
+                    char a = static_cast<char>(std::tolower(static_cast<unsigned char>(text[i + 1])));
+                    char b = i + 2 < n ? static_cast<char>(std::tolower(static_cast<unsigned char>(text[i + 2]))) : '\0';
+                    if ((a == 'l' && b == 'l') || (a == 'v' && b == 'e') || (a == 'r' && b == 'e')) {
+                        emit(text.substr(i, 3));
+                        i += 3;
+                        continue;
+                    }
+                    if (a == 's' || a == 'd' || a == 'm' || a == 't') {
+                        emit(text.substr(i, 2));
+                        i += 2;
+                        continue;
+                    }
+                }
+
+                // A word, with at most one leading space or symbol
+                std::size_t j = i;
+                CharClass first = at(i);
+                if (first != CharClass::Letter && first != CharClass::Digit && first != CharClass::Newline &&
+                    j + 1 < n && at(j + 1) == CharClass::Letter) {
+                    j++;
+                }
+                if (at(j) == CharClass::Letter) {
+                    while (j < n && at(j) == CharClass::Letter) j++;
+                    emit(text.substr(i, j - i));
+                    i = j;
+                    continue;
+                }
+
+                // Numbers in groups of up to three digits
+                if (first == CharClass::Digit) {
+                    j = i;
+                    while (j < n && j - i < 3 && at(j) == CharClass::Digit) j++;
+                    emit(text.substr(i, j - i));
+                    i = j;
+                    continue;
+                }
+
+                // Symbols, with at most one leading space and any trailing newlines
+                j = i;
+                if (text[j] == ' ' && j + 1 < n && at(j + 1) == CharClass::Other) j++;
+                if (at(j) == CharClass::Other) {
+                    while (j < n && at(j) == CharClass::Other) j++;
+                    while (j < n && at(j) == CharClass::Newline) j++;
+                    emit(text.substr(i, j - i));
+                    i = j;
+                    continue;
+                }
+
+                // Whitespace: up to the last newline, otherwise leave one space for the next word
+                j = i;
+                std::size_t lastNewline = std::string_view::npos;
+                while (j < n && (at(j) == CharClass::Space || at(j) == CharClass::Newline)) {
+                    if (at(j) == CharClass::Newline) lastNewline = j;
+                    j++;
+                }
+                if (lastNewline != std::string_view::npos) {
+                    j = lastNewline + 1;
+                } else if (j < n && j - i > 1) {
+                    j--;
+                }
+                emit(text.substr(i, j - i));
+                i = j;
+            }
+        }
+
+        // Standard byte pair merge: repeatedly join the adjacent pair with the lowest rank
+        std::uint32_t MergeCount(std::string_view piece) {
+            if (ranks.find(piece) != ranks.end()) {
+                return 1;
+            }
+
+            constexpr std::uint32_t kNone = UINT32_MAX;
+            std::vector<std::uint32_t> bounds(piece.size() + 1);
+            std::iota(bounds.begin(), bounds.end(), 0u);
+
+            auto rankOf = [&](std::size_t i) {
+                if (i + 2 >= bounds.size()) return kNone;
+                auto it = ranks.find(piece.substr(bounds[i], bounds[i + 2] - bounds[i]));
+                return it == ranks.end() ? kNone : it->second;
+            };
+
+            std::vector<std::uint32_t> pairRanks(bounds.size(), kNone);
+            for (std::size_t i = 0; i + 2 < bounds.size(); i++) {
+                pairRanks[i] = rankOf(i);
+            }
+
+            while (bounds.size() > 2) {
+                auto best = std::min_element(pairRanks.begin(), pairRanks.end() - 2);
+                if (*best == kNone) break;
+
+                auto i = static_cast<std::size_t>(best - pairRanks.begin());
+                bounds.erase(bounds.begin() + i + 1);
+                pairRanks.erase(pairRanks.begin() + i + 1);
+                pairRanks[i] = rankOf(i);
+                if (i > 0) pairRanks[i - 1] = rankOf(i - 1);
+            }
+            return static_cast<std::uint32_t>(bounds.size() - 1);
+        }
+
+        // Without a vocabulary: common English words are one token, long words
+        // split every ~7 letters, symbols pair up, non-Latin text is byte-heavy
+        std::uint32_t EstimateCount(std::string_view piece) {
+            std::size_t letters = 0, digits = 0, wide = 0, symbols = 0;
+            for (unsigned char c : piece) {
+                if (c >= 0x80) wide++;
+                else if (std::isalpha(c)) letters++;
+                else if (std::isdigit(c)) digits++;
+                else if (!std::isspace(c)) symbols++;
+            }
+
+            if (wide > 0) return static_cast<std::uint32_t>((std::max<std::size_t>)(1, (wide + 1) / 2 + letters / 7));
+            if (letters > 0) return static_cast<std::uint32_t>(1 + (letters - 1) / 7 + (symbols > 0 ? 1 : 0));
+            if (digits > 0) return 1;
+            if (symbols > 0) return static_cast<std::uint32_t>((symbols + 1) / 2);
+            return 1;
+        }
+
+        bool DecodeBase64(std::string_view text, std::string& out) {
+            static const std::array<std::int8_t, 256> table = [] {
+                std::array<std::int8_t, 256> values{};
+                values.fill(-1);
+                const char* alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+                for (int i = 0; i < 64; i++) values[static_cast<unsigned char>(alphabet[i])] = static_cast<std::int8_t>(i);
+                return values;
+            }();
+
+            out.clear();
+            std::uint32_t buffer = 0;
+            int bits = 0;
+            for (unsigned char c : text) {
+                if (c == '=') break;
+                if (table[c] < 0) return false;
+                buffer = (buffer << 6) | static_cast<std::uint32_t>(table[c]);
+                bits += 6;
+                if (bits >= 8) {
+                    bits -= 8;
+                    out += static_cast<char>((buffer >> bits) & 0xFF);
+                }
+            }
+            return !out.empty();
+        }
+    }
+
+    void Initialize() {
+        auto startTime = std::chrono::high_resolution_clock::now();
+        auto path = kTokenizerDirectory / Memory::tokenizerFile;
+
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open()) {
+            logger::info("No tokenizer vocabulary at {}, token counts are estimates", path.string());
+            return;
+        }
+
+        RankMap loadedRanks;
+        loadedRanks.reserve(200000);
+        std::string line, bytes;
+        while (std::getline(file, line)) {
+            auto space = line.find(' ');
+            if (space == std::string::npos || !DecodeBase64(std::string_view(line).substr(0, space), bytes)) {
+                continue;
+            }
+            try {
+                loadedRanks.emplace(bytes, static_cast<std::uint32_t>(std::stoul(line.substr(space + 1))));
+            } catch (const std::exception&) {
+                continue;
+            }
+        }
+
+        if (loadedRanks.size() < 256) {
+            logger::error("Tokenizer vocabulary {} is incomplete ({} entries), using estimates", path.string(), loadedRanks.size());
+            return;
+        }
+
+        ranks = std::move(loadedRanks);
+        generation++;
+        loaded.store(true);
+
+        auto endTime = std::chrono::high_resolution_clock::now();
+        logger::info("Loaded tokenizer {} ({} ranks) in {} ms", Memory::tokenizerFile, ranks.size(),
+            std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count());
+    }
+
+    bool IsExact() {
+        return loaded.load();
+    }
+
+    std::uint32_t Count(std::string_view text) {
+        thread_local RankMap cache;
+        thread_local std::uint32_t cacheGeneration = 0;
+        if (cacheGeneration != generation.load(std::memory_order_relaxed)) {
+            cache.clear();
+            cacheGeneration = generation.load(std::memory_order_relaxed);
+        }
+
+        const bool exact = loaded.load(std::memory_order_acquire);
+        std::uint32_t total = 0;
+        Pretokenize(text, [&](std::string_view piece) {
+            if (auto it = cache.find(piece); it != cache.end()) {
+                total += it->second;
+                return;
+            }
+            std::uint32_t count = exact ? MergeCount(piece) : EstimateCount(piece);
+            if (cache.size() >= kCacheEntries) cache.clear();
+            cache.emplace(piece, count);
+            total += count;
+        });
+        return total;
+    }
+
+    Budget BudgetFor(RequestClass request) {
+        switch (request) {
+        case RequestClass::Consolidation:
+            return {6000, 300};
+        case RequestClass::Extraction:
+            return {1500, 200};
+        case RequestClass::Dialogue:
+        default: {
+            auto total = static_cast<std::uint32_t>((std::max)(Memory::contextTokenBudget, 512));
+            auto output = std::clamp(static_cast<std::uint32_t>((std::max)(Memory::replyTokenReserve, 16)), 16u, total / 2);
+            return {total - output, output};
+        }
+        }
+    }
+}
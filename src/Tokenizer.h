@@ -0,0 +1,51 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+/**
+ * Tokenizer Overview
+ *
+ * Local token counting so context assembly can fill a token budget instead of
+ * guessing from message counts.
+ *
+ * 1. Vocabulary:
+ *    - Byte-level BPE ranks in tiktoken format (one "base64 rank" pair per
+ *      line), loaded from Data\SKSE\Plugins\TESSERACT\tokenizers\<Memory::tokenizerFile>
+ *    - cl100k_base covers GPT-4/3.5, o200k_base the GPT-4o family; without a
+ *      file we fall back to a per-piece estimate that runs a little high
+ *
+ * 2. Counting:
+ *    - Text is split into pieces with a hand-written version of the tiktoken
+ *      pre-tokenizer pattern, then each piece is merged by rank
+ *    - Piece counts are cached per thread (dialogue repeats the same words)
+ *
+ * 3. Budgets:
+ *    - Each request class has a prompt budget and an output reserve; the
+ *      dialogue one is configurable, background requests use fixed ones
+ */
+
+namespace TESSERACT::Agent::Tokenizer {
+    // Chat format overhead (role markers per message, priming of the reply)
+    constexpr std::uint32_t kMessageOverhead = 4;
+    constexpr std::uint32_t kReplyPriming = 3;
+
+    // Startup: loads the vocabulary if there is one
+    void Initialize();
+    bool IsExact();  // False while running on the estimate
+
+    std::uint32_t Count(std::string_view text);
+    inline std::uint32_t CountMessage(std::string_view content) { return Count(content) + kMessageOverhead; }
+
+    enum class RequestClass {
+        Dialogue,       // NPC replies
+        Consolidation,  // Memory summaries
+        Extraction      // Fact extraction
+    };
+
+    struct Budget {
+        std::uint32_t prompt;  // Everything we send
+        std::uint32_t output;  // Reserved for the reply (sent as max_tokens)
+    };
+    Budget BudgetFor(RequestClass request);
+}
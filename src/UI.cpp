@@ -1,7 +1,18 @@
 #include "UI.h"
 #include "Utils.h"
 #include "HoldingQuestFunctions.h"
+#include "ActionExecutor.h"
 #include "Agent.h"
+#include "Cognition.h"
+#include "ConversationArchive.h"
+#include "Embedding.h"
+#include "Inbox.h"
+#include "LoreIndex.h"
+#include "MemoryScoring.h"
+#include "SceneConversation.h"
+#include "Scheduler.h"
+#include "Tasks.h"
+#include "Tokenizer.h"
 
 
 namespace UI {
@@ -139,6 +150,7 @@ namespace UI {
                 Dashboard::LoadFromConfig(config);
                 OpenAI::LoadFromConfig(config);
                 Chat::LoadFromConfig(config);
+                Memory::LoadFromConfig(config);
 
                 loadSuccess = true;
                 logger::info("Config loaded successfully");
@@ -167,6 +179,7 @@ namespace UI {
                 Dashboard::SaveToConfig(config);
                 OpenAI::SaveToConfig(config);
                 Chat::SaveToConfig(config);
+                Memory::SaveToConfig(config);
 
                 // Write to file
                 std::ofstream file(CONFIG_PATH);
@@ -270,6 +283,166 @@ namespace UI {
                 }
             }
         }
+
+        // Memory config implementation
+        namespace Memory {
+            namespace AgentMemory = TESSERACT::Agent::Memory;
+
+            void SaveToConfig(nlohmann::json& config) {
+                config["memory"] = {
+                    {"maxMemories", AgentMemory::maxMemories},
+                    {"calculateImportance", AgentMemory::calculateImportance},
+                    {"useLocalEmbeddings", AgentMemory::useLocalEmbeddings},
+                    {"embeddingModel", AgentMemory::embeddingModel},
+                    {"embeddingDimensions", AgentMemory::embeddingDimensions},
+                    {"retrievalTopK", AgentMemory::retrievalTopK},
+                    {"lexicalBudgetMicros", AgentMemory::lexicalBudgetMicros},
+                    {"consolidateMemories", AgentMemory::consolidateMemories},
+                    {"consolidationThreshold", AgentMemory::consolidationThreshold},
+                    {"consolidationSpan", AgentMemory::consolidationSpan},
+                    {"summaryFanIn", AgentMemory::summaryFanIn},
+                    {"maxConcurrentConsolidations", AgentMemory::maxConcurrentConsolidations},
+                    {"consolidationModel", AgentMemory::consolidationModel},
+                    {"recencyWeight", AgentMemory::recencyWeight},
+                    {"importanceWeight", AgentMemory::importanceWeight},
+                    {"relevanceWeight", AgentMemory::relevanceWeight},
+                    {"recencyHalfLifeHours", AgentMemory::recencyHalfLifeHours},
+                    {"extractFacts", AgentMemory::extractFacts},
+                    {"maxFacts", AgentMemory::maxFacts},
+                    {"factsInContext", AgentMemory::factsInContext},
+                    {"mergeRepeats", AgentMemory::mergeRepeats},
+                    {"loreInContext", AgentMemory::loreInContext},
+                    {"loreBudgetMicros", AgentMemory::loreBudgetMicros},
+                    {"tickBudgetMicros", AgentMemory::tickBudgetMicros},
+                    {"actionBudgetMicros", AgentMemory::actionBudgetMicros},
+                    {"useCognitionGraph", AgentMemory::useCognitionGraph},
+                    {"sceneConversations", AgentMemory::sceneConversations},
+                    {"maxScenes", AgentMemory::maxScenes},
+                    {"lodNearDistance", AgentMemory::lodNearDistance},
+                    {"lodFarDistance", AgentMemory::lodFarDistance},
+                    {"lodFarModel", AgentMemory::lodFarModel},
+                    {"contextTokenBudget", AgentMemory::contextTokenBudget},
+                    {"replyTokenReserve", AgentMemory::replyTokenReserve},
+                    {"tokenizerFile", AgentMemory::tokenizerFile},
+                    {"hotMemories", AgentMemory::hotMemories},
+                    {"warmBudgetMB", AgentMemory::warmBudgetMB}
+                };
+            }
+
+            void LoadFromConfig(const nlohmann::json& config) {
+                if (config.contains("memory")) {
+                    const auto& memory = config["memory"];
+                    if (memory.contains("maxMemories")) {
+                        AgentMemory::maxMemories = memory["maxMemories"].get<int>();
+                    }
+                    if (memory.contains("calculateImportance")) {
+                        AgentMemory::calculateImportance = memory["calculateImportance"].get<bool>();
+                    }
+                    if (memory.contains("useLocalEmbeddings")) {
+                        AgentMemory::useLocalEmbeddings = memory["useLocalEmbeddings"].get<bool>();
+                    }
+                    if (memory.contains("embeddingModel")) {
+                        AgentMemory::embeddingModel = memory["embeddingModel"].get<std::string>();
+                    }
+                    if (memory.contains("embeddingDimensions")) {
+                        AgentMemory::embeddingDimensions = memory["embeddingDimensions"].get<int>();
+                    }
+                    if (memory.contains("retrievalTopK")) {
+                        AgentMemory::retrievalTopK = memory["retrievalTopK"].get<int>();
+                    }
+                    if (memory.contains("lexicalBudgetMicros")) {
+                        AgentMemory::lexicalBudgetMicros = memory["lexicalBudgetMicros"].get<int>();
+                    }
+                    if (memory.contains("consolidateMemories")) {
+                        AgentMemory::consolidateMemories = memory["consolidateMemories"].get<bool>();
+                    }
+                    if (memory.contains("consolidationThreshold")) {
+                        AgentMemory::consolidationThreshold = memory["consolidationThreshold"].get<int>();
+                    }
+                    if (memory.contains("consolidationSpan")) {
+                        AgentMemory::consolidationSpan = memory["consolidationSpan"].get<int>();
+                    }
+                    if (memory.contains("summaryFanIn")) {
+                        AgentMemory::summaryFanIn = memory["summaryFanIn"].get<int>();
+                    }
+                    if (memory.contains("maxConcurrentConsolidations")) {
+                        AgentMemory::maxConcurrentConsolidations = memory["maxConcurrentConsolidations"].get<int>();
+                    }
+                    if (memory.contains("consolidationModel")) {
+                        AgentMemory::consolidationModel = memory["consolidationModel"].get<std::string>();
+                    }
+                    if (memory.contains("recencyWeight")) {
+                        AgentMemory::recencyWeight = memory["recencyWeight"].get<float>();
+                    }
+                    if (memory.contains("importanceWeight")) {
+                        AgentMemory::importanceWeight = memory["importanceWeight"].get<float>();
+                    }
+                    if (memory.contains("relevanceWeight")) {
+                        AgentMemory::relevanceWeight = memory["relevanceWeight"].get<float>();
+                    }
+                    if (memory.contains("recencyHalfLifeHours")) {
+                        AgentMemory::recencyHalfLifeHours = memory["recencyHalfLifeHours"].get<float>();
+                    }
+                    if (memory.contains("extractFacts")) {
+                        AgentMemory::extractFacts = memory["extractFacts"].get<bool>();
+                    }
+                    if (memory.contains("maxFacts")) {
+                        AgentMemory::maxFacts = memory["maxFacts"].get<int>();
+                    }
+                    if (memory.contains("factsInContext")) {
+                        AgentMemory::factsInContext = memory["factsInContext"].get<int>();
+                    }
+                    if (memory.contains("mergeRepeats")) {
+                        AgentMemory::mergeRepeats = memory["mergeRepeats"].get<bool>();
+                    }
+                    if (memory.contains("loreInContext")) {
+                        AgentMemory::loreInContext = memory["loreInContext"].get<int>();
+                    }
+                    if (memory.contains("loreBudgetMicros")) {
+                        AgentMemory::loreBudgetMicros = memory["loreBudgetMicros"].get<int>();
+                    }
+                    if (memory.contains("tickBudgetMicros")) {
+                        AgentMemory::tickBudgetMicros = memory["tickBudgetMicros"].get<int>();
+                    }
+                    if (memory.contains("actionBudgetMicros")) {
+                        AgentMemory::actionBudgetMicros = memory["actionBudgetMicros"].get<int>();
+                    }
+                    if (memory.contains("useCognitionGraph")) {
+                        AgentMemory::useCognitionGraph = memory["useCognitionGraph"].get<bool>();
+                    }
+                    if (memory.contains("sceneConversations")) {
+                        AgentMemory::sceneConversations = memory["sceneConversations"].get<bool>();
+                    }
+                    if (memory.contains("maxScenes")) {
+                        AgentMemory::maxScenes = memory["maxScenes"].get<int>();
+                    }
+                    if (memory.contains("lodNearDistance")) {
+                        AgentMemory::lodNearDistance = memory["lodNearDistance"].get<int>();
+                    }
+                    if (memory.contains("lodFarDistance")) {
+                        AgentMemory::lodFarDistance = memory["lodFarDistance"].get<int>();
+                    }
+                    if (memory.contains("lodFarModel")) {
+                        AgentMemory::lodFarModel = memory["lodFarModel"].get<std::string>();
+                    }
+                    if (memory.contains("contextTokenBudget")) {
+                        AgentMemory::contextTokenBudget = memory["contextTokenBudget"].get<int>();
+                    }
+                    if (memory.contains("replyTokenReserve")) {
+                        AgentMemory::replyTokenReserve = memory["replyTokenReserve"].get<int>();
+                    }
+                    if (memory.contains("tokenizerFile")) {
+                        AgentMemory::tokenizerFile = memory["tokenizerFile"].get<std::string>();
+                    }
+                    if (memory.contains("hotMemories")) {
+                        AgentMemory::hotMemories = memory["hotMemories"].get<int>();
+                    }
+                    if (memory.contains("warmBudgetMB")) {
+                        AgentMemory::warmBudgetMB = memory["warmBudgetMB"].get<int>();
+                    }
+                }
+            }
+        }
     }
 
     namespace NPCDetails {
@@ -299,29 +472,94 @@ namespace UI {
                 ImGui::Columns(1);  // Reset columns
             }
 
-            void DrawExperiencerContext() {
-                ImGui::TextWrapped("Experiencer agent context and history will be displayed here.");
-                // TODO: Add context history display
-                // Example layout for context history:
-                ImGui::BeginChild("ExperiencerHistory", ImVec2(0, 0), true);
-                for (int i = 0; i < 10; i++) {
-                    ImGui::TextWrapped("Sample context entry %d", i);
-                    ImGui::Separator();
+            RE::Actor* GetSelectedActor() {
+                if (!Dashboard::holdingQuest || selectedNpcId < 0) {
+                    return nullptr;
                 }
-                ImGui::EndChild();
+
+                for (auto& [aliasID, handle] : Dashboard::holdingQuest->refAliasMap) {
+                    if (aliasID == static_cast<std::uint32_t>(selectedNpcId)) {
+                        auto ref = handle.get().get();
+                        if (!ref || Dashboard::placeholderSet.contains(ref)) {
+                            return nullptr;
+                        }
+                        return ref->As<RE::Actor>();
+                    }
+                }
+                return nullptr;
             }
 
-            void DrawNarratorContext() {
-                ImGui::TextWrapped("Narrator agent context and history will be displayed here.");
-                // TODO: Add context history display
-                ImGui::BeginChild("NarratorHistory", ImVec2(0, 0), true);
-                for (int i = 0; i < 10; i++) {
-                    ImGui::TextWrapped("Sample narrative entry %d", i);
+            void DrawArchivePage(const char* id, TESSERACT::Agent::Archive::Stream stream, size_t& page) {
+                namespace Archive = TESSERACT::Agent::Archive;
+
+                auto* actor = GetSelectedActor();
+                if (!actor) {
+                    ImGui::TextWrapped("No NPC in this slot.");
+                    return;
+                }
+
+                // Only the current page is read from the archive
+                size_t total = Archive::Count(actor->GetFormID(), stream);
+                size_t pageCount = (std::max)(size_t{1}, (total + HISTORY_PAGE_SIZE - 1) / HISTORY_PAGE_SIZE);
+                page = (std::min)(page, pageCount - 1);
+
+                if (ImGui::Button(std::format("<##{}Prev", id).c_str()) && page > 0) {
+                    page--;
+                }
+                ImGui::SameLine();
+                ImGui::Text("Page %zu of %zu (%zu entries)", page + 1, pageCount, total);
+                ImGui::SameLine();
+                if (ImGui::Button(std::format(">##{}Next", id).c_str()) && page + 1 < pageCount) {
+                    page++;
+                }
+
+                // Drops every stream of this NPC; compaction reclaims the disk space later
+                auto forgetPopup = std::format("Forget Transcript##{}", id);
+                ImGui::SameLine();
+                if (ImGui::Button(std::format("Forget##{}", id).c_str()) && total > 0) {
+                    ImGui::OpenPopup(forgetPopup.c_str());
+                }
+                if (ImGui::IsItemHovered()) {
+                    ImGui::SetTooltip("Delete this NPC's archived dialogue and summaries.\n"
+                                    "What the NPC remembers in game is not affected.");
+                }
+                if (ImGui::BeginPopupModal(forgetPopup.c_str(), nullptr, ImGuiWindowFlags_AlwaysAutoResize)) {
+                    ImGui::Text("Delete the whole archived transcript of %s?", actor->GetName());
+                    if (ImGui::Button("Forget")) {
+                        Archive::Forget(actor->GetFormID());
+                        page = 0;
+                        ImGui::CloseCurrentPopup();
+                    }
+                    ImGui::SameLine();
+                    if (ImGui::Button("Cancel")) {
+                        ImGui::CloseCurrentPopup();
+                    }
+                    ImGui::EndPopup();
+                }
+
+                ImGui::BeginChild(id, ImVec2(0, 0), true);
+                for (const auto& turn : Archive::Read(actor->GetFormID(), stream, page * HISTORY_PAGE_SIZE, HISTORY_PAGE_SIZE)) {
+                    char time[32] = "";
+                    std::strftime(time, sizeof(time), "%Y-%m-%d %H:%M", std::localtime(&turn.timestamp));
+
+                    const char* speaker = turn.role == "user" ? "Player" : turn.role == "assistant" ? actor->GetName() : "Memory";
+                    ImGui::TextDisabled("%s  %s", time, speaker);
+                    ImGui::TextWrapped("%s", turn.content.c_str());
                     ImGui::Separator();
                 }
                 ImGui::EndChild();
             }
 
+            void DrawExperiencerContext() {
+                ImGui::TextWrapped("Everything this NPC and the player have said to each other.");
+                DrawArchivePage("ExperiencerHistory", TESSERACT::Agent::Archive::Stream::Dialogue, dialoguePage);
+            }
+
+            void DrawNarratorContext() {
+                ImGui::TextWrapped("Long-term memories consolidated from older conversations.");
+                DrawArchivePage("NarratorHistory", TESSERACT::Agent::Archive::Stream::Summary, summaryPage);
+            }
+
             void DrawPhysicalAgentContext() {
                 ImGui::TextWrapped("Physical agent context and history will be displayed here.");
                 // TODO: Add context history display
@@ -336,6 +574,8 @@ namespace UI {
 
         void Open(int npcId) {
             selectedNpcId = npcId;
+            dialoguePage = 0;
+            summaryPage = 0;
             detailsWindow->IsOpen = true;
             logger::info("Opening NPC Details window for NPC {}", npcId);
         }
@@ -695,9 +935,16 @@ namespace UI {
             // currentNPC = targetNpc;
             // OLD CODE
             // Now create an Agent object, and store the pointer
-            currentNPC = std::make_unique<TESSERACT::Agent::SubAgent>(targetNpc, "test");
+            // Agents outlive the chat (see AgentManager.h); pinned while it is open
+            TESSERACT::Agent::Manager::Unpin(currentAgent);
+            currentAgent = TESSERACT::Agent::Manager::Acquire(targetNpc);
+            TESSERACT::Agent::Manager::Pin(currentAgent);
             chatWindow->IsOpen = true;
             chatHistory.clear();
+
+            // Replies that arrived while the window was closed are already in the history below
+            TESSERACT::Agent::Inbox::ChatLine staleLine;
+            while (TESSERACT::Agent::Inbox::TakeChatLine(staleLine)) {}
             // isThinking = false;
             isThinking.store(false);
 
@@ -752,7 +999,7 @@ namespace UI {
             //     logger::error("Could not find DialogueStandingStart idle form");
             // }
 
-            if (currentNPC) {
+            if (auto agent = TESSERACT::Agent::Manager::Get(currentAgent)) {
                 // OLD CODE
                 // Context::AddMessage("system", GenerateSystemPrompt());
                 // OLD CODE
@@ -760,6 +1007,14 @@ namespace UI {
                     ChatMessage::Sender::NPC,
                     TESSERACT::Agent::Communication::GenerateSystemPrompt(targetNpc)
                 });
+
+                // Show where the last conversation left off
+                for (const auto& message : agent->RecentMessages(Config::Chat::maxMessages)) {
+                    chatHistory.push_back({
+                        message.role == "user" ? ChatMessage::Sender::User : ChatMessage::Sender::NPC,
+                        message.content
+                    });
+                }
             }
         }
 
@@ -768,15 +1023,17 @@ namespace UI {
             // OLD CODE
             // currentNPC = nullptr;
             // OLD CODE
-            if (currentNPC) {  // Check if we have a valid agent
-                if (auto* npc = currentNPC->GetNPC()) {  // Check if we got a valid NPC
+            if (auto agent = TESSERACT::Agent::Manager::Get(currentAgent)) {  // Check if we have a valid agent
+                if (auto* npc = agent->GetNPC()) {  // Check if we got a valid NPC
                     if (auto prisonerFaction = RE::TESForm::LookupByID<RE::TESFaction>(0xAA784)) {
                         npc->RemoveFromFaction(prisonerFaction);
                         logger::info("NPC removed from prisoner faction");
                     }
                 }
             }
-            currentNPC.reset();  // Properly destroy the agent
+            // The agent stays with its NPC, it just no longer has to outlive the holding quest
+            TESSERACT::Agent::Manager::Unpin(currentAgent);
+            currentAgent = {};
             chatHistory.clear();
             // OLD CODE
             // Context::messages.clear();
@@ -962,11 +1219,12 @@ namespace UI {
                         }
 
                         // Connection status - Show this before the connect button so users know the current state
-                        if (currentNPC && currentNPC->GetNPC()) {  // Double-check both the agent and NPC exist
+                        auto connected = TESSERACT::Agent::Manager::Get(currentAgent);
+                        if (connected && connected->GetNPC()) {  // Double-check both the agent and NPC exist
                             ImGui::TextColored(
                                 ImVec4(0.0f, 1.0f, 0.0f, 1.0f),  // Green for connected
                                 "Connected to: %s", 
-                                currentNPC->GetNPC()->GetName()
+                                connected->GetNPC()->GetName()
                             );
                         } else {
                             ImGui::TextColored(
@@ -1011,13 +1269,10 @@ namespace UI {
                                 // We found a valid NPC - now we can safely create the agent
                                 logger::info("Found NPC: {}", npc->GetName());
                                 
-                                // Clean up existing agent before creating new one
-                                if (currentNPC) {
-                                    currentNPC.reset();
-                                }
-
-                                // Create new agent and initialize chat
-                                currentNPC = std::make_unique<TESSERACT::Agent::SubAgent>(npc, "test");
+                                // Switch to this NPC's agent (created on first use)
+                                TESSERACT::Agent::Manager::Unpin(currentAgent);
+                                currentAgent = TESSERACT::Agent::Manager::Acquire(npc);
+                                TESSERACT::Agent::Manager::Pin(currentAgent);
                                 chatHistory.clear();
                                 chatHistory.push_back({
                                     ChatMessage::Sender::NPC,
@@ -1117,6 +1372,11 @@ namespace UI {
                     int dots = (duration.count() / 500) % 4;
                     std::string thinkingText = "Thinking" + std::string(dots, '.');
                     ImGui::Text("%s", thinkingText.c_str());
+                    auto agent = TESSERACT::Agent::Manager::Get(currentAgent);
+                    if (agent && agent->LastPromptTokens() > 0) {
+                        ImGui::SameLine();
+                        ImGui::TextDisabled("(~%u prompt tokens)", agent->LastPromptTokens());
+                    }
                 }
 
                 bool sendMessage = false;
@@ -1180,8 +1440,9 @@ namespace UI {
                 //     }
                 // }
                 // Inside RenderWindow()
+                auto agent = TESSERACT::Agent::Manager::Get(currentAgent);
                 if (ImGui::Button("Send") || sendMessage) {
-                    if (strlen(inputBuffer) > 0 && currentNPC) {
+                    if (strlen(inputBuffer) > 0 && agent) {
                         std::string userMessage = inputBuffer;
                         
                         // Add user message to chat display
@@ -1201,23 +1462,21 @@ namespace UI {
                         //     });
 
                          // Just call ProcessInput directly - no async wrapper
-                        currentNPC->ProcessInput(userMessage);
+                        agent->ProcessInput(userMessage);
                         
                         memset(inputBuffer, 0, sizeof(inputBuffer));
                     }
                 }
 
-                // Add agent update call
-                if (currentNPC) {
-                    currentNPC->Update();  // Let agent handle its background tasks
-                    // Check for new responses
-                    if (!currentNPC->latestResponse.empty()) {
+                // The scheduler updates the agent (see Scheduler.h), we only pick up its replies
+                TESSERACT::Agent::Inbox::ChatLine line;
+                while (TESSERACT::Agent::Inbox::TakeChatLine(line)) {
+                    if (agent && TESSERACT::Agent::Manager::Find(line.formId) == currentAgent) {
                         // We have a new response to display
                         chatHistory.push_back({
                             ChatMessage::Sender::NPC,
-                            currentNPC->latestResponse
+                            std::move(line.text)
                         });
-                        currentNPC->latestResponse.clear();  // Clear it so we don't display it again
                         isThinking.store(false);  // Stop thinking animation
                         autoScroll.store(true);   // Scroll to show new message
                     }
@@ -1288,7 +1547,8 @@ namespace UI {
             // NEW: Should delegate to the Agent
 
             // First check if we have an agent and OpenAI is initialized
-            if (!currentNPC) {
+            auto agent = TESSERACT::Agent::Manager::Get(currentAgent);
+            if (!agent) {
                 return "Error: No active NPC agent";
             }
             if (!UI::Config::OpenAI::initialized.load()) {
@@ -1296,7 +1556,7 @@ namespace UI {
             }
 
             // Use the Agent's ProcessInput method
-            return currentNPC->ProcessInput(userInput);
+            return agent->ProcessInput(userInput);
         }
 
 
@@ -1340,6 +1600,32 @@ namespace UI {
 
     // In UI.cpp, update the Settings::RenderMenu function
     namespace Settings {
+        void BackgroundResult::Start(std::function<std::string()> job) {
+            if (running.exchange(true)) {
+                return;
+            }
+            {
+                std::lock_guard lock(mutex);
+                text = "Running...";
+            }
+            TESSERACT::Agent::Tasks::Post(TESSERACT::Agent::Tasks::Executor::Worker, [this, job = std::move(job)]() {
+                std::string result;
+                try {
+                    result = job();
+                } catch (const std::exception& e) {
+                    result = std::format("Failed: {}", e.what());
+                }
+                std::lock_guard lock(mutex);
+                text = std::move(result);
+                running.store(false);
+            });
+        }
+
+        std::string BackgroundResult::Text() {
+            std::lock_guard lock(mutex);
+            return text;
+        }
+
         void __stdcall RenderMenu() {
             FontAwesome::PushSolid();
             ImGui::Text("%s TESSERACT Settings", Dashboard::Glyphs::SettingsIcon.c_str());
@@ -1406,6 +1692,211 @@ namespace UI {
                 ImGui::EndPopup();
             }
 
+            // Memory Settings
+            ImGui::Separator();
+            ImGui::Text("Memory Settings");
+
+            int retrievalTopK = TESSERACT::Agent::Memory::retrievalTopK;
+            if (ImGui::InputInt("Recalled Memories", &retrievalTopK)) {
+                TESSERACT::Agent::Memory::retrievalTopK = std::clamp(retrievalTopK, 0, 64);
+                Config::SaveConfig();
+            }
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("Older memories relevant to the current input that are\n"
+                                "added to each request on top of the recent turns (0-64).");
+            }
+
+            int contextBudget = TESSERACT::Agent::Memory::contextTokenBudget;
+            if (ImGui::InputInt("Context Token Budget", &contextBudget, 256)) {
+                TESSERACT::Agent::Memory::contextTokenBudget = std::clamp(contextBudget, 512, 128000);
+                Config::SaveConfig();
+            }
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("Tokens per dialogue request, prompt and reply together.\n"
+                                "Memories are added until the prompt part is full.");
+            }
+
+            int replyReserve = TESSERACT::Agent::Memory::replyTokenReserve;
+            if (ImGui::InputInt("Reply Token Reserve", &replyReserve, 50)) {
+                TESSERACT::Agent::Memory::replyTokenReserve = std::clamp(replyReserve, 16, 4096);
+                Config::SaveConfig();
+            }
+            ImGui::SameLine();
+            ImGui::TextDisabled(TESSERACT::Agent::Tokenizer::IsExact() ? "(exact counts)" : "(estimated counts)");
+
+            bool localEmbeddings = TESSERACT::Agent::Memory::useLocalEmbeddings;
+            if (ImGui::Checkbox("Local Embeddings", &localEmbeddings)) {
+                TESSERACT::Agent::Memory::useLocalEmbeddings = localEmbeddings;
+                Config::SaveConfig();
+            }
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("Embed memories on the CPU instead of calling the\n"
+                                "remote embeddings endpoint (no network round trips).\n"
+                                "Switching re-embeds every NPC's memories on its next reply.");
+            }
+
+            if (ImGui::Button("Run Embedding Benchmark")) {
+                embeddingBenchmark.Start([]() {
+                    auto result = TESSERACT::Agent::Embedding::Benchmark();
+                    return std::format("{:.0f} embeddings/s per core", result.embeddingsPerSecond);
+                });
+            }
+            if (auto text = embeddingBenchmark.Text(); !text.empty()) {
+                ImGui::SameLine();
+                ImGui::Text("%s", text.c_str());
+            }
+
+            if (ImGui::Button("Run Scoring Benchmark")) {
+                scoringBenchmark.Start([]() {
+                    auto result = TESSERACT::Agent::Scoring::Benchmark();
+                    return std::format("{} memories ranked in {:.0f} us", result.memories, result.microsecondsPerRanking);
+                });
+            }
+            if (auto text = scoringBenchmark.Text(); !text.empty()) {
+                ImGui::SameLine();
+                ImGui::Text("%s", text.c_str());
+            }
+
+
+            bool consolidate = TESSERACT::Agent::Memory::consolidateMemories;
+            if (ImGui::Checkbox("Consolidate Old Memories", &consolidate)) {
+                TESSERACT::Agent::Memory::consolidateMemories = consolidate;
+                Config::SaveConfig();
+            }
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("Summarize old conversation turns in the background so\n"
+                                "long histories stay within the prompt budget.");
+            }
+
+            bool extractFacts = TESSERACT::Agent::Memory::extractFacts;
+            if (ImGui::Checkbox("Extract Facts", &extractFacts)) {
+                TESSERACT::Agent::Memory::extractFacts = extractFacts;
+                Config::SaveConfig();
+            }
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("Pull short facts (debts, relatives, promises) out of each\n"
+                                "exchange and recall them when they come up again.");
+            }
+
+            bool mergeRepeats = TESSERACT::Agent::Memory::mergeRepeats;
+            if (ImGui::Checkbox("Merge Repeated Lines", &mergeRepeats)) {
+                TESSERACT::Agent::Memory::mergeRepeats = mergeRepeats;
+                Config::SaveConfig();
+            }
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("Keep one copy of lines that are said again (greetings,\n"
+                                "\"what do you sell?\") with a count instead of every repeat.");
+            }
+
+            bool useCognition = TESSERACT::Agent::Memory::useCognitionGraph;
+            if (ImGui::Checkbox("Multi-Perspective Replies", &useCognition)) {
+                TESSERACT::Agent::Memory::useCognitionGraph = useCognition;
+                Config::SaveConfig();
+            }
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("Let impulses and conscience weigh in (in parallel) before the\n"
+                                "NPC answers; see cognition.json. Costs more requests per reply.");
+            }
+            ImGui::SameLine();
+            ImGui::TextDisabled("(%zu stages)", TESSERACT::Agent::Cognition::Get().stages.size());
+
+            bool sceneConversations = TESSERACT::Agent::Memory::sceneConversations;
+            if (ImGui::Checkbox("NPC Conversations", &sceneConversations)) {
+                TESSERACT::Agent::Memory::sceneConversations = sceneConversations;
+                Config::SaveConfig();
+            }
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("Managed NPCs standing together talk among themselves. One request\n"
+                                "writes several lines for every speaker in the scene.");
+            }
+            ImGui::SameLine();
+            ImGui::TextDisabled("(%zu playing)", TESSERACT::Agent::Scenes::Active());
+
+            int maxScenes = TESSERACT::Agent::Memory::maxScenes;
+            if (ImGui::InputInt("Max NPC Conversations", &maxScenes)) {
+                TESSERACT::Agent::Memory::maxScenes = std::clamp(maxScenes, 1, 8);
+                Config::SaveConfig();
+            }
+
+            int lorePassages = TESSERACT::Agent::Memory::loreInContext;
+            if (ImGui::InputInt("Lore Passages", &lorePassages)) {
+                TESSERACT::Agent::Memory::loreInContext = std::clamp(lorePassages, 0, 16);
+                Config::SaveConfig();
+            }
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("Passages from the lore folder relevant to the input\n"
+                                "that are added to each request (0-16).");
+            }
+            ImGui::SameLine();
+            if (TESSERACT::Agent::Lore::IsReady()) {
+                ImGui::TextDisabled("(%zu indexed)", TESSERACT::Agent::Lore::Size());
+            } else {
+                ImGui::TextDisabled("(no lore index)");
+            }
+
+            int tickBudget = TESSERACT::Agent::Memory::tickBudgetMicros;
+            if (ImGui::InputInt("Agent Tick Budget (us)", &tickBudget)) {
+                TESSERACT::Agent::Memory::tickBudgetMicros = std::clamp(tickBudget, 100, 16000);
+                Config::SaveConfig();
+            }
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("Game thread time per frame for updating NPC agents.\n"
+                                "Agents that don't fit wait for the next frame.");
+            }
+            ImGui::SameLine();
+            auto tickStats = TESSERACT::Agent::Scheduler::LastFrame();
+            ImGui::TextDisabled("(%u/%u agents, %u us)", tickStats.ticked, tickStats.agents, tickStats.micros);
+
+            int actionBudget = TESSERACT::Agent::Memory::actionBudgetMicros;
+            if (ImGui::InputInt("Agent Action Budget (us)", &actionBudget)) {
+                TESSERACT::Agent::Memory::actionBudgetMicros = std::clamp(actionBudget, 50, 16000);
+                Config::SaveConfig();
+            }
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("Game thread time per frame for carrying out spells, travel and\n"
+                                "fetching that NPC agents queued. The rest waits for the next frame.");
+            }
+            ImGui::SameLine();
+            ImGui::TextDisabled("(%zu waiting)", TESSERACT::Agent::Actions::Pending());
+
+            int nearDistance = TESSERACT::Agent::Memory::lodNearDistance;
+            if (ImGui::InputInt("Near Agent Distance", &nearDistance, 128)) {
+                TESSERACT::Agent::Memory::lodNearDistance = std::clamp(nearDistance, 128, TESSERACT::Agent::Memory::lodFarDistance);
+                Config::SaveConfig();
+            }
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("NPCs closer than this (game units) are updated often and\n"
+                                "get the full prompt budget.");
+            }
+
+            int farDistance = TESSERACT::Agent::Memory::lodFarDistance;
+            if (ImGui::InputInt("Far Agent Distance", &farDistance, 256)) {
+                TESSERACT::Agent::Memory::lodFarDistance = std::clamp(farDistance, TESSERACT::Agent::Memory::lodNearDistance, 32768);
+                Config::SaveConfig();
+            }
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("NPCs beyond this go dormant: rare updates and\n"
+                                "no background thinking.");
+            }
+            ImGui::TextDisabled("Agents: %u focus, %u near, %u far, %u dormant",
+                                tickStats.tiers[0], tickStats.tiers[1], tickStats.tiers[2], tickStats.tiers[3]);
+
+            int warmBudget = TESSERACT::Agent::Memory::warmBudgetMB;
+            if (ImGui::InputInt("Compressed Memory Budget (MB)", &warmBudget)) {
+                TESSERACT::Agent::Memory::warmBudgetMB = std::clamp(warmBudget, 0, 1024);
+                Config::SaveConfig();
+            }
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("RAM for compressed older memories across all NPCs.\n"
+                                "Anything beyond this is spilled to disk.");
+            }
+
+            auto tiers = TESSERACT::Agent::Memory::Tiers::GetStats();
+            ImGui::Text("Memory text: %.1f KB hot, %.1f KB warm (%.1f KB raw), %.1f KB on disk",
+                tiers.hotBytes / 1024.0, tiers.warmBytes / 1024.0, tiers.warmRawBytes / 1024.0, tiers.coldBytes / 1024.0);
+            ImGui::Text("Block cache: %llu hits, %llu misses",
+                static_cast<unsigned long long>(tiers.cacheHits), static_cast<unsigned long long>(tiers.cacheMisses));
+
             // OpenAI Settings
             ImGui::Separator();
             ImGui::Text("OpenAI Settings");
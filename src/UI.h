@@ -12,7 +12,11 @@
 #include <fstream>    // For file I/O
 #include <atomic>     // For std::atomic operations
 #include <unordered_set>
+#include <functional>
+#include <mutex>
 #include "Agent.h"
+#include "AgentManager.h"
+#include "ConversationArchive.h"
 
 namespace UI {
     // Global registration for all UI components
@@ -65,6 +69,12 @@ namespace UI {
             void SaveToConfig(nlohmann::json& config);
             void LoadFromConfig(const nlohmann::json& config);
         }
+
+        // Memory/retrieval configuration (values live in TESSERACT::Agent::Memory)
+        namespace Memory {
+            void SaveToConfig(nlohmann::json& config);
+            void LoadFromConfig(const nlohmann::json& config);
+        }
     }
 
     namespace NPCDetails {
@@ -72,6 +82,11 @@ namespace UI {
         inline MENU_WINDOW detailsWindow;
         inline int selectedNpcId = -1;
 
+        // Archive paging (pages are read from disk on demand)
+        inline constexpr size_t HISTORY_PAGE_SIZE = 20;
+        inline size_t dialoguePage = 0;
+        inline size_t summaryPage = 0;
+
         // Tab flags
         inline const ImGuiTabBarFlags TAB_FLAGS = 
             ImGuiTabBarFlags_NoCloseWithMiddleMouseButton |
@@ -87,6 +102,8 @@ namespace UI {
 
         // Drawing helpers namespace declaration
         namespace Drawing {
+            RE::Actor* GetSelectedActor();
+            void DrawArchivePage(const char* id, TESSERACT::Agent::Archive::Stream stream, size_t& page);
             void DrawNPCInfo();
             void DrawExperiencerContext();
             void DrawNarratorContext();
@@ -165,7 +182,8 @@ namespace UI {
         
         // NPC state
         // inline RE::Actor* currentNPC = nullptr;
-        inline std::unique_ptr<TESSERACT::Agent::SubAgent> currentNPC = nullptr;
+        // The agent lives in the AgentManager; the chat only holds a handle to it
+        inline TESSERACT::Agent::AgentHandle currentAgent;
 
         // Chat context/memory management
         // namespace Context {
@@ -189,6 +207,18 @@ namespace UI {
     }
 
     namespace Settings {
+        // A benchmark running on the task pool; the menu shows its line once it is done
+        struct BackgroundResult {
+            std::mutex mutex;
+            std::string text;
+            std::atomic<bool> running{false};
+
+            void Start(std::function<std::string()> job);  // Ignored while one is running
+            std::string Text();
+        };
+        inline BackgroundResult embeddingBenchmark;
+        inline BackgroundResult scoringBenchmark;
+
         void __stdcall RenderMenu();
     }
 }
\ No newline at end of file
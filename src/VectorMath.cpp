@@ -0,0 +1,163 @@
+#include "VectorMath.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(_M_X64) || defined(__x86_64__)
+    #define TESSERACT_X86_SIMD 1
+    #include <immintrin.h>
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+    #endif
+#endif
+
+// MSVC allows intrinsics in any function, GCC/Clang need the target attribute
+#if defined(TESSERACT_X86_SIMD) && (defined(__GNUC__) || defined(__clang__))
+    #define TESSERACT_AVX2_TARGET __attribute__((target("avx2")))
+#else
+    #define TESSERACT_AVX2_TARGET
+#endif
+
+namespace TESSERACT::VectorMath {
+    namespace {
+        bool DetectAVX2() {
+#if defined(TESSERACT_X86_SIMD)
+    #if defined(_MSC_VER) && !defined(__clang__)
+            int info[4] = {};
+            __cpuid(info, 1);
+            const bool osxsave = (info[2] & (1 << 27)) != 0;
+            const bool avx = (info[2] & (1 << 28)) != 0;
+            if (!osxsave || !avx) return false;
+
+            // Make sure the OS saves the YMM registers on context switch
+            if ((_xgetbv(0) & 0x6) != 0x6) return false;
+
+            __cpuidex(info, 7, 0);
+            return (info[1] & (1 << 5)) != 0;
+    #else
+            return __builtin_cpu_supports("avx2");
+    #endif
+#else
+            return false;
+#endif
+        }
+
+#if defined(TESSERACT_X86_SIMD)
+        TESSERACT_AVX2_TARGET float HorizontalSum(__m256 v) {
+            __m128 lo = _mm256_castps256_ps128(v);
+            __m128 hi = _mm256_extractf128_ps(v, 1);
+            lo = _mm_add_ps(lo, hi);
+            lo = _mm_add_ps(lo, _mm_movehl_ps(lo, lo));
+            lo = _mm_add_ss(lo, _mm_shuffle_ps(lo, lo, 0x55));
+            return _mm_cvtss_f32(lo);
+        }
+
+        TESSERACT_AVX2_TARGET std::int32_t HorizontalSum(__m256i v) {
+            __m128i lo = _mm256_castsi256_si128(v);
+            __m128i hi = _mm256_extracti128_si256(v, 1);
+            lo = _mm_add_epi32(lo, hi);
+            lo = _mm_add_epi32(lo, _mm_shuffle_epi32(lo, 0x4E));
+            lo = _mm_add_epi32(lo, _mm_shuffle_epi32(lo, 0xB1));
+            return _mm_cvtsi128_si32(lo);
+        }
+
+        TESSERACT_AVX2_TARGET float DotAVX2(const float* a, const float* b, std::size_t n) {
+            __m256 acc0 = _mm256_setzero_ps();
+            __m256 acc1 = _mm256_setzero_ps();
+            std::size_t i = 0;
+            for (; i + 16 <= n; i += 16) {
+                acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+                acc1 = _mm256_add_ps(acc1, _mm256_mul_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8)));
+            }
+            for (; i + 8 <= n; i += 8) {
+                acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+            }
+            float sum = HorizontalSum(_mm256_add_ps(acc0, acc1));
+            for (; i < n; i++) {
+                sum += a[i] * b[i];
+            }
+            return sum;
+        }
+
+        TESSERACT_AVX2_TARGET std::int32_t DotInt8AVX2(const std::int8_t* a, const std::int8_t* b, std::size_t n) {
+            __m256i acc = _mm256_setzero_si256();
+            std::size_t i = 0;
+            for (; i + 16 <= n; i += 16) {
+                // Widen 16 x int8 to 16 x int16, then multiply-add pairs into int32
+                __m256i va = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)));
+                __m256i vb = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+                acc = _mm256_add_epi32(acc, _mm256_madd_epi16(va, vb));
+            }
+            std::int32_t sum = HorizontalSum(acc);
+            for (; i < n; i++) {
+                sum += static_cast<std::int32_t>(a[i]) * static_cast<std::int32_t>(b[i]);
+            }
+            return sum;
+        }
+#endif
+
+        float DotScalar(const float* a, const float* b, std::size_t n) {
+            float sum = 0.0f;
+            for (std::size_t i = 0; i < n; i++) {
+                sum += a[i] * b[i];
+            }
+            return sum;
+        }
+
+        std::int32_t DotInt8Scalar(const std::int8_t* a, const std::int8_t* b, std::size_t n) {
+            std::int32_t sum = 0;
+            for (std::size_t i = 0; i < n; i++) {
+                sum += static_cast<std::int32_t>(a[i]) * static_cast<std::int32_t>(b[i]);
+            }
+            return sum;
+        }
+    }
+
+    bool HasAVX2() {
+        static const bool supported = DetectAVX2();
+        return supported;
+    }
+
+    float Dot(const float* a, const float* b, std::size_t n) {
+#if defined(TESSERACT_X86_SIMD)
+        if (HasAVX2()) return DotAVX2(a, b, n);
+#endif
+        return DotScalar(a, b, n);
+    }
+
+    std::int32_t DotInt8(const std::int8_t* a, const std::int8_t* b, std::size_t n) {
+#if defined(TESSERACT_X86_SIMD)
+        if (HasAVX2()) return DotInt8AVX2(a, b, n);
+#endif
+        return DotInt8Scalar(a, b, n);
+    }
+
+    void Normalize(float* v, std::size_t n) {
+        float norm = std::sqrt(Dot(v, v, n));
+        if (norm <= 0.0f) return;
+
+        float inv = 1.0f / norm;
+        for (std::size_t i = 0; i < n; i++) {
+            v[i] *= inv;
+        }
+    }
+
+    float QuantizeInt8(const float* v, std::int8_t* out, std::size_t n) {
+        float maxAbs = 0.0f;
+        for (std::size_t i = 0; i < n; i++) {
+            maxAbs = (std::max)(maxAbs, std::fabs(v[i]));
+        }
+
+        if (maxAbs <= 0.0f) {
+            std::fill(out, out + n, std::int8_t{0});
+            return 0.0f;
+        }
+
+        float scale = maxAbs / 127.0f;
+        float inv = 1.0f / scale;
+        for (std::size_t i = 0; i < n; i++) {
+            float q = std::round(v[i] * inv);
+            out[i] = static_cast<std::int8_t>(std::clamp(q, -127.0f, 127.0f));
+        }
+        return scale;
+    }
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Vector Math Kernels
+ *
+ * Small set of dense-vector kernels shared by the memory retrieval code.
+ * Every kernel has an AVX2 path and a scalar fallback; the AVX2 path is
+ * picked at runtime so the plugin still loads on CPUs without AVX2.
+ */
+
+namespace TESSERACT::VectorMath {
+    // CPU feature detection (cached after first call)
+    bool HasAVX2();
+
+    // Dot products
+    float Dot(const float* a, const float* b, std::size_t n);
+    std::int32_t DotInt8(const std::int8_t* a, const std::int8_t* b, std::size_t n);
+
+    // Normalize in place to unit length (no-op for zero vectors)
+    void Normalize(float* v, std::size_t n);
+
+    // Symmetric int8 quantization, returns the scale so that v[i] ~= out[i] * scale
+    float QuantizeInt8(const float* v, std::int8_t* out, std::size_t n);
+}
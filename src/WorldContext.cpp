@@ -0,0 +1,81 @@
+#include "WorldContext.h"
+#include <atomic>
+#include <format>
+
+namespace TESSERACT::Agent::WorldContext {
+    namespace {
+        // Raw inputs of the published snapshot (game thread only)
+        struct Key {
+            int hour = -1;
+            const RE::TESWeather* weather = nullptr;
+            const RE::TESWorldSpace* worldspace = nullptr;
+            const RE::BGSLocation* location = nullptr;
+            bool playerInCombat = false;
+
+            bool operator==(const Key&) const = default;
+        };
+
+        std::atomic<std::shared_ptr<const Snapshot>> current{std::make_shared<const Snapshot>()};
+        Key lastKey;
+        std::uint64_t frame = 0;
+
+        std::string TimeOfDay(int hour) {
+            // Hour granularity on purpose: finer would change the state message every request
+            const char* period = hour < 5 ? "night" : hour < 12 ? "morning" : hour < 17 ? "afternoon" :
+                                 hour < 21 ? "evening" : "night";
+            return std::format("{} o'clock in the {}", hour % 12 == 0 ? 12 : hour % 12, period);
+        }
+
+        std::string WeatherName(const RE::TESWeather* weather) {
+            if (!weather) return "Unknown";
+
+            using Flag = RE::TESWeather::WeatherDataFlag;
+            if (weather->data.flags.any(Flag::kSnow)) return "Snowing";
+            if (weather->data.flags.any(Flag::kRainy)) return "Raining";
+            if (weather->data.flags.any(Flag::kCloudy)) return "Cloudy";
+            if (weather->data.flags.any(Flag::kPleasant)) return "Clear";
+            return "Unknown";
+        }
+    }
+
+    void Sample() {
+        frame++;
+
+        auto* player = RE::PlayerCharacter::GetSingleton();
+        auto* calendar = RE::Calendar::GetSingleton();
+        auto* sky = RE::Sky::GetSingleton();
+        if (!player || !calendar) {
+            return;
+        }
+
+        Key key;
+        key.hour = static_cast<int>(calendar->GetHour()) % 24;
+        key.weather = sky ? sky->currentWeather : nullptr;
+        key.worldspace = player->GetWorldspace();
+        key.location = player->GetCurrentLocation();
+        key.playerInCombat = player->IsInCombat();
+        if (key == lastKey) {
+            return;
+        }
+        lastKey = key;
+
+        auto snapshot = std::make_shared<Snapshot>();
+        snapshot->frame = frame;
+        snapshot->hour = key.hour;
+        snapshot->time = TimeOfDay(key.hour);
+        snapshot->weather = WeatherName(key.weather);
+        // Interiors have no worldspace, the location ("Dragonsreach") is the best name there
+        if (key.worldspace && key.worldspace->GetName()[0] != '\0') {
+            snapshot->region = key.worldspace->GetName();
+        } else if (key.location) {
+            snapshot->region = key.location->GetName();
+        }
+        snapshot->playerInCombat = key.playerInCombat;
+
+        current.store(std::move(snapshot), std::memory_order_release);
+    }
+
+    std::shared_ptr<const Snapshot> Current() {
+        return current.load(std::memory_order_acquire);
+    }
+}
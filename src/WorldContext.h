@@ -0,0 +1,42 @@
+#pragma once
+#include "RE/Skyrim.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+
+/**
+ * World Context Overview
+ *
+ * Time, weather and region are the same for every agent, so they are sampled
+ * once per frame on the game thread (see Hooks.cpp) instead of once per agent
+ * per prompt, and prompts are built off the game thread anyway.
+ *
+ * 1. Sampling:
+ *    - Compares the raw inputs (game hour, weather, worldspace, location, player
+ *      combat) with the previous frame and only builds a new snapshot when
+ *      one changed, so most frames cost a few pointer reads
+ *
+ * 2. Publishing:
+ *    - Snapshots are immutable and swapped in through an atomic shared_ptr;
+ *      readers on any thread keep whatever snapshot they loaded alive
+ *    - std::atomic<std::shared_ptr> is not lock-free on MSVC: a load holds a
+ *      short internal spinlock for the refcount bump. Stores only happen when
+ *      the inputs change, so readers practically never contend
+ */
+
+namespace TESSERACT::Agent::WorldContext {
+    struct Snapshot {
+        std::uint64_t frame = 0;      // Frame it was sampled on
+        int hour = -1;                // Game hour, -1 before the first sample
+        std::string time = "Unknown";
+        std::string weather = "Unknown";
+        std::string region = "Unknown";
+        bool playerInCombat = false;
+    };
+
+    // Game thread, once per frame
+    void Sample();
+
+    // Any thread, never blocks on the game thread; never null
+    std::shared_ptr<const Snapshot> Current();
+}
@@ -0,0 +1,145 @@
+#include "WorldEvents.h"
+#include "Embedding.h"
+#include "Utils.h"
+#include <algorithm>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+namespace TESSERACT::Agent::WorldEvents {
+    namespace {
+        constexpr std::size_t kFeedCapacity = 256;  // Agents that fall further behind miss the oldest events
+
+        struct Store {
+            std::mutex mutex;
+            std::deque<EventRef> feed;
+            std::uint64_t nextSequence = 1;
+            std::unordered_map<std::uint64_t, std::weak_ptr<const Event>> interned;  // By content hash
+        };
+
+        Store& GetStore() {
+            static Store store;
+            return store;
+        }
+
+        RE::FormID SpaceOf(const RE::TESObjectREFR* ref) {
+            if (auto* worldspace = ref->GetWorldspace()) {
+                return worldspace->GetFormID();
+            }
+            auto* cell = ref->GetParentCell();
+            return cell ? cell->GetFormID() : 0;
+        }
+
+        bool Reaches(const Event& event, const RE::Actor* listener) {
+            if (event.radius <= 0.0f) {
+                return true;
+            }
+            return listener && SpaceOf(listener) == event.space &&
+                Utils::CalculateDistance(listener->GetPosition(), event.position) <= event.radius;
+        }
+
+        // Caller holds the store mutex
+        void Remember(Store& store, const EventRef& event) {
+            auto hash = Embedding::ContentHash(event->content);
+            store.interned[hash] = event;
+
+            // Drop expired slots now and then so the map stays the size of the live set
+            if (store.interned.size() > kFeedCapacity * 4) {
+                std::erase_if(store.interned, [](const auto& entry) { return entry.second.expired(); });
+            }
+        }
+    }
+
+    EventRef Publish(std::string content, const RE::TESObjectREFR* center, float radius, float importance) {
+        auto event = std::make_shared<Event>();
+        event->content = std::move(content);
+        event->timestamp = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+        event->importance = std::clamp(importance, 0.0f, 1.0f);
+        if (center && radius > 0.0f) {
+            event->space = SpaceOf(center);
+            event->position = center->GetPosition();
+            event->radius = radius;
+        }
+
+        auto& store = GetStore();
+        std::lock_guard lock(store.mutex);
+        event->sequence = store.nextSequence++;
+
+        EventRef shared = std::move(event);
+        store.feed.push_back(shared);
+        if (store.feed.size() > kFeedCapacity) {
+            store.feed.pop_front();
+        }
+        Remember(store, shared);
+
+        logger::info("World event {} published (radius {}): {}", shared->sequence, shared->radius, shared->content);
+        return shared;
+    }
+
+    void Collect(std::uint64_t& cursor, const RE::Actor* listener, std::vector<EventRef>& out) {
+        auto& store = GetStore();
+        std::lock_guard lock(store.mutex);
+
+        // The feed is ordered by sequence, so skip straight past what we've seen
+        auto first = std::upper_bound(store.feed.begin(), store.feed.end(), cursor,
+            [](std::uint64_t value, const EventRef& event) { return value < event->sequence; });
+        for (auto it = first; it != store.feed.end(); ++it) {
+            if (Reaches(**it, listener)) {
+                out.push_back(*it);
+            }
+        }
+        cursor = store.nextSequence - 1;
+    }
+
+    std::uint64_t LatestSequence() {
+        auto& store = GetStore();
+        std::lock_guard lock(store.mutex);
+        return store.nextSequence - 1;
+    }
+
+    EventRef Intern(std::string_view content, std::time_t timestamp, float importance) {
+        auto& store = GetStore();
+        std::lock_guard lock(store.mutex);
+
+        auto hash = Embedding::ContentHash(content);
+        if (auto it = store.interned.find(hash); it != store.interned.end()) {
+            if (auto existing = it->second.lock(); existing && existing->content == content) {
+                return existing;
+            }
+        }
+
+        // Restored events are not re-delivered, so they never enter the feed
+        auto event = std::make_shared<Event>();
+        event->content = std::string(content);
+        event->timestamp = timestamp;
+        event->importance = importance;
+
+        EventRef shared = std::move(event);
+        Remember(store, shared);
+        return shared;
+    }
+
+    Stats GetStats() {
+        auto& store = GetStore();
+        std::lock_guard lock(store.mutex);
+
+        Stats stats;
+        stats.retained = store.feed.size();
+        for (const auto& [hash, weak] : store.interned) {
+            if (auto event = weak.lock()) {
+                stats.interned++;
+                stats.bytes += event->content.size();
+            }
+        }
+        return stats;
+    }
+
+    bool __stdcall BroadcastEventPapyrus(RE::StaticFunctionTag*, RE::BSFixedString content, RE::TESObjectREFR* center,
+                                         float radius, float importance) {
+        if (content.empty()) {
+            return false;
+        }
+        Publish(std::string(content.c_str()), center, radius, importance);
+        return true;
+    }
+}
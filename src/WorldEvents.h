@@ -0,0 +1,65 @@
+#pragma once
+#include "RE/Skyrim.h"
+#include "SKSE/SKSE.h"
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * Shared World Events Overview
+ *
+ * Things every nearby agent should remember (a dragon attack, a murder in the
+ * market) are stored once and shared instead of copied into every agent.
+ *
+ * 1. Events:
+ *    - Immutable once published; agents hold a shared_ptr to the event in
+ *      their MemoryEntry plus their own importance
+ *
+ * 2. Delivery:
+ *    - Publish() appends to a bounded feed; agents pull what reaches them
+ *      (same worldspace or cell, within radius) in their Update
+ *    - Importance is decided once by the publisher, not per recipient
+ *
+ * 3. Interning:
+ *    - Events are also interned by content hash, so memories restored from a
+ *      save share one copy again
+ */
+
+namespace TESSERACT::Agent::WorldEvents {
+    struct Event {
+        std::uint64_t sequence = 0;
+        std::string content;
+        std::time_t timestamp = 0;
+        float importance = 1.0f;
+
+        // Who hears about it (radius <= 0 reaches everyone)
+        RE::FormID space = 0;  // Worldspace, or parent cell for interiors
+        RE::NiPoint3 position;
+        float radius = 0.0f;
+    };
+
+    using EventRef = std::shared_ptr<const Event>;
+
+    // Publishing and delivery
+    EventRef Publish(std::string content, const RE::TESObjectREFR* center, float radius, float importance);
+    void Collect(std::uint64_t& cursor, const RE::Actor* listener, std::vector<EventRef>& out);  // Advances cursor
+    std::uint64_t LatestSequence();
+
+    // Shared copy of an event's text (used when restoring memories)
+    EventRef Intern(std::string_view content, std::time_t timestamp, float importance);
+
+    struct Stats {
+        std::size_t retained = 0;  // Events still in the feed
+        std::size_t interned = 0;  // Events alive anywhere
+        std::size_t bytes = 0;     // Text held by live events
+    };
+    Stats GetStats();
+
+    // Papyrus entry point: TESSERACT.BroadcastEvent(text, center, radius, importance)
+    bool __stdcall BroadcastEventPapyrus(RE::StaticFunctionTag*, RE::BSFixedString content, RE::TESObjectREFR* center,
+                                         float radius, float importance);
+}
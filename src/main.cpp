@@ -1,12 +1,35 @@
 // main.cpp
 #include "pch.h"
 #include "UI.h"
+#include "AgentManager.h"
+#include "Cognition.h"
+#include "ConversationArchive.h"
+#include "Hooks.h"
+#include "LoreIndex.h"
 #include "PapyrusRegistration.h"
+#include "PersonaCache.h"
+#include "Persistence.h"
+#include "PromptTemplates.h"
+#include "Tokenizer.h"
 
 void OnMessage(SKSE::MessagingInterface::Message* message) {
     if (message->type == SKSE::MessagingInterface::kDataLoaded) {
         UI::Register();
         logger::info("TESSERACT UI components registered");
+
+        TESSERACT::Agent::Archive::Initialize();
+        TESSERACT::Agent::Tokenizer::Initialize();
+        TESSERACT::Agent::Prompts::Initialize();
+        TESSERACT::Agent::Cognition::Initialize();
+        TESSERACT::Agent::Persona::Register();
+        TESSERACT::Agent::Lore::Initialize();
+    } else if (message->type == SKSE::MessagingInterface::kPreLoadGame ||
+               message->type == SKSE::MessagingInterface::kNewGame) {
+        // Agents belong to the session; the next one restores them from its co-save
+        TESSERACT::Agent::Manager::Clear();
+    } else if (message->type == SKSE::MessagingInterface::kPostLoadGame) {
+        // Factions and relationships may differ in the loaded save
+        TESSERACT::Agent::Persona::InvalidateAll();
     }
 }
 
@@ -39,6 +62,15 @@ SKSEPluginLoad(const SKSE::LoadInterface* a_skse) {
         return false;
     }
 
+    // Register co-save callbacks for agent memories
+    if (!TESSERACT::Agent::Persistence::Register()) {
+        return false;
+    }
+
+    // Per-frame work on the game thread
+    SKSE::AllocTrampoline(14);
+    TESSERACT::Hooks::Install();
+
     // Register Papyrus functions
     auto papyrus = SKSE::GetPapyrusInterface();
     if (!papyrus->Register(TESSERACT::RegisterPapyrusFunctions)) {